@@ -12,6 +12,11 @@
 #include <Data/COutputData.h>
 #include <Data/CCacheData.h>
 #include <Data/EOptionType.h>
+#include <Data/EAccuracy.h>
+#include <Data/ECalculationType.h>
+#include <Data/EAdjointDifferentiation.h>
+#include <BlackScholes/CBlackScholesKernels.h>
+#include <Utilities/CInstructionSet.h>
 #include <Flags.h>
 
 namespace fdpricing
@@ -46,6 +51,26 @@ public:
 	template<EOptionType>
 	double RhoBorrow() const noexcept;
 
+	const details::CCacheData& GetCacheData() const noexcept
+	{
+		return cacheData;
+	}
+
+	/**
+	 * Grid-wide version of Update followed by the above, over the spots S_i - shift (see details::CBlackScholesKernels::Smooth)
+	 */
+	template<ECalculationType calculationType, EAdjointDifferentiation adjointDifferentiation, EAccuracy accuracy = EAccuracy::Standard, typename T>
+	static void Smooth(const CInputData& unaliased input, const details::CCacheData& unaliased cache, const double* unaliased S, const size_t N, const double shift,
+			const details::CSmoothingOutput<T>& unaliased call, const details::CSmoothingOutput<T>& unaliased put) noexcept
+	{
+		details::CInstructionSet::Dispatch([&](auto instructionSet)
+		{
+			Kernels<decltype(instructionSet)::value>::template Smooth<calculationType, adjointDifferentiation, accuracy>(input, cache, S, N, shift, call, put);
+		});
+	}
+
+	template<EInstructionSet instructionSet>
+	using Kernels = details::CBlackScholesKernels<details::CPack<double, details::CInstructionSetTraits<instructionSet>::registerSize>>;
 
 protected:
 	const CInputData& unaliased input;
@@ -0,0 +1,87 @@
+/*
+ * CBlackScholesKernels.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef BLACKSCHOLES_CBLACKSCHOLESKERNELS_H_
+#define BLACKSCHOLES_CBLACKSCHOLESKERNELS_H_
+
+#include <stddef.h>
+
+#include <Data/CInputData.h>
+#include <Data/CCacheData.h>
+#include <Data/EAccuracy.h>
+#include <Data/ECalculationType.h>
+#include <Data/EAdjointDifferentiation.h>
+#include <Utilities/CSimd.h>
+#include <Utilities/CStatsKernels.h>
+#include <Flags.h>
+
+namespace details
+{
+
+/**
+ * Where the smoothed payoff and its greeks of one option type go: the ones which aren't requested are never touched (and can be nullptr)
+ */
+template<typename T>
+struct CSmoothingOutput
+{
+	T* payoff;
+	T* vega;
+	T* rho;
+	T* rhoBorrow;
+};
+
+/**
+ * Black-Scholes values and greeks over a whole grid, a pack of spots at a time: same quantities as CBlackScholes::Update followed
+ * by Value, Vega, Rho and RhoBorrow, with d1, d2 and their normal CDF's computed once for both option types.
+ * As for the other kernels, they're meant to be inlined into code which is dispatched already (see CInstructionSet)
+ */
+template<typename Pack=CPack<double>>
+class CBlackScholesKernels
+{
+public:
+	typedef typename Pack::Type Vector;
+
+	/**
+	 * Spots are S_i - shift, floored at minSpot: input and cache are the same as CBlackScholes', where cache.T is the time to expiry.
+	 * Rho is -T times the value, RhoBorrow the derivative w.r.t. the cost of carry
+	 */
+	template<ECalculationType calculationType, EAdjointDifferentiation adjointDifferentiation, fdpricing::EAccuracy accuracy, typename T>
+	static void Smooth(const fdpricing::CInputData& unaliased input, const CCacheData& unaliased cache, const double* unaliased S, const size_t N, const double shift,
+			const CSmoothingOutput<T>& unaliased call, const CSmoothingOutput<T>& unaliased put) noexcept;
+
+	static constexpr double minSpot = 1e-7;
+
+private:
+	typedef CStatsKernels<Pack> Stats;
+
+	/**
+	 * Stores the first n lanes of x, converting them to T
+	 */
+	template<typename T>
+	static inline void Store(T* unaliased y, const Vector& unaliased x, const size_t n) noexcept
+	{
+		for (size_t l = 0; l < n; ++l)
+			y[l] = T(x[l]);
+	}
+
+	static inline void Store(double* unaliased y, const Vector& unaliased x, const size_t n) noexcept
+	{
+		if (n == Pack::width)
+			Pack::Store(y, x);
+		else
+		{
+			for (size_t l = 0; l < n; ++l)
+				y[l] = x[l];
+		}
+	}
+};
+
+}
+
+#include <BlackScholes/CBlackScholesKernels.tpp>
+
+#endif /* BLACKSCHOLES_CBLACKSCHOLESKERNELS_H_ */
@@ -0,0 +1,97 @@
+/*
+ * CBlackScholesKernels.tpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <Flags.h>
+
+namespace details
+{
+
+template<typename Pack>
+constexpr double CBlackScholesKernels<Pack>::minSpot;
+
+template<typename Pack>
+template<ECalculationType calculationType, EAdjointDifferentiation adjointDifferentiation, fdpricing::EAccuracy accuracy, typename T>
+void CBlackScholesKernels<Pack>::Smooth(const fdpricing::CInputData& unaliased input, const CCacheData& unaliased cache, const double* unaliased S, const size_t N, const double shift,
+		const CSmoothingOutput<T>& unaliased call, const CSmoothingOutput<T>& unaliased put) noexcept
+{
+	constexpr bool hasCall = calculationType == ECalculationType::All || calculationType == ECalculationType::CallOnly;
+	constexpr bool hasPut = calculationType == ECalculationType::All || calculationType == ECalculationType::PutOnly;
+	constexpr bool hasVega = adjointDifferentiation == EAdjointDifferentiation::Vega || adjointDifferentiation == EAdjointDifferentiation::All;
+	constexpr bool hasRho = adjointDifferentiation == EAdjointDifferentiation::Rho || adjointDifferentiation == EAdjointDifferentiation::All;
+	constexpr size_t W = Pack::width;
+
+	// same as CBlackScholes::Make and its constructor
+	const double oneOverSigmaSqrtT = 1.0 / cache.sigmaSqrtDt;
+	const double d1Addend = ((input.b + .5 * input.sigma * input.sigma) * cache.T - log(input.K)) * oneOverSigmaSqrtT;
+	const double forwardFactor = cache.discountFactor * cache.growthFactor;
+	const double strikeFactor = cache.discountFactor * input.K;
+	const double vegaFactor = cache.growthFactorTimesDiscountFactor * cache.sqrtDt;
+	const double rhoBorrowFactor = cache.T * cache.growthFactorTimesDiscountFactor;
+
+	const auto worker = [&](const Vector& unaliased x, const size_t offset, const size_t n)
+	{
+		// not positive shifted spots are floored, without branching
+		Vector spot = x - shift;
+		spot = spot > 0.0 ? spot : Pack::Broadcast(minSpot);
+
+		const Vector d1 = oneOverSigmaSqrtT * Stats::template Log<accuracy>(spot) + d1Addend;
+		const Vector d2 = d1 - cache.sigmaSqrtDt;
+
+		const Vector Nd1 = Stats::template NormCdf<accuracy>(d1);
+		const Vector Nd2 = Stats::template NormCdf<accuracy>(d2);
+
+		if (hasVega)
+		{
+			const Vector vega = vegaFactor * spot * Stats::template NormPdf<accuracy>(d1);
+			if (hasCall)
+				Store(call.vega + offset, vega, n);
+			if (hasPut)
+				Store(put.vega + offset, vega, n);
+		}
+
+		if (hasCall)
+		{
+			const Vector value = forwardFactor * spot * Nd1 - strikeFactor * Nd2;
+			Store(call.payoff + offset, value, n);
+			if (hasRho)
+			{
+				Store(call.rho + offset, -cache.T * value, n);
+				Store(call.rhoBorrow + offset, rhoBorrowFactor * spot * Nd1, n);
+			}
+		}
+
+		if (hasPut)
+		{
+			const Vector NminusD1 = 1.0 - Nd1;
+			const Vector value = strikeFactor * (1.0 - Nd2) - forwardFactor * spot * NminusD1;
+			Store(put.payoff + offset, value, n);
+			if (hasRho)
+			{
+				Store(put.rho + offset, -cache.T * value, n);
+				Store(put.rhoBorrow + offset, -rhoBorrowFactor * spot * NminusD1, n);
+			}
+		}
+	};
+
+	size_t i = 0;
+	for (; i + W <= N; i += W)
+		worker(Pack::Load(S + i), i, W);
+
+	// padded with the last spot, so that no lane sees an unusual value
+	if (i < N)
+	{
+		double buffer[W];
+		std::fill(buffer, buffer + W, S[N - 1]);
+		std::copy(S + i, S + N, buffer);
+		worker(Pack::Load(buffer), i, N - i);
+	}
+}
+
+}
@@ -0,0 +1,59 @@
+/*
+ * CBatchPayoffData.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef DATA_CBATCHPAYOFFDATA_H_
+#define DATA_CBATCHPAYOFFDATA_H_
+
+#include <vector>
+#include <array>
+
+#include <Data/CPayoffData.h>
+#include <Data/EAdjointDifferentiation.h>
+#include <Utilities/CAlignedAllocator.h>
+#include <Utilities/CSimd.h>
+#include <Flags.h>
+
+namespace fdpricing
+{
+/**
+ * Payoff and tangents of several options stored lane by lane: the i-th element holds the i-th grid point of every option
+ */
+template<size_t lanes>
+class CBatchPayoffData
+{
+public:
+	typedef details::CPack<double, lanes * sizeof(double)> Pack;
+	typedef typename Pack::Type Lane;
+
+	details::AlignedVector<Lane> payoff_i;
+	details::AlignedVector<Lane> vega_i;
+	details::AlignedVector<Lane> rho_i;
+	details::AlignedVector<Lane> rhoBorrow_i;
+
+	/**
+	 * Interleave the requested quantities of the input options
+	 */
+	template<EAdjointDifferentiation adjointDifferentiation>
+	void Gather(const std::array<const CPayoffData*, lanes>& unaliased data) noexcept;
+
+	/**
+	 * Copy back the requested quantities to the input options
+	 */
+	template<EAdjointDifferentiation adjointDifferentiation>
+	void Scatter(const std::array<CPayoffData*, lanes>& unaliased data) const noexcept;
+
+private:
+	typedef details::AlignedVector<double> CPayoffData::* Member;
+
+	static void Gather(details::AlignedVector<Lane>& unaliased out, const Member member, const std::array<const CPayoffData*, lanes>& unaliased data) noexcept;
+	static void Scatter(const std::array<CPayoffData*, lanes>& unaliased data, const Member member, const details::AlignedVector<Lane>& unaliased in) noexcept;
+};
+}
+
+#include <Data/CBatchPayoffData.tpp>
+
+#endif /* DATA_CBATCHPAYOFFDATA_H_ */
@@ -0,0 +1,82 @@
+/*
+ * CBatchPayoffData.tpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#include <Flags.h>
+
+namespace fdpricing
+{
+
+template<size_t lanes>
+template<EAdjointDifferentiation adjointDifferentiation>
+void CBatchPayoffData<lanes>::Gather(const std::array<const CPayoffData*, lanes>& unaliased data) noexcept
+{
+	Gather(payoff_i, &CPayoffData::payoff_i, data);
+	switch (adjointDifferentiation)
+	{
+		case EAdjointDifferentiation::Vega:
+			Gather(vega_i, &CPayoffData::vega_i, data);
+			break;
+		case EAdjointDifferentiation::Rho:
+			Gather(rho_i, &CPayoffData::rho_i, data);
+			Gather(rhoBorrow_i, &CPayoffData::rhoBorrow_i, data);
+			break;
+		case EAdjointDifferentiation::All:
+			Gather(vega_i, &CPayoffData::vega_i, data);
+			Gather(rho_i, &CPayoffData::rho_i, data);
+			Gather(rhoBorrow_i, &CPayoffData::rhoBorrow_i, data);
+			break;
+		default:
+			break;
+	}
+}
+
+template<size_t lanes>
+template<EAdjointDifferentiation adjointDifferentiation>
+void CBatchPayoffData<lanes>::Scatter(const std::array<CPayoffData*, lanes>& unaliased data) const noexcept
+{
+	Scatter(data, &CPayoffData::payoff_i, payoff_i);
+	switch (adjointDifferentiation)
+	{
+		case EAdjointDifferentiation::Vega:
+			Scatter(data, &CPayoffData::vega_i, vega_i);
+			break;
+		case EAdjointDifferentiation::Rho:
+			Scatter(data, &CPayoffData::rho_i, rho_i);
+			Scatter(data, &CPayoffData::rhoBorrow_i, rhoBorrow_i);
+			break;
+		case EAdjointDifferentiation::All:
+			Scatter(data, &CPayoffData::vega_i, vega_i);
+			Scatter(data, &CPayoffData::rho_i, rho_i);
+			Scatter(data, &CPayoffData::rhoBorrow_i, rhoBorrow_i);
+			break;
+		default:
+			break;
+	}
+}
+
+template<size_t lanes>
+void CBatchPayoffData<lanes>::Gather(details::AlignedVector<Lane>& unaliased out, const Member member, const std::array<const CPayoffData*, lanes>& unaliased data) noexcept
+{
+	const size_t N = (data[0]->*member).size();
+	out.resize(N);
+
+	std::array<const double*, lanes> in;
+	for (size_t l = 0; l < lanes; ++l)
+		in[l] = (data[l]->*member).data();
+	details::Interleave<Pack>(out.data(), in, N);
+}
+
+template<size_t lanes>
+void CBatchPayoffData<lanes>::Scatter(const std::array<CPayoffData*, lanes>& unaliased data, const Member member, const details::AlignedVector<Lane>& unaliased in) noexcept
+{
+	std::array<double*, lanes> out;
+	for (size_t l = 0; l < lanes; ++l)
+		out[l] = (data[l]->*member).data();
+	details::Deinterleave<Pack>(out, in.data(), in.size());
+}
+
+}
@@ -22,10 +22,10 @@ public:
 	CInputData() noexcept;
 
 	CInputData(const CInputData& unaliased rhs) noexcept;
-	CInputData(const CInputData&& unaliased rhs) noexcept;
+	CInputData(CInputData&& unaliased rhs) noexcept;
 
 	CInputData& operator=(const CInputData& unaliased rhs) noexcept;
-	CInputData& operator=(const CInputData&& unaliased rhs) noexcept;
+	CInputData& operator=(CInputData&& unaliased rhs) noexcept;
 
 	CInputData(const double S, const double K, const double r, const double b, const double T, const double sigma, const int N) noexcept;
 	CInputData(const double S, const double K, const double r, const double T, const double sigma, int N) noexcept;
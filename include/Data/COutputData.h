@@ -8,6 +8,8 @@
 #ifndef DATA_COUTPUTDATA_H_
 #define DATA_COUTPUTDATA_H_
 
+#include <vector>
+
 namespace fdpricing
 {
 class COutputData
@@ -28,5 +30,21 @@ public:
 	double theta2 = 0.0;
 	double charm = 0.0;
 };
+
+/**
+ * Early exercise boundary S*(t) on the time grid: spot[m] is the grid point at the edge of the exercise region at time[m] = m * dt,
+ * i.e. the highest exercised point for a put and the lowest one for a call. It's NaN where nothing is exercised
+ */
+class CExerciseBoundary
+{
+public:
+	CExerciseBoundary() = default;
+	~CExerciseBoundary() = default;
+	CExerciseBoundary(const CExerciseBoundary& rhs) = default;
+	CExerciseBoundary(CExerciseBoundary&& rhs) = default;
+
+	std::vector<double> time;
+	std::vector<double> spot;
+};
 }
 #endif /* DATA_COUTPUTDATA_H_ */
@@ -10,22 +10,26 @@
 
 #include <vector>
 #include <array>
+#include <algorithm>
 
 #include <Data/EAdjointDifferentiation.h>
+#include <Utilities/CFixedVector.h>
+#include <Utilities/CAlignedAllocator.h>
 #include <Flags.h>
 
-namespace fdpricing
+namespace details
 {
 /**
  * This class stores the payoff and its differentiation w.r.t. sigma, r and b
  */
-class CPayoffData
+template<typename Vector>
+class CPayoffDataBase
 {
 public:
-	std::vector<double> payoff_i;
-	std::vector<double> vega_i;
-	std::vector<double> rho_i;
-	std::vector<double> rhoBorrow_i;
+	Vector payoff_i;
+	Vector vega_i;
+	Vector rho_i;
+	Vector rhoBorrow_i;
 
 	/**
 	 * Initialise vectors
@@ -37,7 +41,7 @@ public:
 	 * Copy only requested quantities
 	 */
 	template<EAdjointDifferentiation adjointDifferentiation>
-	void Copy(const CPayoffData& unaliased rhs) noexcept;
+	void Copy(const CPayoffDataBase& unaliased rhs) noexcept;
 
 	/**
 	 * Set to zero the requested quantities
@@ -55,6 +59,55 @@ public:
 	 */
 	template<EAdjointDifferentiation adjointDifferentiation>
 	void Lerp(const size_t i, const size_t j, const double w0, const double w1) noexcept;
+
+private:
+	static void Zero(Vector& unaliased x, const size_t N) noexcept;
+};
+}
+
+namespace fdpricing
+{
+/**
+ * Payoff data whose size is known at run time only: it's allocated from the current arena, if any
+ */
+class CPayoffData : public details::CPayoffDataBase<details::AlignedVector<double>>
+{
+};
+
+/**
+ * Payoff data with compile time size: it lives wherever its owner does, without any heap allocation
+ */
+template<size_t N>
+class CFixedPayoffData : public details::CPayoffDataBase<details::CFixedVector<double, N>>
+{
+};
+
+/**
+ * Payoff data used by the fixed size specializations: fixedN = 0 means that the size is only known at run time.
+ * T is the scalar type of payoff and tangents (see EPrecision)
+ */
+template<size_t fixedN, typename T=double>
+struct CPayoffDataSelector
+{
+	typedef details::CPayoffDataBase<details::CFixedVector<T, fixedN>> Type;
+};
+
+template<typename T>
+struct CPayoffDataSelector<0, T>
+{
+	typedef details::CPayoffDataBase<details::AlignedVector<T>> Type;
+};
+
+template<size_t fixedN>
+struct CPayoffDataSelector<fixedN, double>
+{
+	typedef CFixedPayoffData<fixedN> Type;
+};
+
+template<>
+struct CPayoffDataSelector<0, double>
+{
+	typedef CPayoffData Type;
 };
 }
 
@@ -7,33 +7,43 @@
 
 #include <Flags.h>
 
-namespace fdpricing
+namespace details
 {
 
+template<typename Vector>
 template<EAdjointDifferentiation adjointDifferentiation>
-void CPayoffData::Init(const size_t N) noexcept
+void CPayoffDataBase<Vector>::Init(const size_t N) noexcept
 {
-	payoff_i.resize(N);
+	// buffers might be reused (e.g. see CFDPricer::Reprice): resize does not zero what is already there
+	Zero(payoff_i, N);
 	switch (adjointDifferentiation) {
 		case EAdjointDifferentiation::Vega:
-			vega_i.resize(N);
+			Zero(vega_i, N);
 			break;
 		case EAdjointDifferentiation::Rho:
-			rho_i.resize(N);
-			rhoBorrow_i.resize(N);
+			Zero(rho_i, N);
+			Zero(rhoBorrow_i, N);
 			break;
 		case EAdjointDifferentiation::All:
-			vega_i.resize(N);
-			rho_i.resize(N);
-			rhoBorrow_i.resize(N);
+			Zero(vega_i, N);
+			Zero(rho_i, N);
+			Zero(rhoBorrow_i, N);
 			break;
 		default:
 			break;
 	}
 }
 
+template<typename Vector>
+void CPayoffDataBase<Vector>::Zero(Vector& unaliased x, const size_t N) noexcept
+{
+	x.resize(N);
+	std::fill(x.begin(), x.begin() + N, 0.0);
+}
+
+template<typename Vector>
 template<EAdjointDifferentiation adjointDifferentiation>
-void CPayoffData::Copy(const CPayoffData& unaliased rhs) noexcept
+void CPayoffDataBase<Vector>::Copy(const CPayoffDataBase& unaliased rhs) noexcept
 {
 	payoff_i = rhs.payoff_i;
 	switch (adjointDifferentiation)
@@ -55,8 +65,9 @@ void CPayoffData::Copy(const CPayoffData& unaliased rhs) noexcept
 	}
 }
 
+template<typename Vector>
 template<EAdjointDifferentiation adjointDifferentiation>
-void CPayoffData::ZeroGreeks(const size_t i) noexcept
+void CPayoffDataBase<Vector>::ZeroGreeks(const size_t i) noexcept
 {
 	switch (adjointDifferentiation)
 	{
@@ -77,8 +88,9 @@ void CPayoffData::ZeroGreeks(const size_t i) noexcept
 	}
 }
 
+template<typename Vector>
 template<EAdjointDifferentiation adjointDifferentiation>
-void CPayoffData::Lerp(const size_t i, const size_t j, const double w0, const double w1) noexcept
+void CPayoffDataBase<Vector>::Lerp(const size_t i, const size_t j, const double w0, const double w1) noexcept
 {
 	payoff_i[i] = w0 * payoff_i[j - 1] + w1 * payoff_i[j];
 
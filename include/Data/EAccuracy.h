@@ -0,0 +1,30 @@
+/*
+ * EAccuracy.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef DATA_EACCURACY_H_
+#define DATA_EACCURACY_H_
+
+namespace fdpricing
+{
+
+/**
+ * Accuracy tier of the batch special functions in CStats (max absolute error of the normal CDF):
+ * 	- Fast: Abramovitz-Stegun (7.1.25), ~1e-5, e.g. for risk scenarios
+ * 	- Standard: Abramovitz-Stegun (7.1.26), ~1e-7, the same approximation as CStats::normCdf(double)
+ * 	- Exact: Cody's rational approximations of erfc, full double precision, for reference pricing
+ * exp and log are ~1e-7 relative in the Fast tier, and within a few ulp's otherwise
+ */
+enum class EAccuracy
+{
+	Fast,
+	Standard,
+	Exact
+};
+
+}
+
+#endif /* DATA_EACCURACY_H_ */
@@ -16,6 +16,25 @@ enum class ECalculationType
 	All
 };
 
+namespace details
+{
+
+/**
+ * What is left to price of calculationType, once acceleratedType has been taken care of
+ */
+constexpr ECalculationType RemainingCalculationType(const ECalculationType calculationType, const ECalculationType acceleratedType) noexcept
+{
+	if (acceleratedType == ECalculationType::Null)
+		return calculationType;
+	if (calculationType == ECalculationType::All)
+		return acceleratedType == ECalculationType::CallOnly ? ECalculationType::PutOnly : ECalculationType::CallOnly;
+	if (calculationType == acceleratedType)
+		return ECalculationType::Null;
+
+	return calculationType;
+}
+
+}
 
 
 #endif /* DATA_ECALCULATIONTYPE_H_ */
@@ -0,0 +1,28 @@
+/*
+ * EOperatorStorage.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef DATA_EOPERATORSTORAGE_H_
+#define DATA_EOPERATORSTORAGE_H_
+
+namespace fdpricing
+{
+
+/**
+ * How the evolution operator is stored:
+ * 	- Assembled: the tridiagonal matrices (and their Jacobians) are computed once and read at each step
+ * 	- MatrixFree: only the stencil weights of the grid are stored, the coefficients are computed during the sweeps
+ */
+enum class EOperatorStorage
+{
+	Null,
+	Assembled,
+	MatrixFree
+};
+
+}
+
+#endif /* DATA_EOPERATORSTORAGE_H_ */
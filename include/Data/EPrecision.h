@@ -0,0 +1,51 @@
+/*
+ * EPrecision.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef DATA_EPRECISION_H_
+#define DATA_EPRECISION_H_
+
+namespace fdpricing
+{
+
+/**
+ * Floating point precision of the backward induction:
+ * 	- Double: everything in double precision
+ * 	- Single: payoff, tangents and operators in single precision
+ */
+enum class EPrecision
+{
+	Null,
+	Double,
+	Single
+};
+
+}
+
+namespace details
+{
+
+/**
+ * Value: scalar type of payoff, tangents and of the operators applied to them
+ * Factor: scalar type of the Thomas algorithm factors
+ */
+template<fdpricing::EPrecision precision>
+struct CPrecisionTraits
+{
+	typedef double Value;
+	typedef double Factor;
+};
+
+template<>
+struct CPrecisionTraits<fdpricing::EPrecision::Single>
+{
+	typedef float Value;
+	typedef float Factor;
+};
+
+}
+
+#endif /* DATA_EPRECISION_H_ */
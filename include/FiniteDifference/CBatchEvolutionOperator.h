@@ -0,0 +1,112 @@
+/*
+ * CBatchEvolutionOperator.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef FINITEDIFFERENCE_CBATCHEVOLUTIONOPERATOR_H_
+#define FINITEDIFFERENCE_CBATCHEVOLUTIONOPERATOR_H_
+
+#include <array>
+
+#include <FiniteDifference/CEvolutionOperator.h>
+#include <FiniteDifference/CTridiagonalKernels.h>
+#include <Data/CBatchPayoffData.h>
+#include <Flags.h>
+
+namespace fdpricing
+{
+
+/**
+ * Evolution operators of several options with the same N interleaved lane by lane: as the Thomas recurrence is serial in the grid index,
+ * a single option cannot use more than one vector lane, whereas here every instruction advances all the options of the batch
+ */
+template<ESolverType solverType=ESolverType::CrankNicolson,
+		EGridType gridType=EGridType::Adaptive,
+		EAdjointDifferentiation adjointDifferentiation=EAdjointDifferentiation::All,
+		size_t lanes=details::CPack<double>::width>
+class CBatchEvolutionOperator
+{
+public:
+	typedef CEvolutionOperator<solverType, gridType, adjointDifferentiation> Operator;
+	typedef CBatchPayoffData<lanes> PayoffData;
+	typedef typename PayoffData::Lane Lane;
+
+	/**
+	 * The input operators must have been built with the same N
+	 */
+	explicit CBatchEvolutionOperator(const std::array<const Operator*, lanes>& unaliased u) noexcept;
+
+	virtual ~CBatchEvolutionOperator() = default;
+
+	CBatchEvolutionOperator(const CBatchEvolutionOperator& rhs) = delete;
+	CBatchEvolutionOperator(const CBatchEvolutionOperator&& rhs) = delete;
+	CBatchEvolutionOperator& operator=(const CBatchEvolutionOperator& rhs) = delete;
+	CBatchEvolutionOperator& operator=(const CBatchEvolutionOperator&& rhs) = delete;
+
+	/**
+	 * Same as CEvolutionOperator::Apply, for all the lanes at once
+	 */
+	template<size_t nRhs>
+	void Apply(const std::array<PayoffData*, nRhs>& unaliased x) const noexcept;
+
+	const Lane& GetDt() const noexcept
+	{
+		return dt;
+	}
+
+private:
+	typedef CTridiagonalOperator<gridType, adjointDifferentiation> TridiagonalOperator;
+	typedef details::CTridiagonalKernels<Lane, details::CScalarPack<Lane>> Kernels;
+	typedef std::array<details::AlignedVector<Lane>, 3> Matrix;
+
+	static constexpr size_t nUncoupledTangents = TridiagonalOperator::nUncoupledTangents;
+	static constexpr size_t nCoupledTangents = TridiagonalOperator::nCoupledTangents;
+
+	/**
+	 * Interleaved operator together with its Jacobians
+	 */
+	struct CLaneOperator
+	{
+		Matrix matrix;
+		Matrix matrixVega;
+		Matrix matrixRhoBorrow;
+	};
+
+	const size_t N;
+	Lane dt;
+
+	CLaneOperator A;
+	CLaneOperator B;
+
+	/**
+	 * Interleaved Thomas Algorithm factors of A
+	 */
+	details::AlignedVector<Lane> upperFactor;
+	details::AlignedVector<Lane> inversePivot;
+
+	void Interleave(CLaneOperator& unaliased out, const std::array<const TridiagonalOperator*, lanes>& unaliased in) noexcept;
+	void Interleave(Matrix& unaliased out, const std::array<const details::Matrix<>*, lanes>& unaliased in) noexcept;
+	void Interleave(details::AlignedVector<Lane>& unaliased out, const std::array<const double*, lanes>& unaliased in) noexcept;
+
+	/**
+	 * Same layout as in CTridiagonalOperator
+	 */
+	template<size_t nRhs>
+	void SetUncoupledVectors(std::array<Lane*, nRhs * (1 + nUncoupledTangents)>& unaliased x, const std::array<PayoffData*, nRhs>& unaliased payoffData) const noexcept;
+	template<size_t nRhs>
+	void SetJacobianTerms(std::array<details::CJacobianTerm<Lane>, nRhs * nCoupledTangents>& unaliased terms, std::array<Lane*, nRhs * nCoupledTangents>& unaliased v,
+			const CLaneOperator& unaliased J, const std::array<PayoffData*, nRhs>& unaliased payoffData) const noexcept;
+	template<size_t nRhs>
+	void SetSweepVectors(std::array<details::CSweepVector<Lane>, nRhs * (1 + nUncoupledTangents + nCoupledTangents)>& unaliased x,
+			const CLaneOperator& unaliased J, const std::array<PayoffData*, nRhs>& unaliased payoffData) const noexcept;
+	void SetJacobians(details::CSweepVector<Lane>* unaliased tangents, const CLaneOperator& unaliased J, PayoffData& unaliased payoffData) const noexcept;
+	void SetJacobian(details::CSweepVector<Lane>& unaliased tangent, details::AlignedVector<Lane>& unaliased x, const Matrix& unaliased J) const noexcept;
+};
+
+} /* namespace fdpricing */
+
+#include <FiniteDifference/CBatchEvolutionOperator.tpp>
+
+#endif /* FINITEDIFFERENCE_CBATCHEVOLUTIONOPERATOR_H_ */
@@ -0,0 +1,245 @@
+/*
+ * CBatchEvolutionOperator.tpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#include <Flags.h>
+
+namespace fdpricing
+{
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+CBatchEvolutionOperator<solverType, gridType, adjointDifferentiation, lanes>::CBatchEvolutionOperator(const std::array<const Operator*, lanes>& unaliased u) noexcept
+	: N(u[0]->A.N)
+{
+#ifdef DEBUG
+	for (size_t l = 0; l < lanes; ++l)
+	{
+		if (u[l]->A.N != N)
+		{
+			printf("*** WRONG OPERATOR SIZE ***\n");
+			return;
+		}
+	}
+#endif
+
+	std::array<const TridiagonalOperator*, lanes> operators;
+	std::array<const double*, lanes> upper, pivot;
+	for (size_t l = 0; l < lanes; ++l)
+	{
+		dt[l] = u[l]->dt;
+		operators[l] = &u[l]->A;
+		upper[l] = u[l]->A.upperFactor.data();
+		pivot[l] = u[l]->A.inversePivot.data();
+	}
+	Interleave(A, operators);
+
+	switch (solverType)
+	{
+		case ESolverType::ImplicitEuler:
+			Interleave(upperFactor, upper);
+			Interleave(inversePivot, pivot);
+			break;
+		case ESolverType::CrankNicolson:
+			Interleave(upperFactor, upper);
+			Interleave(inversePivot, pivot);
+
+			for (size_t l = 0; l < lanes; ++l)
+				operators[l] = u[l]->B.get();
+			Interleave(B, operators);
+			break;
+		default:
+			break;
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+void CBatchEvolutionOperator<solverType, gridType, adjointDifferentiation, lanes>::Interleave(CLaneOperator& unaliased out, const std::array<const TridiagonalOperator*, lanes>& unaliased in) noexcept
+{
+	std::array<const details::Matrix<>*, lanes> matrices;
+
+	for (size_t l = 0; l < lanes; ++l)
+		matrices[l] = &in[l]->matrix;
+	Interleave(out.matrix, matrices);
+
+	if (adjointDifferentiation == EAdjointDifferentiation::Vega || adjointDifferentiation == EAdjointDifferentiation::All)
+	{
+		for (size_t l = 0; l < lanes; ++l)
+			matrices[l] = &in[l]->matrixVega;
+		Interleave(out.matrixVega, matrices);
+	}
+
+	if (adjointDifferentiation == EAdjointDifferentiation::Rho || adjointDifferentiation == EAdjointDifferentiation::All)
+	{
+		for (size_t l = 0; l < lanes; ++l)
+			matrices[l] = &in[l]->matrixRhoBorrow;
+		Interleave(out.matrixRhoBorrow, matrices);
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+void CBatchEvolutionOperator<solverType, gridType, adjointDifferentiation, lanes>::Interleave(Matrix& unaliased out, const std::array<const details::Matrix<>*, lanes>& unaliased in) noexcept
+{
+	for (const auto idx : { details::Minus, details::Zero, details::Plus })
+	{
+		std::array<const double*, lanes> diagonals;
+		for (size_t l = 0; l < lanes; ++l)
+			diagonals[l] = in[l]->Get(idx);
+		Interleave(out[idx], diagonals);
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+void CBatchEvolutionOperator<solverType, gridType, adjointDifferentiation, lanes>::Interleave(details::AlignedVector<Lane>& unaliased out, const std::array<const double*, lanes>& unaliased in) noexcept
+{
+	out.resize(N);
+	details::Interleave<typename PayoffData::Pack>(out.data(), in, N);
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+template<size_t nRhs>
+void CBatchEvolutionOperator<solverType, gridType, adjointDifferentiation, lanes>::Apply(const std::array<PayoffData*, nRhs>& unaliased out) const noexcept
+{
+#ifdef DEBUG
+	for (size_t j = 0; j < nRhs; ++j)
+	{
+		if (out[j]->payoff_i.size() != N)
+		{
+			printf("*** WRONG PAYOFF SIZE ***\n");
+			return;
+		}
+	}
+#endif
+
+	// same steps as in CTridiagonalOperator: see there for the tangent relations
+	std::array<details::CSweepVector<Lane>, nRhs * (1 + nUncoupledTangents + nCoupledTangents)> x;
+	std::array<Lane*, nRhs * (1 + nUncoupledTangents)> uncoupled;
+	std::array<details::CJacobianTerm<Lane>, nRhs * nCoupledTangents> terms;
+	std::array<Lane*, nRhs * nCoupledTangents> v;
+	const Lane minusOne = PayoffData::Pack::Broadcast(-1.0);
+
+	switch (solverType)
+	{
+		case ESolverType::ExplicitEuler:
+			SetSweepVectors<nRhs>(x, A, out);
+			Kernels::Dot(A.matrix[details::Minus].data(), A.matrix[details::Zero].data(), A.matrix[details::Plus].data(), x, N);
+			break;
+		case ESolverType::ImplicitEuler:
+			SetUncoupledVectors<nRhs>(uncoupled, out);
+			Kernels::Solve(uncoupled, A.matrix[details::Minus].data(), upperFactor.data(), inversePivot.data(), N);
+
+			if (!nCoupledTangents)
+				break;
+
+			SetJacobianTerms<nRhs>(terms, v, A, out);
+			Kernels::Add(minusOne, terms, N);
+			Kernels::Solve(v, A.matrix[details::Minus].data(), upperFactor.data(), inversePivot.data(), N);
+			break;
+		case ESolverType::CrankNicolson:
+			SetSweepVectors<nRhs>(x, B, out);
+			Kernels::DotForwardSubstitute(B.matrix[details::Minus].data(), B.matrix[details::Zero].data(), B.matrix[details::Plus].data(), x,
+					A.matrix[details::Minus].data(), inversePivot.data(), N);
+
+			SetUncoupledVectors<nRhs>(uncoupled, out);
+			Kernels::BackSubstitute(uncoupled, upperFactor.data(), N);
+
+			if (!nCoupledTangents)
+				break;
+
+			SetJacobianTerms<nRhs>(terms, v, A, out);
+			Kernels::AddForwardSubstitute(minusOne, terms, A.matrix[details::Minus].data(), inversePivot.data(), N);
+			Kernels::BackSubstitute(v, upperFactor.data(), N);
+			break;
+		default:
+			break;
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+template<size_t nRhs>
+void CBatchEvolutionOperator<solverType, gridType, adjointDifferentiation, lanes>::SetUncoupledVectors(std::array<Lane*, nRhs * (1 + nUncoupledTangents)>& unaliased x,
+		const std::array<PayoffData*, nRhs>& unaliased out) const noexcept
+{
+	for (size_t j = 0; j < nRhs; ++j)
+	{
+		x[j] = out[j]->payoff_i.data();
+		if (nUncoupledTangents)
+			x[nRhs + j] = out[j]->rho_i.data();
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+template<size_t nRhs>
+void CBatchEvolutionOperator<solverType, gridType, adjointDifferentiation, lanes>::SetJacobianTerms(std::array<details::CJacobianTerm<Lane>, nRhs * nCoupledTangents>& unaliased terms,
+		std::array<Lane*, nRhs * nCoupledTangents>& unaliased v, const CLaneOperator& unaliased J, const std::array<PayoffData*, nRhs>& unaliased out) const noexcept
+{
+	std::array<details::CSweepVector<Lane>, nRhs * nCoupledTangents> tangents;
+	for (size_t j = 0; j < nRhs; ++j)
+		SetJacobians(tangents.data() + j * nCoupledTangents, J, *out[j]);
+
+	// the Jacobian is applied to the updated payoff
+	for (size_t k = 0; k < tangents.size(); ++k)
+	{
+		terms[k].out = v[k] = tangents[k].x;
+		terms[k].x = out[k / nCoupledTangents]->payoff_i.data();
+		terms[k].jacobianSub   = tangents[k].jacobianSub;
+		terms[k].jacobianDiag  = tangents[k].jacobianDiag;
+		terms[k].jacobianSuper = tangents[k].jacobianSuper;
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+template<size_t nRhs>
+void CBatchEvolutionOperator<solverType, gridType, adjointDifferentiation, lanes>::SetSweepVectors(std::array<details::CSweepVector<Lane>, nRhs * (1 + nUncoupledTangents + nCoupledTangents)>& unaliased x,
+		const CLaneOperator& unaliased J, const std::array<PayoffData*, nRhs>& unaliased out) const noexcept
+{
+	// payoffs first, then the tangents of each input
+	constexpr size_t nTangents = nUncoupledTangents + nCoupledTangents;
+	for (size_t j = 0; j < nRhs; ++j)
+	{
+		details::CSweepVector<Lane>* unaliased tangents = x.data() + nRhs + j * nTangents;
+
+		x[j].x = out[j]->payoff_i.data();
+		if (nUncoupledTangents)
+			tangents++->x = out[j]->rho_i.data();
+
+		SetJacobians(tangents, J, *out[j]);
+		for (size_t k = 0; k < nCoupledTangents; ++k)
+			tangents[k].source = j;
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+void CBatchEvolutionOperator<solverType, gridType, adjointDifferentiation, lanes>::SetJacobians(details::CSweepVector<Lane>* unaliased tangents,
+		const CLaneOperator& unaliased J, PayoffData& unaliased out) const noexcept
+{
+	switch (adjointDifferentiation)
+	{
+		case EAdjointDifferentiation::Vega:
+			SetJacobian(tangents[0], out.vega_i, J.matrixVega);
+			break;
+		case EAdjointDifferentiation::Rho:
+			SetJacobian(tangents[0], out.rhoBorrow_i, J.matrixRhoBorrow);
+			break;
+		case EAdjointDifferentiation::All:
+			SetJacobian(tangents[0], out.vega_i, J.matrixVega);
+			SetJacobian(tangents[1], out.rhoBorrow_i, J.matrixRhoBorrow);
+			break;
+		default:
+			break;
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+void CBatchEvolutionOperator<solverType, gridType, adjointDifferentiation, lanes>::SetJacobian(details::CSweepVector<Lane>& unaliased tangent,
+		details::AlignedVector<Lane>& unaliased x, const Matrix& unaliased J) const noexcept
+{
+	tangent.x = x.data();
+	tangent.jacobianSub   = J[details::Minus].data();
+	tangent.jacobianDiag  = J[details::Zero].data();
+	tangent.jacobianSuper = J[details::Plus].data();
+}
+
+} /* namespace fdpricing */
@@ -0,0 +1,84 @@
+/*
+ * CBatchPricer.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef FINITEDIFFERENCE_CBATCHPRICER_H_
+#define FINITEDIFFERENCE_CBATCHPRICER_H_
+
+#include <vector>
+#include <array>
+#include <memory>
+
+#include <FiniteDifference/CFDPricer.h>
+#include <FiniteDifference/CBatchEvolutionOperator.h>
+#include <Data/CBatchPayoffData.h>
+#include <Flags.h>
+
+namespace fdpricing
+{
+
+/**
+ * Portfolio pricer: options sharing N, M and smoothing are grouped, and each group is priced `lanes` options at a time
+ * with a CBatchEvolutionOperator. The solver type is a template parameter, hence it is the same for the whole portfolio.
+ *
+ * Dividend paying or accelerated options have option dependent time steps, so they are priced one by one
+ */
+template <ESolverType solverType=ESolverType::CrankNicolson,
+		EGridType gridType=EGridType::Adaptive,
+		EAdjointDifferentiation adjointDifferentiation=EAdjointDifferentiation::All,
+		size_t lanes=details::CPack<double>::width>
+class CBatchPricer
+{
+public:
+	CBatchPricer(const std::vector<CInputData>& unaliased inputs, const CPricerSettings& unaliased settings) noexcept;
+
+	CBatchPricer(const CBatchPricer& rhs) = delete;
+	CBatchPricer(const CBatchPricer&& rhs) = delete;
+	CBatchPricer& operator=(const CBatchPricer& rhs) = delete;
+	CBatchPricer& operator=(const CBatchPricer&& rhs) = delete;
+
+	virtual ~CBatchPricer() = default;
+
+	/**
+	 * Outputs are resized to the number of inputs and filled in the same order
+	 */
+	void Price(std::vector<COutputData>& unaliased callOutputs, std::vector<COutputData>& unaliased putOutputs) noexcept;
+
+	/**
+	 * Options that can be priced by a CBatchEvolutionOperator
+	 */
+	static bool IsBatchable(const CInputData& unaliased input) noexcept;
+
+private:
+	typedef CFDPricer<solverType, gridType, adjointDifferentiation> Pricer;
+	typedef CBatchEvolutionOperator<solverType, gridType, adjointDifferentiation, lanes> BatchOperator;
+	typedef CBatchPayoffData<lanes> PayoffData;
+	typedef typename PayoffData::Lane Lane;
+
+	const std::vector<CInputData>& unaliased inputs;
+	const CPricerSettings& unaliased settings;
+	const bool calculateCall;
+	const bool calculatePut;
+
+	/**
+	 * Price the options inputs[idx[0]], ..., inputs[idx[lanes - 1]], which must have the same N, M and smoothing
+	 */
+	void PriceBatch(const std::array<size_t, lanes>& unaliased idx, std::vector<COutputData>& unaliased callOutputs, std::vector<COutputData>& unaliased putOutputs) noexcept;
+
+	/**
+	 * Same as CFDPricer::PostStep, lane by lane
+	 */
+	template<bool exercise>
+	void PostStep(PayoffData& unaliased data, const details::AlignedVector<Lane>& unaliased intrinsicValue, const double sign, const Lane& unaliased dt) const noexcept;
+
+	void SaveLeaves(const size_t m, const PayoffData& unaliased data, std::array<typename Pricer::TimeLeaves, lanes>& unaliased leavesDt) const noexcept;
+};
+
+} /* namespace fdpricing */
+
+#include <FiniteDifference/CBatchPricer.tpp>
+
+#endif /* FINITEDIFFERENCE_CBATCHPRICER_H_ */
@@ -0,0 +1,229 @@
+/*
+ * CBatchPricer.tpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#include <map>
+#include <tuple>
+#include <algorithm>
+
+#include <Flags.h>
+
+namespace fdpricing
+{
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+CBatchPricer<solverType, gridType, adjointDifferentiation, lanes>::CBatchPricer(const std::vector<CInputData>& unaliased inputs,
+																		const CPricerSettings& unaliased settings) noexcept
+		: inputs(inputs), settings(settings),
+		  calculateCall(settings.calculationType == ECalculationType::All || settings.calculationType == ECalculationType::CallOnly),
+		  calculatePut(settings.calculationType == ECalculationType::All || settings.calculationType == ECalculationType::PutOnly)
+{
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+bool CBatchPricer<solverType, gridType, adjointDifferentiation, lanes>::IsBatchable(const CInputData& unaliased input) noexcept
+{
+	return input.dividends.empty() && !input.acceleration;
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+void CBatchPricer<solverType, gridType, adjointDifferentiation, lanes>::Price(std::vector<COutputData>& unaliased callOutputs, std::vector<COutputData>& unaliased putOutputs) noexcept
+{
+	callOutputs.resize(inputs.size());
+	putOutputs.resize(inputs.size());
+
+	// (N, M, smoothing) -> options
+	std::map<std::tuple<size_t, size_t, bool>, std::vector<size_t>> groups;
+	for (size_t i = 0; i < inputs.size(); ++i)
+	{
+		if (IsBatchable(inputs[i]))
+			groups[std::make_tuple(inputs[i].N, inputs[i].M, inputs[i].smoothing)].push_back(i);
+		else
+		{
+			Pricer pricer(inputs[i], settings);
+			pricer.Price(callOutputs[i], putOutputs[i]);
+		}
+	}
+
+	for (const auto& group : groups)
+	{
+		const std::vector<size_t>& indices = group.second;
+		for (size_t start = 0; start < indices.size(); start += lanes)
+		{
+			// the last batch is padded with copies of its last option
+			std::array<size_t, lanes> idx;
+			for (size_t l = 0; l < lanes; ++l)
+				idx[l] = indices[std::min(start + l, indices.size() - 1)];
+
+			PriceBatch(idx, callOutputs, putOutputs);
+		}
+	}
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+void CBatchPricer<solverType, gridType, adjointDifferentiation, lanes>::PriceBatch(const std::array<size_t, lanes>& unaliased idx,
+		std::vector<COutputData>& unaliased callOutputs, std::vector<COutputData>& unaliased putOutputs) noexcept
+{
+	const size_t N = inputs[idx[0]].N;
+
+	// initial condition (and smoothing) is set by each pricer
+	size_t m = 0;
+	std::array<std::unique_ptr<Pricer>, lanes> pricers;
+	std::array<const typename Pricer::Operator*, lanes> u;
+	std::array<const double*, lanes> intrinsicValues;
+	std::array<CPayoffData*, lanes> callData, putData;
+	std::array<const CPayoffData*, lanes> callInput, putInput;
+	for (size_t l = 0; l < lanes; ++l)
+	{
+		pricers[l] = std::make_unique<Pricer>(inputs[idx[l]], settings);
+
+		m = inputs[idx[l]].M;
+		Pricer& unaliased pricer = *pricers[l];
+		pricer.Dispatch([&](auto calculationType, auto exerciseType)
+		{
+			pricer.template PayoffInitialise<decltype(calculationType)::value, decltype(exerciseType)::value>(m);
+		});
+
+		u[l] = pricers[l]->u.get();
+		intrinsicValues[l] = pricers[l]->intrinsicValue.data();
+		callInput[l] = callData[l] = &pricers[l]->callData;
+		putInput[l] = putData[l] = &pricers[l]->putData;
+	}
+
+	const BatchOperator batchOperator(u);
+
+	details::AlignedVector<Lane> intrinsicValue(N);
+	details::Interleave<typename PayoffData::Pack>(intrinsicValue.data(), intrinsicValues, N);
+
+	PayoffData batchCallData, batchPutData;
+	if (calculateCall)
+		batchCallData.template Gather<adjointDifferentiation>(callInput);
+	if (calculatePut)
+		batchPutData.template Gather<adjointDifferentiation>(putInput);
+
+	std::array<typename Pricer::TimeLeaves, lanes> callLeavesDt, putLeavesDt;
+	const bool american = settings.exerciseType == EExerciseType::American;
+	for (; m --> 0 ;)
+	{
+		switch (settings.calculationType)
+		{
+			case ECalculationType::All:
+				batchOperator.Apply(std::array<PayoffData*, 2> { { &batchCallData, &batchPutData } });
+				break;
+			case ECalculationType::CallOnly:
+				batchOperator.Apply(std::array<PayoffData*, 1> { { &batchCallData } });
+				break;
+			case ECalculationType::PutOnly:
+				batchOperator.Apply(std::array<PayoffData*, 1> { { &batchPutData } });
+				break;
+			default:
+				break;
+		}
+
+		if (calculateCall)
+		{
+			if (american)
+				PostStep<true>(batchCallData, intrinsicValue, 1.0, batchOperator.GetDt());
+			else
+				PostStep<false>(batchCallData, intrinsicValue, 1.0, batchOperator.GetDt());
+		}
+		if (calculatePut)
+		{
+			if (american)
+				PostStep<true>(batchPutData, intrinsicValue, -1.0, batchOperator.GetDt());
+			else
+				PostStep<false>(batchPutData, intrinsicValue, -1.0, batchOperator.GetDt());
+		}
+
+		if (m < 3)
+		{
+			if (calculateCall)
+				SaveLeaves(m, batchCallData, callLeavesDt);
+			if (calculatePut)
+				SaveLeaves(m, batchPutData, putLeavesDt);
+		}
+	}
+
+	if (calculateCall)
+		batchCallData.template Scatter<adjointDifferentiation>(callData);
+	if (calculatePut)
+		batchPutData.template Scatter<adjointDifferentiation>(putData);
+
+	for (size_t l = 0; l < lanes; ++l)
+	{
+		Pricer& unaliased pricer = *pricers[l];
+		pricer.Dispatch([&](auto calculationType, auto)
+		{
+			pricer.template ComputeGreeks<decltype(calculationType)::value>(callOutputs[idx[l]], putOutputs[idx[l]], callLeavesDt[l], putLeavesDt[l]);
+			pricer.template SetOutput<decltype(calculationType)::value>(callOutputs[idx[l]], putOutputs[idx[l]]);
+		});
+	}
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+template<bool exercise>
+void CBatchPricer<solverType, gridType, adjointDifferentiation, lanes>::PostStep(PayoffData& unaliased data, const details::AlignedVector<Lane>& unaliased intrinsicValue,
+		const double sign, const Lane& unaliased dt) const noexcept
+{
+	constexpr bool hasVega = adjointDifferentiation == EAdjointDifferentiation::Vega || adjointDifferentiation == EAdjointDifferentiation::All;
+	constexpr bool hasRho = adjointDifferentiation == EAdjointDifferentiation::Rho || adjointDifferentiation == EAdjointDifferentiation::All;
+
+	if (!exercise && !hasRho)
+		return;
+
+	Lane* unaliased payoff = data.payoff_i.data();
+	Lane* unaliased vega = data.vega_i.data();
+	Lane* unaliased rho = data.rho_i.data();
+	const Lane* unaliased intrinsic = intrinsicValue.data();
+
+	const Lane zero = { };
+	auto anyExercised = zero < zero;
+	details::CInstructionSet::Dispatch([&](auto)
+	{
+		for (size_t i = 0; i < data.payoff_i.size(); ++i)
+		{
+			const Lane continuationValue = payoff[i];
+			if (hasRho)
+				rho[i] = -dt * continuationValue + rho[i];
+
+			if (exercise)
+			{
+				const Lane exerciseValue = sign * intrinsic[i];
+				const auto exercised = exerciseValue > continuationValue;
+				payoff[i] = exercised ? exerciseValue : continuationValue;
+				if (hasVega)
+					vega[i] = exercised ? zero : vega[i];
+				anyExercised |= exercised;
+			}
+		}
+	});
+
+	// same convention as CPayoffData::ZeroGreeks
+	if (exercise && hasRho)
+	{
+		rho[0] = anyExercised ? zero : rho[0];
+		data.rhoBorrow_i[0] = anyExercised ? zero : data.rhoBorrow_i[0];
+	}
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+void CBatchPricer<solverType, gridType, adjointDifferentiation, lanes>::SaveLeaves(const size_t m, const PayoffData& unaliased data,
+		std::array<typename Pricer::TimeLeaves, lanes>& unaliased leavesDt) const noexcept
+{
+	if (m == 0)
+		return;
+
+	const size_t mid = data.payoff_i.size() >> 1;
+	const size_t idx = 3 * (m - 1);
+	for (size_t l = 0; l < lanes; ++l)
+	{
+		leavesDt[l][idx]     = data.payoff_i[mid - 1][l];
+		leavesDt[l][idx + 1] = data.payoff_i[mid][l];
+		leavesDt[l][idx + 2] = data.payoff_i[mid + 1][l];
+	}
+}
+
+} /* namespace fdpricing */
@@ -23,21 +23,107 @@ struct CFiniteDifferenceSettings
 {
 	double lowerFactor = 1e-3;
 	double upperFactor = 10.0;
+
+	/**
+	 * Operators over the dividend sub-steps kept by each pricer (see CEvolutionOperatorCache): at least 1
+	 */
+	size_t maxCachedOperators = 8;
+
+	/**
+	 * Temporal blocking of the explicit scheme: on grids of at least temporalBlockingMinN points, up to temporalBlockingSteps steps
+	 * are advanced at once on tiles of about temporalBlockingTileSize points, which stay in cache meanwhile. 1 step disables it.
+	 * Dividends and the last steps (see CFDPricer::SaveLeaves) are not blocked
+	 */
+	size_t temporalBlockingSteps = 16;
+	size_t temporalBlockingTileSize = 1024;
+	size_t temporalBlockingMinN = 16384;
+
+	/**
+	 * Active window: the points at the edges of the grid whose values (and tangents) change by at most activeWindowTolerance in a step
+	 * are frozen, and the operators are applied to the remaining window only. This typically happens in the early exercise region
+	 * and in the far field where the option is worthless: 0 disables it. It's a threshold on the change of a point in a single step, not a bound
+	 * on the pricing error: the frozen points skip all the later updates (the rho accumulation too), and how much that moves price and greeks
+	 * depends on the grid, the number of steps and the option. Call and put have a window each (see CFDPricer::GetFrozenPoints).
+	 * It's not used by the matrix free operators, together with temporal blocking and with Brennan-Schwartz
+	 */
+	double activeWindowTolerance = 0.0;
+
+	/**
+	 * American exercise of a vanilla: the exercise region is an interval attached to the grid boundary (below S* for a put, above it for a call),
+	 * so once it is found its edge is tracked and only a neighbourhood of it is compared against the intrinsic value, the rest of the region
+	 * being assigned its exercise value. The full comparison is done whenever the edge leaves the neighbourhood or the region detaches from the boundary.
+	 * Cash dividends break this shape (e.g. the put is not exercised right before a dividend when S is small), so it's not used with dividends
+	 */
+	bool trackExerciseRegion = true;
+
+	/**
+	 * Partitioned steps: on grids of at least parallelSolveMinN points, each step is split across parallelSolveThreads threads
+	 * (0: one per hardware thread), each one owning a contiguous partition of the grid of at least minPartitionSize points.
+	 * The same thread runs the operator products, the implicit solves (partition method, see CTridiagonalOperator::Partition),
+	 * rho roll back and early exercise on its partition. The results are the same up to rounding. 0 points or 1 thread disable it.
+	 * It's meant for single options on very large grids: pricing many options, it's better to run one per thread.
+	 * It's not used by the matrix free operators and over the dividend sub-steps. It replaces temporal blocking and the active window, and the partitions are projected (see brennanSchwartz)
+	 */
+	size_t parallelSolveThreads = 0;
+	size_t parallelSolveMinN = 32768;
+	size_t minPartitionSize = 1024;
+
+	/**
+	 * Hybrid cyclic reduction (see CTridiagonalOperator::FactorizeCyclicReduction): the implicit operators on grids of up to cyclicReductionMaxN points
+	 * keep its factors too, and the pricers solve with it rather than with the Thomas algorithm. It's meant for the latency of a single option
+	 * on a small grid: with many vectors (e.g. call, put and their greeks) the Thomas recurrences overlap anyway. 0 disables it.
+	 * It's not used by the matrix free operators, together with Brennan-Schwartz, over an active window and by the partitioned steps
+	 */
+	size_t cyclicReductionMaxN = 0;
+
+	/**
+	 * American exercise within the implicit solves (Brennan-Schwartz, see CTridiagonalOperator::Solve), rather than projecting after them.
+	 * It needs the exercise region to be attached to the grid boundary, which is not the case for puts with cash dividends: those are projected.
+	 * The implicit operators keep the UL factors too (see CTridiagonalOperator::FactorizeReversed), which the puts solve with.
+	 * It's not used by the explicit scheme (no solve), the matrix free operators and the batch pricer. It replaces the active window
+	 */
+	bool brennanSchwartz = false;
 };
 
 /**
  * This class is a wrapper of CTridiagonalOperator for facilitating the operations (i.e. solve and dot product)
+ *
+ * fixedN, precision: see CTridiagonalOperator
  */
 template<ESolverType solverType=ESolverType::CrankNicolson,
 		EGridType gridType=EGridType::Adaptive,
-		EAdjointDifferentiation adjointDifferentiation=EAdjointDifferentiation::All>
+		EAdjointDifferentiation adjointDifferentiation=EAdjointDifferentiation::All,
+		size_t fixedN=0,
+		EPrecision precision=EPrecision::Double>
 class CEvolutionOperator
 {
 public:
+	typedef CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision> TridiagonalOperator;
+	typedef typename TridiagonalOperator::PayoffData PayoffData;
+
 	CEvolutionOperator(const CInputData& unaliased input, const CFiniteDifferenceSettings& unaliased settings) noexcept;
 
 	/**
-	 * Pseudo copy constructor: the copy is allowed only if dt needs to change (e.g. when a dividend occurs between time grid points)
+	 * Reuse a grid built with the same S, bounds and N (e.g. when only sigma changes): the operator is an axpy of its cached weights
+	 */
+	CEvolutionOperator(const CInputData& unaliased input, const CGrid<gridType>& unaliased grid, const CFiniteDifferenceSettings& unaliased settings) noexcept;
+
+	/**
+	 * Share grid and space discretization with other operators (see COperatorRegistry):
+	 * L has to be built on grid with the same sigma and b of input. If L is null, it's built here
+	 */
+	CEvolutionOperator(const CInputData& unaliased input, const std::shared_ptr<const CGrid<gridType>>& grid,
+			const std::shared_ptr<const TridiagonalOperator>& L, const CFiniteDifferenceSettings& unaliased settings) noexcept;
+
+	/**
+	 * Operator for input on the grid of rhs, which has to be built with the same S and N (see CFDPricer::Reprice):
+	 * L is shared too if sigma and b did not change
+	 */
+	CEvolutionOperator(const CInputData& unaliased input, const CEvolutionOperator& unaliased rhs, const CFiniteDifferenceSettings& unaliased settings) noexcept;
+
+	/**
+	 * Pseudo copy constructor: the copy is allowed only if dt needs to change (e.g. when a dividend occurs between time grid points).
+	 * Grid and L are shared with rhs, rather than copied
 	 */
 	CEvolutionOperator(const CEvolutionOperator& rhs, const double dt) noexcept;
 
@@ -52,30 +138,149 @@ public:
 	CEvolutionOperator& operator=(const CEvolutionOperator&& rhs) = delete;
 
 	/**
-	 * Apply left/right operators to the input vector
+	 * Apply left/right operators to the input vector. The discount factor over dt is folded into the operators,
+	 * so the output is already rolled back
+	 */
+	void Apply(PayoffData& unaliased x) const noexcept;
+
+	/**
+	 * Apply left/right operators to several input vectors at once (e.g. call and put)
 	 */
-	void Apply(CPayoffData& unaliased x) noexcept;
+	template<size_t nRhs>
+	void Apply(const std::array<PayoffData*, nRhs>& unaliased x) const noexcept;
+
+	/**
+	 * Apply the operators over an active window only (see CTridiagonalOperator): the implicit schemes need the window factors, see Factorize
+	 */
+	template<size_t nRhs>
+	void Apply(const std::array<PayoffData*, nRhs>& unaliased x, const details::CActiveWindow<typename TridiagonalOperator::Factor>& unaliased window) const noexcept;
+
+	/**
+	 * Apply the operators, the implicit solve applying the early exercise condition too (Brennan-Schwartz, see CTridiagonalOperator::Solve).
+	 * Crank-Nicolson is fused as without the exercise condition, the explicit product being computed during the elimination in either direction
+	 * (see CTridiagonalOperator::DotSolve). The explicit scheme has no solve, so the early exercise is left to the caller
+	 */
+	template<size_t nRhs>
+	void Apply(const std::array<PayoffData*, nRhs>& unaliased x, const details::CExerciseCondition<typename TridiagonalOperator::Value, nRhs>& unaliased exercise) const noexcept;
+
+	/**
+	 * Apply the operators, the implicit solve being the hybrid cyclic reduction (see CTridiagonalOperator::Solve with a buffer) if the operator has its factors,
+	 * the Thomas algorithm otherwise. Crank-Nicolson is not fused, as over an active window
+	 *
+	 * buffer: see CTridiagonalOperator::ReductionBufferSize
+	 */
+	template<size_t nRhs>
+	void Apply(const std::array<PayoffData*, nRhs>& unaliased x, typename TridiagonalOperator::Value* unaliased buffer) const noexcept;
+
+	bool HasCyclicReduction() const noexcept
+	{
+		return A.HasCyclicReduction();
+	}
+
+	/**
+	 * Whether the operators on a grid of N points built with settings have the cyclic reduction factors
+	 */
+	static bool HasCyclicReduction(const size_t N, const CFiniteDifferenceSettings& unaliased settings) noexcept;
+
+	bool HasBrennanSchwartz() const noexcept
+	{
+		return A.HasReversedFactors();
+	}
+
+	/**
+	 * Whether the operators built with settings solve with the exercise condition (see CFiniteDifferenceSettings::brennanSchwartz)
+	 */
+	static bool HasBrennanSchwartz(const CFiniteDifferenceSettings& unaliased settings) noexcept;
+
+	/**
+	 * Factors of the implicit operator rows in [begin, end): nothing to do for the explicit scheme
+	 */
+	void Factorize(const size_t begin, const size_t end, typename TridiagonalOperator::Factor* unaliased upperFactor, typename TridiagonalOperator::Factor* unaliased inversePivot) const noexcept;
+
+	/**
+	 * Apply nSteps steps, calling postStep(tile, step) after each of them (see CTridiagonalOperator::Dot with temporal blocking).
+	 * Only the explicit scheme is blocked: the implicit ones couple the whole grid at each step, so the tile is the whole grid
+	 */
+	template<size_t nRhs, typename PostStep>
+	void Apply(const std::array<PayoffData*, nRhs>& unaliased x, const size_t nSteps, const size_t tileSize, typename TridiagonalOperator::Value* unaliased buffer, PostStep&& postStep) const noexcept;
+
+	/**
+	 * Partitioned step, run by the p-th thread of team on the p-th partition (see CTridiagonalOperator::Partition): team has GetPartitions() threads,
+	 * and buffer is shared by all of them (see CTridiagonalOperator::PartitionBufferSize)
+	 */
+	template<size_t nRhs>
+	void Apply(const std::array<PayoffData*, nRhs>& unaliased x, const size_t p, details::CThreadTeam& team, typename TridiagonalOperator::Value* unaliased buffer) const noexcept;
+
+	/**
+	 * Partitions of the partitioned steps (see CFiniteDifferenceSettings::parallelSolveMinN): 1 if they are not used
+	 */
+	size_t GetPartitions() const noexcept
+	{
+		return partitions;
+	}
+
+	/**
+	 * Partitions of the operators on a grid of N points built with settings, i.e. GetPartitions() of such operators
+	 */
+	static size_t Partitions(const size_t N, const CFiniteDifferenceSettings& unaliased settings) noexcept;
+
+	size_t GetPartitionBegin(const size_t p) const noexcept
+	{
+		return A.PartitionBegin(p, partitions);
+	}
 
 	const CGrid<gridType>& GetGrid() const noexcept
+	{
+		return *grid;
+	}
+
+	const std::shared_ptr<const CGrid<gridType>>& GetSharedGrid() const noexcept
 	{
 		return grid;
 	}
 
+	const std::shared_ptr<const TridiagonalOperator>& GetSpaceDiscretization() const noexcept
+	{
+		return L;
+	}
+
 	double GetDt() const noexcept
 	{
 		return dt;
 	}
 
+	double GetDiscountFactor() const noexcept
+	{
+		return discountFactor;
+	}
+
+	/**
+	 * Whether input yields this operator, given the grid
+	 */
+	bool IsBuiltFor(const CInputData& unaliased input) const noexcept
+	{
+		return sigma == input.sigma && b == input.b && r == input.r && dt == input.T / input.M;
+	}
+
 private:
-	const CGrid<gridType> grid;
+	template<ESolverType, EGridType, EAdjointDifferentiation, size_t>
+	friend class CBatchEvolutionOperator;
+
+	const CFiniteDifferenceSettings settings;
 
-	// Space Discretization
-	const CTridiagonalOperator<gridType, adjointDifferentiation> L;
+	// Space Discretization: it does not depend on dt, hence it's shared by the operators built with the pseudo copy constructor
+	const std::shared_ptr<const CGrid<gridType>> grid;
+	const std::shared_ptr<const TridiagonalOperator> L;
 
 	// Space-Time Discretization
+	const double sigma;
+	const double b;
 	const double dt;
-	CTridiagonalOperator<gridType,adjointDifferentiation> A; // right operator
-	std::unique_ptr<CTridiagonalOperator<gridType, adjointDifferentiation>> B; // left operator
+	const double r;
+	const double discountFactor;
+	TridiagonalOperator A; // right operator
+	std::shared_ptr<TridiagonalOperator> B; // left operator
+	size_t partitions;
 
 	void ctor() noexcept;
 };
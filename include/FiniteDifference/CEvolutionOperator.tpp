@@ -10,50 +10,141 @@
 namespace fdpricing
 {
 
-template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-CEvolutionOperator<solverType, gridType, adjointDifferentiation>::CEvolutionOperator(const CInputData& unaliased input, const CFiniteDifferenceSettings& unaliased settings) noexcept
-	: grid(input.S, settings.lowerFactor * input.S, settings.upperFactor * input.S, input.N),
-	  L(input, grid),
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::CEvolutionOperator(const CInputData& unaliased input, const CFiniteDifferenceSettings& unaliased settings) noexcept
+	: settings(settings),
+	  grid(details::MakeShared<const CGrid<gridType>>(input.S, settings.lowerFactor * input.S, settings.upperFactor * input.S, input.N)),
+	  L(details::MakeShared<const TridiagonalOperator>(input, *grid)),
+	  sigma(input.sigma),
+	  b(input.b),
 	  dt(input.T / input.M),
-	  A(L)
+	  r(input.r),
+	  discountFactor(exp(-r * dt)),
+	  A(*L)
 {
 	ctor();
 }
 
-template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-CEvolutionOperator<solverType, gridType, adjointDifferentiation>::CEvolutionOperator(const CEvolutionOperator& rhs, const double dt) noexcept
-	: grid(rhs.grid), L(rhs.L), dt(dt), A(L)
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::CEvolutionOperator(const CInputData& unaliased input, const CGrid<gridType>& unaliased grid, const CFiniteDifferenceSettings& unaliased settings) noexcept
+	: settings(settings),
+	  grid(details::MakeShared<const CGrid<gridType>>(grid)),
+	  L(details::MakeShared<const TridiagonalOperator>(input, *this->grid)),
+	  sigma(input.sigma),
+	  b(input.b),
+	  dt(input.T / input.M),
+	  r(input.r),
+	  discountFactor(exp(-r * dt)),
+	  A(*L)
+{
+	ctor();
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::CEvolutionOperator(const CInputData& unaliased input, const std::shared_ptr<const CGrid<gridType>>& grid,
+		const std::shared_ptr<const TridiagonalOperator>& L, const CFiniteDifferenceSettings& unaliased settings) noexcept
+	: settings(settings),
+	  grid(grid),
+	  L(L ? L : details::MakeShared<const TridiagonalOperator>(input, *grid)),
+	  sigma(input.sigma),
+	  b(input.b),
+	  dt(input.T / input.M),
+	  r(input.r),
+	  discountFactor(exp(-r * dt)),
+	  A(*this->L)
+{
+	ctor();
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::CEvolutionOperator(const CInputData& unaliased input, const CEvolutionOperator& unaliased rhs, const CFiniteDifferenceSettings& unaliased settings) noexcept
+	: CEvolutionOperator(input, rhs.grid, (rhs.sigma == input.sigma && rhs.b == input.b) ? rhs.L : nullptr, settings)
+{
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::CEvolutionOperator(const CEvolutionOperator& rhs, const double dt) noexcept
+	: settings(rhs.settings), grid(rhs.grid), L(rhs.L), sigma(rhs.sigma), b(rhs.b), dt(dt), r(rhs.r), discountFactor(exp(-r * dt)), A(*L)
 {
 	ctor();
 }
 
-template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-void CEvolutionOperator<solverType, gridType, adjointDifferentiation>::ctor() noexcept
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::ctor() noexcept
 {
+	// The discount factor (and its Jacobian) is folded into the operators:
+	//	- explicit: x_{n} = df * A \cdot x_{n + 1}
+	//	- implicit: x_{n} = (A / df)^{-1} \cdot x_{n + 1}
+	//	- Crank-Nicolson: x_{n} = A^{-1} \cdot (df * B) \cdot x_{n + 1}
 	switch (solverType)
 	{
 		case ESolverType::ExplicitEuler:
 			A.Add(1.0, dt);
+			A.Add(0.0, discountFactor);
 			break;
 		case ESolverType::ImplicitEuler:
 			A.Add(1.0, -dt);
+			A.Add(0.0, 1.0 / discountFactor);
+			A.Factorize();
 			break;
 		case ESolverType::CrankNicolson:
 		{
-			B = std::make_unique<CTridiagonalOperator<gridType, adjointDifferentiation>>(L);
+			B = details::MakeShared<TridiagonalOperator>(*L);
 
 			const double halfDt = .5 * dt;
 			A.Add(1.0, -halfDt);
+			A.Factorize();
 			B->Add(1.0, halfDt);
+			B->Add(0.0, discountFactor);
 			break;
 		}
 		default:
 			break;
 	}
+
+	const size_t N = grid->size();
+	partitions = Partitions(N, settings);
+	if (partitions > 1 && solverType != ESolverType::ExplicitEuler)
+		A.Partition(partitions);
+
+	if (HasCyclicReduction(N, settings))
+		A.FactorizeCyclicReduction();
+
+	if (HasBrennanSchwartz(settings))
+		A.FactorizeReversed();
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+size_t CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Partitions(const size_t N, const CFiniteDifferenceSettings& unaliased settings) noexcept
+{
+	// as many partitions as threads, unless they would be too small
+	if (settings.parallelSolveMinN == 0 || N < settings.parallelSolveMinN)
+		return 1;
+
+	return std::max<size_t>(std::min(details::CThreadTeam::Size(settings.parallelSolveThreads), N / std::max<size_t>(settings.minPartitionSize, 64)), 1);
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+bool CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::HasCyclicReduction(const size_t N, const CFiniteDifferenceSettings& unaliased settings) noexcept
+{
+	return solverType != ESolverType::ExplicitEuler && N <= settings.cyclicReductionMaxN;
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+bool CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::HasBrennanSchwartz(const CFiniteDifferenceSettings& unaliased settings) noexcept
+{
+	return settings.brennanSchwartz && solverType != ESolverType::ExplicitEuler;
 }
 
-template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-void CEvolutionOperator<solverType, gridType, adjointDifferentiation>::Apply(CPayoffData& unaliased x) noexcept
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Apply(PayoffData& unaliased x) const noexcept
+{
+	Apply(std::array<PayoffData*, 1> { { &x } });
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Apply(const std::array<PayoffData*, nRhs>& unaliased x) const noexcept
 {
 	switch (solverType)
 	{
@@ -64,14 +155,131 @@ void CEvolutionOperator<solverType, gridType, adjointDifferentiation>::Apply(CPa
 			A.Solve(x);
 			break;
 		case ESolverType::CrankNicolson:
-		{
+			A.DotSolve(*B, x);
+			break;
+		default:
+			break;
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Apply(const std::array<PayoffData*, nRhs>& unaliased x,
+		const details::CActiveWindow<typename TridiagonalOperator::Factor>& unaliased window) const noexcept
+{
+	switch (solverType)
+	{
+		case ESolverType::ExplicitEuler:
+			A.Dot(x, window);
+			break;
+		case ESolverType::ImplicitEuler:
+			A.Solve(x, window);
+			break;
+		case ESolverType::CrankNicolson:
+			// not fused: the edge rows need B \cdot x before the forward substitution
+			B->Dot(x, window);
+			A.Solve(x, window);
+			break;
+		default:
+			break;
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Apply(const std::array<PayoffData*, nRhs>& unaliased x,
+		const details::CExerciseCondition<typename TridiagonalOperator::Value, nRhs>& unaliased exercise) const noexcept
+{
+	switch (solverType)
+	{
+		case ESolverType::ExplicitEuler:
+			A.Dot(x);
+			break;
+		case ESolverType::ImplicitEuler:
+			A.Solve(x, exercise);
+			break;
+		case ESolverType::CrankNicolson:
+			A.DotSolve(*B, x, exercise);
+			break;
+		default:
+			break;
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Apply(const std::array<PayoffData*, nRhs>& unaliased x,
+		typename TridiagonalOperator::Value* unaliased buffer) const noexcept
+{
+	if (!A.HasCyclicReduction())
+	{
+		Apply(x);
+		return;
+	}
+
+	switch (solverType)
+	{
+		case ESolverType::ImplicitEuler:
+			A.Solve(x, buffer);
+			break;
+		case ESolverType::CrankNicolson:
 			B->Dot(x);
-			A.Solve(x);
+			A.Solve(x, buffer);
 			break;
-		}
 		default:
+			Apply(x);
 			break;
 	}
 }
 
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Apply(const std::array<PayoffData*, nRhs>& unaliased x, const size_t p,
+		details::CThreadTeam& team, typename TridiagonalOperator::Value* unaliased buffer) const noexcept
+{
+	switch (solverType)
+	{
+		case ESolverType::ExplicitEuler:
+			A.Dot(x, p, team, buffer);
+			break;
+		case ESolverType::ImplicitEuler:
+			A.Solve(x, p, team, buffer);
+			break;
+		case ESolverType::CrankNicolson:
+			// not fused, as over an active window
+			B->Dot(x, p, team, buffer);
+			A.Solve(x, p, team, buffer);
+			break;
+		default:
+			break;
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Factorize(const size_t begin, const size_t end,
+		typename TridiagonalOperator::Factor* unaliased upperFactor, typename TridiagonalOperator::Factor* unaliased inversePivot) const noexcept
+{
+	if (solverType != ESolverType::ExplicitEuler)
+		A.Factorize(begin, end, upperFactor, inversePivot);
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs, typename PostStep>
+void CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Apply(const std::array<PayoffData*, nRhs>& unaliased x, const size_t nSteps, const size_t tileSize,
+		typename TridiagonalOperator::Value* unaliased buffer, PostStep&& postStep) const noexcept
+{
+	if (solverType == ESolverType::ExplicitEuler)
+	{
+		A.Dot(x, nSteps, tileSize, buffer, postStep);
+		return;
+	}
+
+	const auto tile = details::WholeTile<typename TridiagonalOperator::Value>(x);
+	for (size_t step = 0; step < nSteps; ++step)
+	{
+		Apply(x);
+		postStep(tile, step);
+	}
+}
+
 }
@@ -0,0 +1,103 @@
+/*
+ * CEvolutionOperatorCache.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef FINITEDIFFERENCE_CEVOLUTIONOPERATORCACHE_H_
+#define FINITEDIFFERENCE_CEVOLUTIONOPERATORCACHE_H_
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include <stddef.h>
+
+#include <Utilities/CAlignedAllocator.h>
+#include <Flags.h>
+
+namespace fdpricing
+{
+
+/**
+ * Operators over a dt different from the root operator one (i.e. the dividend sub-steps), keyed by dt.
+ * They are built with the pseudo copy constructor, hence they share grid and space discretization with the root operator:
+ * only the dt dependent operators (and their factors) are stored. Regular dividend schedules and repricing hit the same dt's again.
+ *
+ * Operator: CEvolutionOperator or CMatrixFreeEvolutionOperator
+ */
+template<typename Operator>
+class CEvolutionOperatorCache
+{
+public:
+	/**
+	 * capacity: max number of cached operators, at least 1. Once full, the oldest operator is evicted
+	 */
+	explicit CEvolutionOperatorCache(const size_t capacity) noexcept
+		: capacity(std::max<size_t>(capacity, 1)), next(0)
+	{
+		entries.reserve(this->capacity);
+	}
+
+	CEvolutionOperatorCache(const CEvolutionOperatorCache& rhs) = delete;
+	CEvolutionOperatorCache(CEvolutionOperatorCache&& rhs) = default;
+	CEvolutionOperatorCache& operator=(const CEvolutionOperatorCache& rhs) = delete;
+	CEvolutionOperatorCache& operator=(CEvolutionOperatorCache&& rhs) = default;
+
+	/**
+	 * The operator over dt: the reference is valid until the next call, as it may evict it.
+	 *
+	 * The same sub-step comes with a dt that differs by the round-off of the accumulated time steps, so dt is rounded
+	 * to a multiple of 2^-40 (~1e-12, i.e. the pricer resolution on dividend times) and the operator is built on the rounded dt:
+	 * this way the result does not depend on which dt was seen first
+	 */
+	Operator& Get(const Operator& unaliased root, const double dt) noexcept
+	{
+		const double key = ldexp(round(ldexp(dt, 40)), -40);
+		for (auto& entry : entries)
+		{
+			if (entry.first == key)
+				return *entry.second;
+		}
+
+		auto op = details::MakeShared<Operator>(root, key);
+		if (entries.size() < capacity)
+		{
+			entries.emplace_back(key, std::move(op));
+			return *entries.back().second;
+		}
+
+		auto& entry = entries[next];
+		next = (next + 1) % capacity;
+		entry.first = key;
+		entry.second = std::move(op);
+		return *entry.second;
+	}
+
+	size_t size() const noexcept
+	{
+		return entries.size();
+	}
+
+	void Clear() noexcept
+	{
+		entries.clear();
+		next = 0;
+	}
+
+private:
+	size_t capacity;
+
+	/**
+	 * Next entry to be evicted
+	 */
+	size_t next;
+
+	details::AlignedVector<std::pair<double, std::shared_ptr<Operator>>> entries;
+};
+
+} /* namespace fdpricing */
+
+#endif /* FINITEDIFFERENCE_CEVOLUTIONOPERATORCACHE_H_ */
@@ -8,13 +8,25 @@
 #ifndef FINITEDIFFERENCE_CFDPRICER_H_
 #define FINITEDIFFERENCE_CFDPRICER_H_
 
+#include <type_traits>
+#include <memory>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+
 #include <FiniteDifference/CEvolutionOperator.h>
+#include <FiniteDifference/CMatrixFreeEvolutionOperator.h>
+#include <FiniteDifference/CEvolutionOperatorCache.h>
 #include <Data/ECalculationType.h>
 #include <Data/EAdjointDifferentiation.h>
 #include <Data/EExerciseType.h>
+#include <Data/EPrecision.h>
+#include <Data/EOperatorStorage.h>
 #include <Data/CCacheData.h>
 #include <Data/COutputData.h>
 #include <BlackScholes/CBlackScholes.h>
+#include <Utilities/CInstructionSet.h>
 #include <Flags.h>
 
 namespace fdpricing
@@ -27,31 +39,93 @@ struct CPricerSettings
 	CFiniteDifferenceSettings fdSettings = CFiniteDifferenceSettings();
 };
 
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+class CBatchPricer;
+
+/**
+ * fixedN: see CTridiagonalOperator. It has to match input.N: CFixedSizePricer takes care of the run time dispatch
+ * precision: see EPrecision. The outputs are double in any case
+ * operatorStorage: see EOperatorStorage. MatrixFree is worth only for large N, where the assembled operators fall out of cache
+ */
 template <ESolverType solverType=ESolverType::CrankNicolson,
 		EGridType gridType=EGridType::Adaptive,
-		EAdjointDifferentiation adjointDifferentiation=EAdjointDifferentiation::All>
+		EAdjointDifferentiation adjointDifferentiation=EAdjointDifferentiation::All,
+		size_t fixedN=0,
+		EPrecision precision=EPrecision::Double,
+		EOperatorStorage operatorStorage=EOperatorStorage::Assembled>
 class CFDPricer
 {
 public:
+	typedef typename std::conditional<operatorStorage == EOperatorStorage::MatrixFree,
+			CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>,
+			CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>>::type Operator;
+
 	CFDPricer(const CInputData& unaliased input, const CPricerSettings& unaliased settings) noexcept;
 
 	/**
-	 * Do not copy this class: instead one should work out how to update quantities when sigma/T changes
+	 * u: evolution operator built for input and settings.fdSettings, which can be shared with other pricers (e.g. see COperatorRegistry)
+	 */
+	CFDPricer(const CInputData& unaliased input, const CPricerSettings& unaliased settings, const std::shared_ptr<const Operator>& u) noexcept;
+
+	/**
+	 * Do not copy this class: use Reprice for pricing another option instead. Moving is fine, as operators are shared and buffers owned
 	 */
 	CFDPricer(const CFDPricer& rhs) = delete;
-	CFDPricer(const CFDPricer&& rhs) = delete;
+	CFDPricer(CFDPricer&& rhs) = default;
 	CFDPricer& operator=(const CFDPricer& rhs) = delete;
-	CFDPricer& operator=(const CFDPricer&& rhs) = delete;
+	CFDPricer& operator=(CFDPricer&& rhs) = default;
 
 	virtual ~CFDPricer() = default;
 
+	/**
+	 * input and settings have to be alive until this is done
+	 */
 	void Price(COutputData& unaliased callOutput, COutputData& unaliased putOutput) noexcept;
 
+	/**
+	 * Same as above, also recording the early exercise boundaries on the whole time grid (see CExerciseBoundary).
+	 * The boundary of an option that is not calculated (or European, or accelerated by Black-Scholes) is left NaN.
+	 * Temporal blocking is not used meanwhile, as the boundary is recorded after each step
+	 */
+	void Price(COutputData& unaliased callOutput, COutputData& unaliased putOutput, CExerciseBoundary& unaliased callBoundary, CExerciseBoundary& unaliased putBoundary) noexcept;
+
+	/**
+	 * Price another option with the same settings, recycling this pricer:
+	 * 	- payoff and intrinsic value buffers are reused when N is unchanged
+	 * 	- the evolution operator is kept if neither its grid (S, N) nor sigma, b, r and dt changed. Otherwise it's rebuilt on the same grid, if possible
+	 * 	- dividend sub-step operators are kept along with the evolution operator
+	 */
+	void Reprice(const CInputData& unaliased input, COutputData& unaliased callOutput, COutputData& unaliased putOutput) noexcept;
+
+	/**
+	 * Grid points left out by the active windows (see CFiniteDifferenceSettings::activeWindowTolerance), summed over the options and the steps
+	 * of the last pricing: 0 if it's not used
+	 */
+	size_t GetFrozenPoints() const noexcept
+	{
+		return frozenPoints;
+	}
+
 private:
-	const CInputData& unaliased input;
-	const CPricerSettings& unaliased settings;
-	const bool calculateCall;
-	const bool calculatePut;
+	/**
+	 * The batch pricer drives the backward induction of several pricers at once
+	 */
+	template <ESolverType, EGridType, EAdjointDifferentiation, size_t>
+	friend class CBatchPricer;
+
+	/**
+	 * Not owned: pointers rather than references, so that Reprice can change input and the pricer can be moved
+	 */
+	const CInputData* input;
+	const CPricerSettings* settings;
+	bool calculateCall;
+	bool calculatePut;
+
+	/**
+	 * Whether Black-Scholes takes care of the call (put) in absence of early exercise premium
+	 */
+	bool accelerateCall;
+	bool acceleratePut;
 
 	/**
 	 * Loops through the dividends: it's updated once the BI is done
@@ -63,15 +137,101 @@ private:
 	 */
 	details::CCacheData cache;
 
-	CPayoffData callData;
-	CPayoffData putData;
+	typedef CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage> Pricer;
+	typedef typename Operator::PayoffData PayoffData;
+	typedef typename details::CPrecisionTraits<precision>::Value Value;
+	typedef typename details::CPrecisionTraits<precision>::Factor Factor;
+
+	PayoffData callData;
+	PayoffData putData;
 
-	typedef CFDPricer<solverType, gridType, adjointDifferentiation> Pricer;
-	typedef CEvolutionOperator<solverType, gridType, adjointDifferentiation> Operator;
 	/**
-	 * Space-Time Discretization operator
+	 * Call intrinsic value on the grid, S_i - K: the put one is its opposite
 	 */
-	Operator u;
+	details::Storage<Value, fixedN> intrinsicValue;
+
+	/**
+	 * Explicit steps advanced at once by temporal blocking (see CFiniteDifferenceSettings::temporalBlockingSteps): 1 if not blocked
+	 */
+	size_t blockSteps;
+	details::AlignedVector<Value> tileBuffer;
+
+	/**
+	 * Active window [windowBegin, windowEnd) of the grid of each option, call first (see CFiniteDifferenceSettings::activeWindowTolerance):
+	 * the rest is frozen. Each option has its own, as the far field where one is worthless is deep in the money for the other.
+	 * Its edges move by windowStep points at a time
+	 */
+	static constexpr size_t windowStep = 32;
+	bool activeWindow;
+	std::array<size_t, 2> windowBegin;
+	std::array<size_t, 2> windowEnd;
+	size_t frozenPoints;
+
+	/**
+	 * Values of the windowStep points at each edge of the windows before the step, for detecting the frozen ones
+	 */
+	details::AlignedVector<Value> windowEdges;
+
+	/**
+	 * Thomas factors of the implicit operator over [factorizedBegin, factorizedEnd) of each option: upper factors first, then the inverse pivots
+	 */
+	details::AlignedVector<Factor> windowFactors;
+	std::array<size_t, 2> factorizedBegin;
+	std::array<size_t, 2> factorizedEnd;
+
+	/**
+	 * Team running the partitioned steps (see CFiniteDifferenceSettings::parallelSolveMinN), one thread per partition: null if they are not used.
+	 * The buffer is shared by the team, and the exercised points are counted per partition and option
+	 */
+	std::unique_ptr<details::CThreadTeam> team;
+	details::AlignedVector<Value> partitionBuffer;
+	details::AlignedVector<size_t> partitionExercised;
+
+	/**
+	 * Whether the implicit solves use the hybrid cyclic reduction (see CFiniteDifferenceSettings::cyclicReductionMaxN), and its scratch memory
+	 */
+	bool cyclicReduction;
+	details::AlignedVector<Value> reductionBuffer;
+
+	/**
+	 * Tracked exercise region (see CFiniteDifferenceSettings::trackExerciseRegion): [0, edge) for the put, [edge, N) for the call.
+	 * It's valid only if the last projection found it contiguous and attached to the grid boundary
+	 */
+	struct CExerciseRegion
+	{
+		size_t edge = 0;
+		bool valid = false;
+	};
+	bool trackExerciseRegion;
+	CExerciseRegion callRegion;
+	CExerciseRegion putRegion;
+
+	/**
+	 * Whether the call (put) is exercised by the implicit solves (see CFiniteDifferenceSettings::brennanSchwartz)
+	 */
+	bool brennanSchwartzCall;
+	bool brennanSchwartzPut;
+
+	/**
+	 * Points on each side of the edge that are compared against the intrinsic value, when the region is tracked
+	 */
+	static constexpr size_t exerciseNeighbourhood = 16;
+
+	/**
+	 * Where Price records the exercise boundaries, if requested: not owned
+	 */
+	CExerciseBoundary* callBoundary = nullptr;
+	CExerciseBoundary* putBoundary = nullptr;
+
+	/**
+	 * Space-Time Discretization operator: it's immutable, hence it can be shared. Reprice replaces it if needed
+	 */
+	std::shared_ptr<const Operator> u;
+
+	/**
+	 * Operators over the dividend sub-steps
+	 */
+	CEvolutionOperatorCache<Operator> dividendOperators;
 
 	/**
 	 * This defines a vector of 6 elements:
@@ -101,40 +261,28 @@ private:
 	typedef std::array<double, 6> TimeLeaves;
 
 	/**
-	 * These delegates are function pointers that point to the correct templated version. Defined ad initialization and from UpdateDelegates
+	 * Set up the state that Price consumes: dividend index, buffers and acceleration
 	 */
-	typedef void (Pricer::*InitializerDelegate)();
-	InitializerDelegate exerciseDelegate;
-	InitializerDelegate smoothingDelegate;
-
-	typedef void (Pricer::*AccelerationDelegate)(size_t& unaliased m,
-			COutputData& unaliased callOutput, COutputData& unaliased putOutput, TimeLeaves& unaliased callLeavesDt, TimeLeaves& unaliased putLeavesDt);
-	AccelerationDelegate accelerationDelegate;
-
-	typedef void (Pricer::*RollBackDelegate)(const double dt, const double df);
-	RollBackDelegate discountDelegate;
-
-	typedef void (Pricer::*JumpConditionDelegate)(const double shift);
-	JumpConditionDelegate jumpConditionDelegate;
-
-	typedef void (Pricer::*RefinedSmoothingDelegate)(const double previousTime, const double currentTime, const CDividend& unaliased dividend);
-	RefinedSmoothingDelegate refinedSmoothingDelegate;
-
-	typedef void (Pricer::*ApplyOperatorDelegate)(Operator& unaliased u);
-	ApplyOperatorDelegate applyOperatorDelegate;
-
-	typedef void (Pricer::*SetOutputDelegate)(COutputData& unaliased callOutput, COutputData& unaliased putOutput) const;
-	SetOutputDelegate setOutputDelegate;
+	void Initialise() noexcept;
 
-	typedef void (Pricer::*ComputeGreeksDelegate)(COutputData& unaliased callOutput, COutputData& unaliased putOutput, const TimeLeaves& unaliased callLeavesDt, const TimeLeaves& unaliased putLeavesDt) const;
-	ComputeGreeksDelegate computeGreeksDelegate;
+	/**
+	 * Calculation and exercise type are template parameters of the backward induction, so that it's statically dispatched:
+	 * Dispatch switches on the settings once, calling worker(calculationType, exerciseType) with the matching std::integral_constant's
+	 */
+	template<typename Worker>
+	void Dispatch(Worker&& worker) noexcept;
+	template<EExerciseType exerciseType, typename Worker>
+	void DispatchCalculationType(Worker& unaliased worker) noexcept;
 
-	void UpdateDelegates(const CPricerSettings& unaliased settings, const bool accelerateCall, const bool acceleratePut) noexcept;
+	template<ECalculationType calculationType, EExerciseType exerciseType>
+	void PriceWorker(COutputData& unaliased callOutput, COutputData& unaliased putOutput) noexcept;
 
 	/**
 	 * Define the initial condition
 	 */
+	template<ECalculationType calculationType, EExerciseType exerciseType>
 	void PayoffInitialise(size_t& unaliased m) noexcept;
+	template<ECalculationType calculationType, EExerciseType exerciseType>
 	void RefinedPayoffInitialise(size_t& unaliased m) noexcept;
 
 	/**
@@ -146,34 +294,119 @@ private:
 	/**
 	 * Advance backward in time applying the evolution operator
 	 */
-	template<ECalculationType calculationType>
-	void ApplyOperator(Operator& unaliased u);
+	template<ECalculationType calculationType, EExerciseType exerciseType>
+	void ApplyOperator(const Operator& unaliased u);
 
 	/**
-	 * Accelerate the relevant option using Black-Scholes and synchronize the other one at the same time grid point
+	 * Accelerate the acceleratedType option using Black-Scholes and synchronize the other one at the same time grid point
 	 */
-	template<ECalculationType calculationType>
-	void Accelerate(size_t& unaliased m, COutputData& unaliased callOutput, COutputData& unaliased putOutput, TimeLeaves& unaliased callLeavesDt, TimeLeaves& unaliased putLeavesDt);
+	template<ECalculationType acceleratedType, ECalculationType calculationType, EExerciseType exerciseType>
+	void Accelerate(size_t& unaliased m, COutputData& unaliased callOutput, COutputData& unaliased putOutput, TimeLeaves& unaliased callLeavesDt, TimeLeaves& unaliased putLeavesDt) noexcept;
 
 	/**
 	 * Main Backward Induction routine that advance (backwards) from end to start
 	 */
+	template<ECalculationType calculationType, EExerciseType exerciseType>
 	void PriceUntil(size_t start, const size_t end, TimeLeaves& unaliased callLeavesDt, TimeLeaves& unaliased putLeavesDt) noexcept;
 
 	template<ECalculationType calculationType>
 	void PayoffSmoothing();
-	template<ECalculationType calculationType>
+	template<ECalculationType calculationType, EExerciseType exerciseType>
 	void RefinedPayoffSmoothing(const double previousTime, const double currentTime, const CDividend& unaliased dividend) noexcept;
-	template<ECalculationType calculationType>
-	void SmoothingWorker(const size_t i, CBlackScholes& unaliased bs, const double dt) noexcept;
 
 	/**
-	 * Apply discount factor
+	 * Where the grid-wide smoothing writes to, from the offset-th point on (see CBlackScholes::Smooth): greeks which aren't allocated are nullptr
 	 */
-	template<ECalculationType calculationType>
-	void RollBack(const double dt, const double df);
+	static details::CSmoothingOutput<Value> SmoothingOutput(PayoffData& unaliased data, const size_t offset = 0) noexcept
+	{
+		auto at = [offset](auto& unaliased x) { return x.size() > offset ? x.data() + offset : nullptr; };
+		return { at(data.payoff_i), at(data.vega_i), at(data.rho_i), at(data.rhoBorrow_i) };
+	}
+
+	/**
+	 * Single pass after each time step: rho accumulation and, if American, the early exercise projection.
+	 * The discount factor is already folded into the evolution operator
+	 */
+	template<ECalculationType calculationType, EExerciseType exerciseType>
+	void PostStep(const double dt) noexcept;
+	template<bool rollBack, bool exercise>
+	void PostStepWorker(PayoffData& unaliased data, const double sign, const double dt) noexcept;
+
+	/**
+	 * Same as above over n points, returning how many of them have been exercised.
+	 * projected: the payoff has been exercised by the solve already (Brennan-Schwartz), so the points holding their exercise value count as exercised
+	 */
+	template<bool rollBack, bool exercise, bool projected = false>
+	size_t PostStepWorker(Value* unaliased payoff, Value* unaliased vega, Value* unaliased rho, const Value* unaliased intrinsic, const size_t n, const double sign, const double dt) noexcept;
 
+	/**
+	 * Early exercise projection of data, restricted to the neighbourhood of the edge of the exercise region when that's tracked.
+	 * It returns how many points have been exercised
+	 */
+	size_t ProjectExercise(PayoffData& unaliased data, const double sign) noexcept;
+
+	/**
+	 * Projection over the whole grid, which finds the exercise region as well
+	 */
+	size_t ProjectExercise(PayoffData& unaliased data, const double sign, CExerciseRegion& unaliased region) noexcept;
+
+	/**
+	 * The exercise regions have to be found again, e.g. after the jump condition or a step that did not track them
+	 */
+	void ResetExerciseRegions() noexcept
+	{
+		callRegion.valid = putRegion.valid = false;
+	}
+
+	/**
+	 * Save the exercise boundaries at time m * dt, if requested
+	 */
+	template<ECalculationType calculationType, EExerciseType exerciseType>
+	void RecordExerciseBoundary(const size_t m) noexcept;
+	double ExerciseBoundary(const PayoffData& unaliased data, const double sign) const noexcept;
+
+	template<ECalculationType calculationType, EExerciseType exerciseType>
 	void BackwardInduction() noexcept;
+
+	/**
+	 * nSteps steps at once, with temporal blocking if nSteps > 1: see BlockSize
+	 */
+	template<ECalculationType calculationType, EExerciseType exerciseType>
+	void BackwardInduction(const size_t nSteps) noexcept;
+	template<EExerciseType exerciseType, size_t nRhs>
+	void BlockedBackwardInduction(const std::array<PayoffData*, nRhs>& unaliased x, const std::array<double, nRhs>& unaliased signs, const size_t nSteps) noexcept;
+
+	/**
+	 * Single step over the active window of each option, which is then updated
+	 */
+	template<ECalculationType calculationType, EExerciseType exerciseType>
+	void WindowedBackwardInduction() noexcept;
+	template<EExerciseType exerciseType, size_t nRhs>
+	void WindowedBackwardInduction(const std::array<PayoffData*, nRhs>& unaliased x, const std::array<double, nRhs>& unaliased signs,
+			const std::array<size_t, nRhs>& unaliased options) noexcept;
+
+	/**
+	 * Single step, each partition of the grid being updated by its own thread of the team
+	 */
+	template<ECalculationType calculationType, EExerciseType exerciseType>
+	void PartitionedBackwardInduction() noexcept;
+	template<EExerciseType exerciseType, size_t nRhs>
+	void PartitionedBackwardInduction(const std::array<PayoffData*, nRhs>& unaliased x, const std::array<double, nRhs>& unaliased signs) noexcept;
+
+	/**
+	 * The whole grid is active again, e.g. after a dividend has shifted it
+	 */
+	void ResetWindow() noexcept
+	{
+		windowBegin.fill(0);
+		windowEnd.fill(input->N);
+	}
+
+	/**
+	 * Steps that can be blocked from step m down: the block ends at end, and on the first step whose leaves are saved
+	 */
+	size_t BlockSize(const size_t m, const size_t end) const noexcept;
+	template<ECalculationType calculationType, EExerciseType exerciseType>
 	void RefinedBackwardInduction(const double previousTime, const double currentTime, const CDividend& unaliased dividend) noexcept;
 
 	/**
@@ -181,6 +414,8 @@ private:
 	 */
 	template<ECalculationType calculationType>
 	void ApplyJumpCondition(const double shift) noexcept;
+	template<size_t nRhs>
+	void ApplyJumpCondition(const std::array<PayoffData*, nRhs>& unaliased x, const details::CJumpTable& unaliased table) noexcept;
 
 	template <ECalculationType>
 	void SetOutput(COutputData& unaliased callOutput, COutputData& unaliased putOutput) const;
@@ -10,416 +10,805 @@
 namespace fdpricing
 {
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-CFDPricer<solverType, gridType, adjointDifferentiation>::CFDPricer(const CInputData& unaliased input,
+// std::min takes them by reference
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+constexpr size_t CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::windowStep;
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+constexpr size_t CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::exerciseNeighbourhood;
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::CFDPricer(const CInputData& unaliased input,
 															const CPricerSettings& unaliased settings) noexcept
-		: input(input), settings(settings),
+		: CFDPricer(input, settings, details::MakeShared<const Operator>(input, settings.fdSettings))
+{
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::CFDPricer(const CInputData& unaliased input,
+															const CPricerSettings& unaliased settings,
+															const std::shared_ptr<const Operator>& u) noexcept
+		: input(&input), settings(&settings),
 		  calculateCall(settings.calculationType == ECalculationType::All || settings.calculationType == ECalculationType::CallOnly),
 		  calculatePut(settings.calculationType == ECalculationType::All || settings.calculationType == ECalculationType::PutOnly),
-		  divIdx(input.dividends.size() - 1),
-		  u(input, settings.fdSettings)
+		  divIdx(0),
+		  u(u),
+		  dividendOperators(settings.fdSettings.maxCachedOperators)
+{
+	Initialise();
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::Reprice(const CInputData& unaliased input,
+		COutputData& unaliased callOutput, COutputData& unaliased putOutput) noexcept
+{
+	this->input = &input;
+
+	const auto& grid = u->GetGrid();
+	const bool sameGrid = grid.size() == input.N && grid.x0 == input.S
+			&& grid.lb == settings->fdSettings.lowerFactor * input.S && grid.ub == settings->fdSettings.upperFactor * input.S;
+	if (!sameGrid)
+	{
+		u = details::MakeShared<const Operator>(input, settings->fdSettings);
+		dividendOperators.Clear();
+	}
+	else if (!u->IsBuiltFor(input))
+	{
+		u = details::MakeShared<const Operator>(input, *u, settings->fdSettings);
+		dividendOperators.Clear();
+	}
+
+	Initialise();
+	Price(callOutput, putOutput);
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::Initialise() noexcept
 {
-	cache.discountFactor = exp(-input.r * u.GetDt());
+	divIdx = input->dividends.size() - 1;
+	cache.discountFactor = u->GetDiscountFactor();
+
+	const auto& grid = u->GetGrid();
+	intrinsicValue.resize(input->N);
+	for (size_t i = 0; i < input->N; ++i)
+		intrinsicValue[i] = grid.Get(i) - input->K;
 
 	if (calculateCall)
-		callData.Init<adjointDifferentiation>(input.N);
+		callData.template Init<adjointDifferentiation>(input->N);
 
 	if (calculatePut)
-		putData.Init<adjointDifferentiation>(input.N);
+		putData.template Init<adjointDifferentiation>(input->N);
+
+	accelerateCall = calculateCall && input->acceleration && (input->b > 0.0 && input->r > 0.0);
+	acceleratePut = calculatePut && input->acceleration && !accelerateCall;
 
-	const bool accelerateCall = calculateCall && input.acceleration && (input.b > 0.0 && input.r > 0.0);
-	const bool acceleratePut = calculatePut && input.acceleration && !accelerateCall;
-	UpdateDelegates(settings, accelerateCall, acceleratePut);
+	// the team is kept as long as the partitions do not change
+	const auto& fdSettings = settings->fdSettings;
+	const size_t partitions = u->GetPartitions();
+	if (partitions > 1)
+	{
+		if (!team || team->size() != partitions)
+			team.reset(new details::CThreadTeam(partitions));
+		partitionBuffer.resize(CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::template PartitionBufferSize<2>(partitions));
+		partitionExercised.resize(2 * partitions);
+	}
+	else
+		team.reset();
+
+	cyclicReduction = u->HasCyclicReduction();
+	if (cyclicReduction)
+		reductionBuffer.resize(CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::template ReductionBufferSize<2>(input->N));
+
+	// the exercise flags of a block are bits of a 64 bit mask
+	blockSteps = 1;
+	if (solverType == ESolverType::ExplicitEuler && operatorStorage == EOperatorStorage::Assembled && input->N >= fdSettings.temporalBlockingMinN && !team)
+		blockSteps = std::min<size_t>(std::max<size_t>(fdSettings.temporalBlockingSteps, 1), 64);
+
+	if (blockSteps > 1)
+		tileBuffer.resize(CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::template TileBufferSize<2>(blockSteps, fdSettings.temporalBlockingTileSize));
+
+	// the call exercise region is always attached to the upper boundary, the put one to the lower boundary only without cash dividends
+	const bool brennanSchwartz = settings->exerciseType == EExerciseType::American && u->HasBrennanSchwartz();
+	brennanSchwartzCall = brennanSchwartz;
+	brennanSchwartzPut = brennanSchwartz && input->dividends.empty();
+
+	// the window always keeps a band on each side of the points used by the greeks, see WindowedBackwardInduction.
+	// Its steps are projected, so it's not used with the exercise in the solves
+	activeWindow = fdSettings.activeWindowTolerance > 0.0 && operatorStorage == EOperatorStorage::Assembled && blockSteps == 1 && !team
+			&& !brennanSchwartz && input->N >= 4 * windowStep + 8;
+	ResetWindow();
+	frozenPoints = 0;
+
+	trackExerciseRegion = fdSettings.trackExerciseRegion && input->dividends.empty();
+	ResetExerciseRegions();
+	factorizedBegin.fill(0);
+	factorizedEnd.fill(0);
+	if (activeWindow)
+	{
+		// up to 4 vectors per option, 2 edges each
+		windowEdges.resize(2 * 4 * 2 * windowStep);
+		if (solverType != ESolverType::ExplicitEuler)
+			windowFactors.resize(2 * 2 * details::Padded<Factor>(input->N));
+	}
 }
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::UpdateDelegates(const CPricerSettings& unaliased settings, const bool accelerateCall, const bool acceleratePut) noexcept
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<ECalculationType calculationType, EExerciseType exerciseType>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::ApplyOperator(const Operator& unaliased u)
 {
-	switch (settings.calculationType)
+	// Brennan-Schwartz: the solve exercises the options, an unconstrained one (zero sign) is left to PostStep
+	const bool brennanSchwartz = exerciseType == EExerciseType::American && (brennanSchwartzCall || brennanSchwartzPut);
+	const double callSign = brennanSchwartzCall ? 1.0 : 0.0;
+	const double putSign = brennanSchwartzPut ? -1.0 : 0.0;
+
+	// call and put share the same operator: apply it to both in one go
+	switch (calculationType)
 	{
 		case ECalculationType::All:
-			exerciseDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::Exercise<ECalculationType::All>;
-			smoothingDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::PayoffSmoothing<ECalculationType::All>;
-			discountDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::RollBack<ECalculationType::All>;
-			jumpConditionDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::ApplyJumpCondition<ECalculationType::All>;
-			refinedSmoothingDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::RefinedPayoffSmoothing<ECalculationType::All>;
-			applyOperatorDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::ApplyOperator<ECalculationType::All>;
-			setOutputDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::SetOutput<ECalculationType::All>;
-			computeGreeksDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::ComputeGreeks<ECalculationType::All>;
+			if (brennanSchwartz)
+				u.Apply(std::array<PayoffData*, 2> { { &callData, &putData } }, details::CExerciseCondition<Value, 2> { intrinsicValue.data(), { { callSign, putSign } } });
+			else if (cyclicReduction)
+				u.Apply(std::array<PayoffData*, 2> { { &callData, &putData } }, reductionBuffer.data());
+			else
+				u.Apply(std::array<PayoffData*, 2> { { &callData, &putData } });
 			break;
 		case ECalculationType::CallOnly:
-			exerciseDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::Exercise<ECalculationType::CallOnly>;
-			smoothingDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::PayoffSmoothing<ECalculationType::CallOnly>;
-			discountDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::RollBack<ECalculationType::CallOnly>;
-			jumpConditionDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::ApplyJumpCondition<ECalculationType::CallOnly>;
-			refinedSmoothingDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::RefinedPayoffSmoothing<ECalculationType::CallOnly>;
-			applyOperatorDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::ApplyOperator<ECalculationType::CallOnly>;
-			setOutputDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::SetOutput<ECalculationType::CallOnly>;
-			computeGreeksDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::ComputeGreeks<ECalculationType::CallOnly>;
+			if (brennanSchwartz)
+				u.Apply(std::array<PayoffData*, 1> { { &callData } }, details::CExerciseCondition<Value, 1> { intrinsicValue.data(), { { callSign } } });
+			else if (cyclicReduction)
+				u.Apply(std::array<PayoffData*, 1> { { &callData } }, reductionBuffer.data());
+			else
+				u.Apply(callData);
 			break;
 		case ECalculationType::PutOnly:
-			exerciseDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::Exercise<ECalculationType::PutOnly>;
-			smoothingDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::PayoffSmoothing<ECalculationType::PutOnly>;
-			discountDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::RollBack<ECalculationType::PutOnly>;
-			jumpConditionDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::ApplyJumpCondition<ECalculationType::PutOnly>;
-			refinedSmoothingDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::RefinedPayoffSmoothing<ECalculationType::PutOnly>;
-			applyOperatorDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::ApplyOperator<ECalculationType::PutOnly>;
-			setOutputDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::SetOutput<ECalculationType::PutOnly>;
-			computeGreeksDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::ComputeGreeks<ECalculationType::PutOnly>;
-			break;
-		case ECalculationType::Null:
-			exerciseDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::Exercise<ECalculationType::Null>;
-			smoothingDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::PayoffSmoothing<ECalculationType::Null>;
-			discountDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::RollBack<ECalculationType::Null>;
-			jumpConditionDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::ApplyJumpCondition<ECalculationType::Null>;
-			refinedSmoothingDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::RefinedPayoffSmoothing<ECalculationType::Null>;
-			applyOperatorDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::ApplyOperator<ECalculationType::Null>;
-			applyOperatorDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::ApplyOperator<ECalculationType::Null>;
-			setOutputDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::SetOutput<ECalculationType::Null>;
-			computeGreeksDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::ComputeGreeks<ECalculationType::Null>;
+			if (brennanSchwartz)
+				u.Apply(std::array<PayoffData*, 1> { { &putData } }, details::CExerciseCondition<Value, 1> { intrinsicValue.data(), { { putSign } } });
+			else if (cyclicReduction)
+				u.Apply(std::array<PayoffData*, 1> { { &putData } }, reductionBuffer.data());
+			else
+				u.Apply(putData);
 			break;
 		default:
-			printf("WRONG SETTINGS");
-			return;
+			break;
 	}
-
-	if (accelerateCall)
-		accelerationDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::Accelerate<ECalculationType::CallOnly>;
-	else if (acceleratePut)
-		accelerationDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::Accelerate<ECalculationType::PutOnly>;
-	else
-		// default is not accelerate
-		accelerationDelegate = &CFDPricer<solverType, gridType, adjointDifferentiation>::Accelerate<ECalculationType::Null>;
 }
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
 template<ECalculationType calculationType>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::ApplyOperator(Operator& unaliased u)
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::Exercise()
 {
-	if (calculationType == ECalculationType::CallOnly || calculationType == ECalculationType::All)
-		u.Apply(callData);
-	if (calculationType == ECalculationType::PutOnly || calculationType == ECalculationType::All)
-		u.Apply(putData);
-}
+	ResetExerciseRegions();
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-template<ECalculationType calculationType>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::Exercise()
-{
-	const auto& grid = u.GetGrid();
-
-	for (size_t i = 0; i < input.N; ++i)
+	switch (calculationType)
 	{
-		const double intrinsicValue = grid.Get(i) - input.K;
-		switch (calculationType)
-		{
-			case ECalculationType::All:
-				if (intrinsicValue > callData.payoff_i[i])
-				{
-					callData.payoff_i[i] = intrinsicValue;
-					callData.ZeroGreeks<adjointDifferentiation>(i);
-				}
-				if (-intrinsicValue > putData.payoff_i[i])
-				{
-					putData.payoff_i[i] = -intrinsicValue;
-					putData.ZeroGreeks<adjointDifferentiation>(i);
-				}
-				break;
-			case ECalculationType::CallOnly:
-				if (intrinsicValue > callData.payoff_i[i])
-				{
-					callData.payoff_i[i] = intrinsicValue;
-					callData.ZeroGreeks<adjointDifferentiation>(i);
-				}
-				break;
-			case ECalculationType::PutOnly:
-				if (-intrinsicValue > putData.payoff_i[i])
-				{
-					putData.payoff_i[i] = -intrinsicValue;
-					putData.ZeroGreeks<adjointDifferentiation>(i);
-				}
-				break;
-			default:
-				break;
-		}
+		case ECalculationType::All:
+			PostStepWorker<false, true>(callData, 1.0, 0.0);
+			PostStepWorker<false, true>(putData, -1.0, 0.0);
+			break;
+		case ECalculationType::CallOnly:
+			PostStepWorker<false, true>(callData, 1.0, 0.0);
+			break;
+		case ECalculationType::PutOnly:
+			PostStepWorker<false, true>(putData, -1.0, 0.0);
+			break;
+		default:
+			break;
 	}
 }
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
 template<ECalculationType calculationType>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::PayoffSmoothing()
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::PayoffSmoothing()
 {
-	const auto& grid = u.GetGrid();
+	const auto& grid = u->GetGrid();
 
-	cache.T = u.GetDt();
+	cache.T = u->GetDt();
 	cache.sqrtDt = sqrt(cache.T);
-	cache.sigmaSqrtDt = input.sigma * cache.sqrtDt;
-	cache.growthFactor   = exp( input.b * u.GetDt());
+	cache.sigmaSqrtDt = input->sigma * cache.sqrtDt;
+	cache.growthFactor   = exp( input->b * u->GetDt());
 	cache.growthFactorTimesDiscountFactor = cache.discountFactor * cache.growthFactor;
-	CBlackScholes bs(input, cache);
-
-	for (size_t i = 0; i < input.N; ++i)
-	{
-		bs.Update(grid.Get(i));
 
-		SmoothingWorker<calculationType>(i, bs, u.GetDt());
-	}
+	CBlackScholes::Smooth<calculationType, adjointDifferentiation>(*input, cache, &grid.Get(0), input->N, 0.0, SmoothingOutput(callData), SmoothingOutput(putData));
 }
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-template<ECalculationType calculationType>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::RefinedPayoffSmoothing(const double previousTime, const double currentTime, const CDividend& unaliased dividend) noexcept
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<ECalculationType calculationType, EExerciseType exerciseType>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::RefinedPayoffSmoothing(const double previousTime, const double currentTime, const CDividend& unaliased dividend) noexcept
 {
 	const double dtAfter  = currentTime - dividend.time;
 	const double dtBefore = dividend.time - previousTime;
 
-	const double dfAfter = exp(-input.r * dtAfter);
-	const double dfBefore = exp(-input.r * dtBefore); // TODO: maybe to division?
+	const double dfAfter = exp(-input->r * dtAfter);
 
 	const double currentDf = cache.discountFactor;
 
-	const auto& grid = u.GetGrid();
+	const auto& grid = u->GetGrid();
 
 	cache.T = dtAfter;
 	cache.discountFactor = dfAfter;
 	cache.sqrtDt = sqrt(cache.T);
-	cache.sigmaSqrtDt = input.sigma * cache.sqrtDt;
-	cache.growthFactor   = exp( input.b * dtAfter);
+	cache.sigmaSqrtDt = input->sigma * cache.sqrtDt;
+	cache.growthFactor   = exp( input->b * dtAfter);
 	cache.growthFactorTimesDiscountFactor = cache.discountFactor * cache.growthFactor;
-	CBlackScholes bs(input, cache);
 
-	for (size_t i = 0; i < input.N; ++i)
-	{
-		double shiftedValue = grid.Get(i) - dividend.dividend;
-		if (shiftedValue <= 0.0)
-			shiftedValue = 1e-7; // TODO: start from last and stop once reaching 0
-
-		bs.Update(shiftedValue);
-
-		SmoothingWorker<calculationType>(i, bs, dtAfter);
-	}
+	// not positive shifted values are floored by the kernel
+	CBlackScholes::Smooth<calculationType, adjointDifferentiation>(*input, cache, &grid.Get(0), input->N, dividend.dividend, SmoothingOutput(callData), SmoothingOutput(putData));
 
 	cache.discountFactor = currentDf;
-	if (settings.exerciseType == EExerciseType::American)
-		(this->*exerciseDelegate)();
+	if (exerciseType == EExerciseType::American)
+		Exercise<calculationType>();
 
 	// it means that dividend falls exactly on a time grid point
 	if (fabs(dtBefore) <= 1e-12)
 		return;
 
-	Operator uBefore(u, dtBefore);
-
-	(this->*applyOperatorDelegate)(uBefore);
-
-	(this->*discountDelegate)(dtBefore, dfBefore);
-	if (settings.exerciseType == EExerciseType::American)
-		(this->*exerciseDelegate)();
+	ApplyOperator<calculationType, exerciseType>(dividendOperators.Get(*u, dtBefore));
+	PostStep<calculationType, exerciseType>(dtBefore);
 }
 
-
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-template<ECalculationType calculationType>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::SmoothingWorker(const size_t i, CBlackScholes& unaliased bs, const double dt) noexcept
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<ECalculationType calculationType, EExerciseType exerciseType>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::PostStep(const double dt) noexcept
 {
+	constexpr bool american = exerciseType == EExerciseType::American;
 	switch (calculationType)
 	{
 		case ECalculationType::All:
-			#if(1) // ******* All *******
-
-			callData.payoff_i[i] = bs.Value<EOptionType::Call>();
-			putData.payoff_i[i] = bs.Value<EOptionType::Put>();
-
-			switch (adjointDifferentiation)
+			if (american)
+			{
+				PostStepWorker<true, true>(callData, 1.0, dt);
+				PostStepWorker<true, true>(putData, -1.0, dt);
+			}
+			else
 			{
-				case EAdjointDifferentiation::All:
-					callData.vega_i[i] = putData.vega_i[i] = bs.Vega();
-
-					callData.rho_i[i] = - dt * callData.payoff_i[i];
-					putData.rho_i[i] = - dt * putData.payoff_i[i];
-					callData.rhoBorrow_i[i] = bs.RhoBorrow<EOptionType::Call>();
-					putData.rhoBorrow_i[i] = bs.RhoBorrow<EOptionType::Put>();
-					break;
-				case EAdjointDifferentiation::Vega:
-					callData.vega_i[i] = putData.vega_i[i] = bs.Vega();
-					break;
-				case EAdjointDifferentiation::Rho:
-					callData.rho_i[i] = - dt * callData.payoff_i[i];
-					putData.rho_i[i] = - dt * putData.payoff_i[i];
-					callData.rhoBorrow_i[i] = bs.RhoBorrow<EOptionType::Call>();
-					putData.rhoBorrow_i[i] = bs.RhoBorrow<EOptionType::Put>();
-					break;
-				default:
-					break;
+				PostStepWorker<true, false>(callData, 1.0, dt);
+				PostStepWorker<true, false>(putData, -1.0, dt);
 			}
+			break;
+		case ECalculationType::CallOnly:
+			if (american)
+				PostStepWorker<true, true>(callData, 1.0, dt);
+			else
+				PostStepWorker<true, false>(callData, 1.0, dt);
+			break;
+		case ECalculationType::PutOnly:
+			if (american)
+				PostStepWorker<true, true>(putData, -1.0, dt);
+			else
+				PostStepWorker<true, false>(putData, -1.0, dt);
+			break;
+		default:
+			break;
+	}
+}
 
-			#endif
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<bool rollBack, bool exercise>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::PostStepWorker(PayoffData& unaliased data, const double sign, const double dt) noexcept
+{
+	constexpr bool hasRho = adjointDifferentiation == EAdjointDifferentiation::Rho || adjointDifferentiation == EAdjointDifferentiation::All;
 
-			break;
+	// European without rho: the discounting has been done by the evolution operator already
+	if (!exercise && !(rollBack && hasRho))
+		return;
 
-		case ECalculationType::CallOnly:
-			#if(1) // ****** Call *******
+	size_t nExercised = 0;
+	if (exercise && (sign > 0.0 ? brennanSchwartzCall : brennanSchwartzPut))
+		nExercised = PostStepWorker<rollBack, exercise, true>(data.payoff_i.data(), data.vega_i.data(), data.rho_i.data(), intrinsicValue.data(), fixedN ? fixedN : input->N, sign, dt);
+	else if (exercise && trackExerciseRegion)
+	{
+		// rho is rolled back with the continuation value, i.e. before the projection
+		if (rollBack && hasRho)
+			PostStepWorker<true, false>(data.payoff_i.data(), nullptr, data.rho_i.data(), intrinsicValue.data(), fixedN ? fixedN : input->N, sign, dt);
+		nExercised = ProjectExercise(data, sign);
+	}
+	else
+		nExercised = PostStepWorker<rollBack, exercise>(data.payoff_i.data(), data.vega_i.data(), data.rho_i.data(), intrinsicValue.data(), fixedN ? fixedN : input->N, sign, dt);
+
+	// same convention as CPayoffData::ZeroGreeks
+	if (exercise && hasRho && nExercised > 0)
+	{
+		data.rho_i[0] = 0.0;
+		data.rhoBorrow_i[0] = 0.0;
+	}
+}
 
-			callData.payoff_i[i] = bs.Value<EOptionType::Call>();
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<bool rollBack, bool exercise, bool projected>
+size_t CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::PostStepWorker(Value* unaliased payoff, Value* unaliased vega, Value* unaliased rho,
+		const Value* unaliased intrinsic, const size_t n, const double sign, const double dt) noexcept
+{
+	constexpr bool hasVega = adjointDifferentiation == EAdjointDifferentiation::Vega || adjointDifferentiation == EAdjointDifferentiation::All;
+	constexpr bool hasRho = adjointDifferentiation == EAdjointDifferentiation::Rho || adjointDifferentiation == EAdjointDifferentiation::All;
 
-			switch (adjointDifferentiation)
+	// branch-free, so that the compiler can vectorize it with masked blends, as wide as the instruction set allows
+	size_t nExercised = 0;
+	details::CInstructionSet::Dispatch([&](auto)
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			const Value continuationValue = payoff[i];
+			if (rollBack && hasRho)
+				rho[i] = -dt * continuationValue + rho[i];
+
+			if (exercise)
 			{
-				case EAdjointDifferentiation::All:
-					callData.vega_i[i] = bs.Vega();
-
-					callData.rho_i[i] = - dt * callData.payoff_i[i];
-					callData.rhoBorrow_i[i] = bs.RhoBorrow<EOptionType::Call>();
-					break;
-				case EAdjointDifferentiation::Vega:
-					callData.vega_i[i] = bs.Vega();
-					break;
-				case EAdjointDifferentiation::Rho:
-					callData.rho_i[i] = - dt * callData.payoff_i[i];
-					callData.rhoBorrow_i[i] = bs.RhoBorrow<EOptionType::Call>();
-					break;
-				default:
-					break;
+				const Value exerciseValue = sign * intrinsic[i];
+				const bool exercised = projected ? exerciseValue >= continuationValue : exerciseValue > continuationValue;
+				payoff[i] = exercised ? exerciseValue : continuationValue;
+				if (hasVega)
+					vega[i] = exercised ? Value(0.0) : vega[i];
+				nExercised += exercised;
 			}
+		}
+	});
+
+	return nExercised;
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+size_t CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::ProjectExercise(PayoffData& unaliased data, const double sign) noexcept
+{
+	constexpr bool hasVega = adjointDifferentiation == EAdjointDifferentiation::Vega || adjointDifferentiation == EAdjointDifferentiation::All;
+
+	const bool lower = sign < 0.0;
+	CExerciseRegion& unaliased region = lower ? putRegion : callRegion;
+	if (!region.valid)
+		return ProjectExercise(data, sign, region);
+
+	const size_t n = fixedN ? fixedN : input->N;
+	Value* unaliased payoff = data.payoff_i.data();
+	Value* unaliased vega = hasVega ? data.vega_i.data() : nullptr;
+	const Value* unaliased intrinsic = intrinsicValue.data();
+	auto exercised = [&](const size_t i) { return Value(sign * intrinsic[i]) > payoff[i]; };
+
+	// Before touching anything: the exercised points of the neighbourhood have to be contiguous,
+	// joined to the rest of the region, which is still attached to the grid boundary
+	const size_t lo = region.edge - std::min(region.edge, exerciseNeighbourhood);
+	const size_t hi = std::min(region.edge + exerciseNeighbourhood, n);
+	size_t first = hi, last = lo, nExercised = 0;
+	for (size_t i = lo; i < hi; ++i)
+	{
+		if (exercised(i))
+		{
+			first = std::min(first, i);
+			last = i + 1;
+			++nExercised;
+		}
+	}
+
+	const bool contiguous = nExercised > 0 && last - first == nExercised;
+	const bool attached = lower ? (first == lo && (last < hi || hi == n) && exercised(0))
+								: (last == hi && (first > lo || lo == 0) && exercised(n - 1));
+	if (!contiguous || !attached)
+		return ProjectExercise(data, sign, region);
+
+	// the rest of the region is exercised without comparing
+	const size_t begin = lower ? 0 : hi;
+	const size_t end = lower ? lo : n;
+	details::CInstructionSet::Dispatch([&](auto)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			payoff[i] = Value(sign * intrinsic[i]);
+			if (hasVega)
+				vega[i] = Value(0.0);
+		}
+	});
+	PostStepWorker<false, true>(payoff + lo, hasVega ? vega + lo : nullptr, nullptr, intrinsic + lo, hi - lo, sign, 0.0);
+
+	region.edge = lower ? last : first;
+	return nExercised + (end - begin);
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+size_t CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::ProjectExercise(PayoffData& unaliased data, const double sign, CExerciseRegion& unaliased region) noexcept
+{
+	constexpr bool hasVega = adjointDifferentiation == EAdjointDifferentiation::Vega || adjointDifferentiation == EAdjointDifferentiation::All;
+
+	const size_t n = fixedN ? fixedN : input->N;
+	Value* unaliased payoff = data.payoff_i.data();
+	Value* unaliased vega = hasVega ? data.vega_i.data() : nullptr;
+	const Value* unaliased intrinsic = intrinsicValue.data();
+
+	// same as PostStepWorker, also finding one past the last exercised and one past the last continued point
+	size_t nExercised = 0, lastExercised = 0, lastContinued = 0;
+	details::CInstructionSet::Dispatch([&](auto)
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			const Value continuationValue = payoff[i];
+			const Value exerciseValue = sign * intrinsic[i];
+			const bool exercised = exerciseValue > continuationValue;
+			payoff[i] = exercised ? exerciseValue : continuationValue;
+			if (hasVega)
+				vega[i] = exercised ? Value(0.0) : vega[i];
+			nExercised += exercised;
+			lastExercised = exercised ? i + 1 : lastExercised;
+			lastContinued = exercised ? lastContinued : i + 1;
+		}
+	});
+
+	// tracked if it's [0, nExercised) for the put, [n - nExercised, n) for the call
+	const bool lower = sign < 0.0;
+	region.valid = nExercised > 0 && (lower ? lastExercised == nExercised : lastContinued == n - nExercised);
+	region.edge = lower ? nExercised : n - nExercised;
 
-			#endif
+	return nExercised;
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<ECalculationType calculationType, EExerciseType exerciseType>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::RecordExerciseBoundary(const size_t m) noexcept
+{
+	if (exerciseType != EExerciseType::American)
+		return;
+
+	if (callBoundary && (calculationType == ECalculationType::CallOnly || calculationType == ECalculationType::All))
+		callBoundary->spot[m] = ExerciseBoundary(callData, 1.0);
+	if (putBoundary && (calculationType == ECalculationType::PutOnly || calculationType == ECalculationType::All))
+		putBoundary->spot[m] = ExerciseBoundary(putData, -1.0);
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+double CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::ExerciseBoundary(const PayoffData& unaliased data, const double sign) const noexcept
+{
+	const size_t n = input->N;
+	const bool lower = sign < 0.0;
+	const CExerciseRegion& unaliased region = lower ? putRegion : callRegion;
+
+	size_t edge = lower ? 0 : n;
+	if (region.valid)
+		edge = region.edge;
+	else
+	{
+		// the exercised points hold their exercise value, which is positive: walk from the grid boundary
+		auto exercised = [&](const size_t i)
+		{
+			const Value exerciseValue = sign * intrinsicValue[i];
+			return exerciseValue > Value(0.0) && data.payoff_i[i] == exerciseValue;
+		};
+		if (lower)
+			while (edge < n && exercised(edge))
+				++edge;
+		else
+			while (edge > 0 && exercised(edge - 1))
+				--edge;
+	}
+
+	if (lower ? edge == 0 : edge == n)
+		return std::numeric_limits<double>::quiet_NaN();
+
+	return u->GetGrid().Get(lower ? edge - 1 : edge);
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<ECalculationType calculationType, EExerciseType exerciseType>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::BackwardInduction() noexcept
+{
+	ApplyOperator<calculationType, exerciseType>(*u);
+	PostStep<calculationType, exerciseType>(u->GetDt());
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<ECalculationType calculationType, EExerciseType exerciseType>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::BackwardInduction(const size_t nSteps) noexcept
+{
+	if (nSteps == 1)
+	{
+		if (team)
+			PartitionedBackwardInduction<calculationType, exerciseType>();
+		else if (activeWindow)
+			WindowedBackwardInduction<calculationType, exerciseType>();
+		else
+			BackwardInduction<calculationType, exerciseType>();
+		return;
+	}
 
+	switch (calculationType)
+	{
+		case ECalculationType::All:
+			BlockedBackwardInduction<exerciseType, 2>({ { &callData, &putData } }, { { 1.0, -1.0 } }, nSteps);
+			break;
+		case ECalculationType::CallOnly:
+			BlockedBackwardInduction<exerciseType, 1>({ { &callData } }, { { 1.0 } }, nSteps);
 			break;
 		case ECalculationType::PutOnly:
-			#if(1) // ******* Put *******
+			BlockedBackwardInduction<exerciseType, 1>({ { &putData } }, { { -1.0 } }, nSteps);
+			break;
+		default:
+			break;
+	}
+}
 
-			putData.payoff_i[i] = bs.Value<EOptionType::Put>();
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<EExerciseType exerciseType, size_t nRhs>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::BlockedBackwardInduction(const std::array<PayoffData*, nRhs>& unaliased x,
+		const std::array<double, nRhs>& unaliased signs, const size_t nSteps) noexcept
+{
+	constexpr bool american = exerciseType == EExerciseType::American;
+	constexpr bool hasRho = adjointDifferentiation == EAdjointDifferentiation::Rho || adjointDifferentiation == EAdjointDifferentiation::All;
+	const double dt = u->GetDt();
+
+	// the tiles are projected separately
+	ResetExerciseRegions();
 
-			switch (adjointDifferentiation)
+	// Same as PostStep, tile by tile. Rho at the lower boundary is zeroed if anything has been exercised on the whole grid at that step:
+	// the tile with the lower boundary comes last, so the other tiles record what they exercised, one bit per step
+	std::array<uint64_t, nRhs> exercisedSteps = { };
+	u->Apply(x, nSteps, settings->fdSettings.temporalBlockingTileSize, tileBuffer.data(), [&](const details::CTile<Value, nRhs>& unaliased tile, const size_t step)
+	{
+		// vectors that are not computed are null
+		auto at = [](Value* unaliased v, const size_t i) { return v ? v + i : v; };
+
+		const Value* unaliased intrinsic = intrinsicValue.data() + tile.begin;
+		for (size_t j = 0; j < nRhs; ++j)
+		{
+			// the halo is updated as well, but only the owned points count
+			PostStepWorker<true, american>(tile.payoff[j], tile.vega[j], tile.rho[j], intrinsic, tile.ownedBegin, signs[j], dt);
+			const size_t nExercised = PostStepWorker<true, american>(tile.payoff[j] + tile.ownedBegin, at(tile.vega[j], tile.ownedBegin), at(tile.rho[j], tile.ownedBegin),
+					intrinsic + tile.ownedBegin, tile.ownedEnd - tile.ownedBegin, signs[j], dt);
+			PostStepWorker<true, american>(tile.payoff[j] + tile.ownedEnd, at(tile.vega[j], tile.ownedEnd), at(tile.rho[j], tile.ownedEnd),
+					intrinsic + tile.ownedEnd, tile.size - tile.ownedEnd, signs[j], dt);
+
+			if (!american || !hasRho)
+				continue;
+
+			if (nExercised > 0)
+				exercisedSteps[j] |= uint64_t(1) << step;
+			if (tile.begin == 0 && (exercisedSteps[j] >> step) & 1)
 			{
-				case EAdjointDifferentiation::All:
-					putData.vega_i[i] = bs.Vega();
-
-					putData.rho_i[i] = - dt * putData.payoff_i[i];
-					putData.rhoBorrow_i[i] = bs.RhoBorrow<EOptionType::Put>();
-					break;
-				case EAdjointDifferentiation::Vega:
-					putData.vega_i[i] = bs.Vega();
-					break;
-				case EAdjointDifferentiation::Rho:
-					putData.rho_i[i] = - dt * putData.payoff_i[i];
-					putData.rhoBorrow_i[i] = bs.RhoBorrow<EOptionType::Put>();
-					break;
-				default:
-					break;
+				tile.rho[j][0] = 0.0;
+				tile.rhoBorrow[j][0] = 0.0;
 			}
+		}
+	});
+}
 
-			#endif
-
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<ECalculationType calculationType, EExerciseType exerciseType>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::PartitionedBackwardInduction() noexcept
+{
+	switch (calculationType)
+	{
+		case ECalculationType::All:
+			PartitionedBackwardInduction<exerciseType, 2>({ { &callData, &putData } }, { { 1.0, -1.0 } });
+			break;
+		case ECalculationType::CallOnly:
+			PartitionedBackwardInduction<exerciseType, 1>({ { &callData } }, { { 1.0 } });
+			break;
+		case ECalculationType::PutOnly:
+			PartitionedBackwardInduction<exerciseType, 1>({ { &putData } }, { { -1.0 } });
 			break;
 		default:
 			break;
 	}
 }
 
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<EExerciseType exerciseType, size_t nRhs>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::PartitionedBackwardInduction(const std::array<PayoffData*, nRhs>& unaliased x,
+		const std::array<double, nRhs>& unaliased signs) noexcept
+{
+	constexpr bool american = exerciseType == EExerciseType::American;
+	constexpr bool hasVega = adjointDifferentiation == EAdjointDifferentiation::Vega || adjointDifferentiation == EAdjointDifferentiation::All;
+	constexpr bool hasRho = adjointDifferentiation == EAdjointDifferentiation::Rho || adjointDifferentiation == EAdjointDifferentiation::All;
+	const double dt = u->GetDt();
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-template<ECalculationType calculationType>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::RollBack(const double dt, const double df)
+	// the partitions are projected separately
+	ResetExerciseRegions();
+
+	team->Run([&](const size_t p)
+	{
+		u->Apply(x, p, *team, partitionBuffer.data());
+
+		// same as PostStep, over the partition: the operators are done with the neighbouring ones
+		const size_t begin = u->GetPartitionBegin(p);
+		const size_t end = u->GetPartitionBegin(p + 1);
+		for (size_t j = 0; j < nRhs; ++j)
+			partitionExercised[p * nRhs + j] = PostStepWorker<true, american>(x[j]->payoff_i.data() + begin,
+					hasVega ? x[j]->vega_i.data() + begin : nullptr, hasRho ? x[j]->rho_i.data() + begin : nullptr,
+					intrinsicValue.data() + begin, end - begin, signs[j], dt);
+	});
+
+	if (!american || !hasRho)
+		return;
+
+	// rho at the lower boundary is zeroed if anything has been exercised on the whole grid
+	for (size_t j = 0; j < nRhs; ++j)
+	{
+		size_t nExercised = 0;
+		for (size_t p = 0; p < team->size(); ++p)
+			nExercised += partitionExercised[p * nRhs + j];
+
+		if (nExercised > 0)
+		{
+			x[j]->rho_i[0] = 0.0;
+			x[j]->rhoBorrow_i[0] = 0.0;
+		}
+	}
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<ECalculationType calculationType, EExerciseType exerciseType>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::WindowedBackwardInduction() noexcept
+{
+	switch (calculationType)
+	{
+		case ECalculationType::All:
+			WindowedBackwardInduction<exerciseType, 2>({ { &callData, &putData } }, { { 1.0, -1.0 } }, { { 0, 1 } });
+			break;
+		case ECalculationType::CallOnly:
+			WindowedBackwardInduction<exerciseType, 1>({ { &callData } }, { { 1.0 } }, { { 0 } });
+			break;
+		case ECalculationType::PutOnly:
+			WindowedBackwardInduction<exerciseType, 1>({ { &putData } }, { { -1.0 } }, { { 1 } });
+			break;
+		default:
+			break;
+	}
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<EExerciseType exerciseType, size_t nRhs>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::WindowedBackwardInduction(const std::array<PayoffData*, nRhs>& unaliased x,
+		const std::array<double, nRhs>& unaliased signs, const std::array<size_t, nRhs>& unaliased options) noexcept
 {
-	for (size_t i = 0; i < input.N; ++i)
+	constexpr bool american = exerciseType == EExerciseType::American;
+	constexpr bool hasVega = adjointDifferentiation == EAdjointDifferentiation::Vega || adjointDifferentiation == EAdjointDifferentiation::All;
+	constexpr bool hasRho = adjointDifferentiation == EAdjointDifferentiation::Rho || adjointDifferentiation == EAdjointDifferentiation::All;
+	constexpr size_t nVectorsPerRhs = 1 + (hasVega ? 1 : 0) + (hasRho ? 2 : 0);
+
+	// the window is projected as a whole
+	ResetExerciseRegions();
+
+	// a point is frozen only if none of the computed quantities of its option changes
+	std::array<Value*, nRhs * nVectorsPerRhs> vectors;
+	for (size_t j = 0; j < nRhs; ++j)
 	{
-		switch (calculationType)
+		Value** unaliased v = vectors.data() + j * nVectorsPerRhs;
+		*v++ = x[j]->payoff_i.data();
+		if (hasVega)
+			*v++ = x[j]->vega_i.data();
+		if (hasRho)
 		{
-			case ECalculationType::All:
-				callData.payoff_i[i] *= df;
-				putData.payoff_i[i] *= df;
+			*v++ = x[j]->rho_i.data();
+			*v++ = x[j]->rhoBorrow_i.data();
+		}
+	}
+
+	std::array<size_t, nRhs> begin, end;
+	bool fullGrid = true;
+	for (size_t j = 0; j < nRhs; ++j)
+	{
+		begin[j] = windowBegin[options[j]];
+		end[j] = windowEnd[options[j]];
+		fullGrid = fullGrid && begin[j] == 0 && end[j] == input->N;
+
+		for (size_t k = j * nVectorsPerRhs; k < (j + 1) * nVectorsPerRhs; ++k)
+		{
+			std::copy(vectors[k] + begin[j], vectors[k] + begin[j] + windowStep, windowEdges.data() + 2 * k * windowStep);
+			std::copy(vectors[k] + end[j] - windowStep, vectors[k] + end[j], windowEdges.data() + (2 * k + 1) * windowStep);
+		}
+	}
 
-				switch (adjointDifferentiation)
+	// Largest change over the edge bands, and at the edges themselves
+	std::array<Value, nRhs> lowerChange, upperChange, lowerEdgeChange, upperEdgeChange;
+	lowerChange.fill(0.0);
+	upperChange.fill(0.0);
+	lowerEdgeChange.fill(0.0);
+	upperEdgeChange.fill(0.0);
+	auto measureChanges = [&]()
+	{
+		for (size_t j = 0; j < nRhs; ++j)
+		{
+			const size_t upperEdge = end[j] - windowStep;
+			for (size_t k = j * nVectorsPerRhs; k < (j + 1) * nVectorsPerRhs; ++k)
+			{
+				const Value* unaliased lowerOld = windowEdges.data() + 2 * k * windowStep;
+				const Value* unaliased upperOld = windowEdges.data() + (2 * k + 1) * windowStep;
+				for (size_t i = 0; i < windowStep; ++i)
 				{
-					case EAdjointDifferentiation::All:
-						callData.vega_i[i] *= df;
-						callData.rhoBorrow_i[i] *= df;
-						callData.rho_i[i] = -dt * callData.payoff_i[i] + callData.rho_i[i] * df;
-
-						putData.vega_i[i] *= df;
-						putData.rhoBorrow_i[i] *= df;
-						putData.rho_i[i] = -dt * putData.payoff_i[i] + putData.rho_i[i] * df;
-						break;
-					case EAdjointDifferentiation::Vega:
-						callData.vega_i[i] *= df;
-						putData.vega_i[i] *= df;
-						break;
-					case EAdjointDifferentiation::Rho:
-						callData.rhoBorrow_i[i] *= df;
-						callData.rho_i[i] = -dt * callData.payoff_i[i] + callData.rho_i[i] * df;
-						putData.rhoBorrow_i[i] *= df;
-						putData.rho_i[i] = -dt * putData.payoff_i[i] + putData.rho_i[i] * df;
-						break;
-					default:
-						break;
+					lowerChange[j] = std::max(lowerChange[j], Value(std::fabs(vectors[k][begin[j] + i] - lowerOld[i])));
+					upperChange[j] = std::max(upperChange[j], Value(std::fabs(vectors[k][upperEdge + i] - upperOld[i])));
 				}
+				lowerEdgeChange[j] = std::max(lowerEdgeChange[j], Value(std::fabs(vectors[k][begin[j]] - lowerOld[0])));
+				upperEdgeChange[j] = std::max(upperEdgeChange[j], Value(std::fabs(vectors[k][end[j] - 1] - upperOld[windowStep - 1])));
+			}
+		}
+	};
 
-				break;
+	// call and put share the sweeps as long as neither has frozen points
+	if (fullGrid)
+		u->Apply(x);
+	else
+	{
+		for (size_t j = 0; j < nRhs; ++j)
+		{
+			const std::array<PayoffData*, 1> xj = { { x[j] } };
+			if (begin[j] == 0 && end[j] == input->N)
+			{
+				u->Apply(xj);
+				continue;
+			}
 
-			case ECalculationType::CallOnly:
-				callData.payoff_i[i] *= df;
+			frozenPoints += input->N - (end[j] - begin[j]);
 
-				switch (adjointDifferentiation)
-				{
-					case EAdjointDifferentiation::All:
-						callData.vega_i[i] *= df;
-						callData.rhoBorrow_i[i] *= df;
-						callData.rho_i[i] = -dt * callData.payoff_i[i] + callData.rho_i[i] * df;
-						break;
-					case EAdjointDifferentiation::Vega:
-						callData.vega_i[i] *= df;
-						break;
-					case EAdjointDifferentiation::Rho:
-						callData.rhoBorrow_i[i] *= df;
-						callData.rho_i[i] = -dt * callData.payoff_i[i] + callData.rho_i[i] * df;
-						break;
-					default:
-						break;
-				}
+			// the implicit operator factors depend on where the window starts
+			const size_t option = options[j];
+			Factor* unaliased upperFactor = windowFactors.data() + 2 * option * details::Padded<Factor>(input->N);
+			Factor* unaliased inversePivot = upperFactor + details::Padded<Factor>(input->N);
+			if (solverType != ESolverType::ExplicitEuler && (factorizedBegin[option] != begin[j] || factorizedEnd[option] != end[j]))
+			{
+				u->Factorize(begin[j], end[j], upperFactor, inversePivot);
+				factorizedBegin[option] = begin[j];
+				factorizedEnd[option] = end[j];
+			}
 
-				break;
-			case ECalculationType::PutOnly:
-				putData.payoff_i[i] *= df;
+			details::CActiveWindow<Factor> window;
+			window.begin = begin[j];
+			window.end = end[j];
+			window.upperFactor = upperFactor;
+			window.inversePivot = inversePivot;
+			u->Apply(xj, window);
+		}
+	}
 
-				switch (adjointDifferentiation)
-				{
-					case EAdjointDifferentiation::All:
-						putData.vega_i[i] *= df;
-						putData.rhoBorrow_i[i] *= df;
-						putData.rho_i[i] = -dt * putData.payoff_i[i] + putData.rho_i[i] * df;
-						break;
-					case EAdjointDifferentiation::Vega:
-						putData.vega_i[i] *= df;
-						break;
-					case EAdjointDifferentiation::Rho:
-						putData.rhoBorrow_i[i] *= df;
-						putData.rho_i[i] = -dt * putData.payoff_i[i] + putData.rho_i[i] * df;
-						break;
-					default:
-						break;
-				}
+	// The implicit schemes couple the frozen points with their continuation value, rather than with the exercise one:
+	// as that's not stored, the exercised points can't be frozen, unless their continuation value is not changing either
+	if (american && solverType != ESolverType::ExplicitEuler)
+		measureChanges();
 
-				break;
-			default:
-				break;
+	// same as PostStep, over each window
+	for (size_t j = 0; j < nRhs; ++j)
+	{
+		const size_t nExercised = PostStepWorker<true, american>(x[j]->payoff_i.data() + begin[j],
+				hasVega ? x[j]->vega_i.data() + begin[j] : nullptr, hasRho ? x[j]->rho_i.data() + begin[j] : nullptr,
+				intrinsicValue.data() + begin[j], end[j] - begin[j], signs[j], u->GetDt());
+
+		if (american && hasRho && nExercised > 0)
+		{
+			x[j]->rho_i[0] = 0.0;
+			x[j]->rhoBorrow_i[0] = 0.0;
 		}
 	}
-}
 
+	measureChanges();
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::BackwardInduction() noexcept
-{
-	(this->*applyOperatorDelegate)(u);
+	// The edges move by one band at a time: a quiet band is frozen, while the frozen points next to an edge that moves are thawed.
+	// The window keeps a band on each side of the points used by the greeks
+	const double tolerance = settings->fdSettings.activeWindowTolerance;
+	const size_t middle = input->N >> 1;
+	for (size_t j = 0; j < nRhs; ++j)
+	{
+		size_t& unaliased optionBegin = windowBegin[options[j]];
+		size_t& unaliased optionEnd = windowEnd[options[j]];
+		if (lowerChange[j] <= tolerance && optionBegin + 2 * windowStep + 2 <= middle)
+			optionBegin += windowStep;
+		else if (lowerEdgeChange[j] > tolerance)
+			optionBegin -= std::min(optionBegin, windowStep);
+
+		if (upperChange[j] <= tolerance && optionEnd >= middle + 2 * windowStep + 2)
+			optionEnd -= windowStep;
+		else if (upperEdgeChange[j] > tolerance)
+			optionEnd = std::min(optionEnd + windowStep, input->N);
+	}
+}
 
-	(this->*discountDelegate)(u.GetDt(), cache.discountFactor);
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+size_t CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::BlockSize(const size_t m, const size_t end) const noexcept
+{
+	// the exercise boundaries are recorded step by step
+	if (callBoundary || putBoundary)
+		return 1;
 
-	if (settings.exerciseType == EExerciseType::American)
-		(this->*exerciseDelegate)();
+	// the last step of the block can save its leaves, the others can't
+	return std::min(std::min(blockSteps, m + 1 - end), std::max<size_t>(m, 2) - 1);
 }
 
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::RefinedBackwardInduction(const double previousTime, const double currentTime, const CDividend& unaliased dividend) noexcept
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<ECalculationType calculationType, EExerciseType exerciseType>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::RefinedBackwardInduction(const double previousTime, const double currentTime, const CDividend& unaliased dividend) noexcept
 {
 	const double dtAfter  = currentTime - dividend.time;
 	const double dtBefore = dividend.time - previousTime;
@@ -427,18 +816,15 @@ void CFDPricer<solverType, gridType, adjointDifferentiation>::RefinedBackwardInd
 	// if a dividend occurs exactly on a time grid point, there's no need to calculate additional operators
 	if (fabs(dtAfter) <= 1e-12 || fabs(dtBefore) <= 1e-12)
 	{
-		BackwardInduction();
-		(this->*jumpConditionDelegate)(dividend.dividend);
+		BackwardInduction<calculationType, exerciseType>();
+		ApplyJumpCondition<calculationType>(dividend.dividend);
 
-		if (settings.exerciseType == EExerciseType::American)
-			(this->*exerciseDelegate)();
+		if (exerciseType == EExerciseType::American)
+			Exercise<calculationType>();
 
 		return;
 	}
 
-	const double dfAfter = exp(-input.r * dtAfter);
-	const double dfBefore = exp(-input.r * dtBefore); // TODO: maybe to division?
-
 #ifdef DEBUG
 
 	if (dtAfter <= 0.0)
@@ -454,31 +840,21 @@ void CFDPricer<solverType, gridType, adjointDifferentiation>::RefinedBackwardInd
 
 #endif
 
-	Operator uAfter(u, dtAfter);
-	Operator uBefore(u, dtBefore);
-
-	(this->*applyOperatorDelegate)(uAfter);
-
-	(this->*discountDelegate)(dtAfter, dfAfter);
-
-	if (settings.exerciseType == EExerciseType::American)
-		(this->*exerciseDelegate)();
-
-	(this->*jumpConditionDelegate)(dividend.dividend);
+	ApplyOperator<calculationType, exerciseType>(dividendOperators.Get(*u, dtAfter));
+	PostStep<calculationType, exerciseType>(dtAfter);
 
-	if (settings.exerciseType == EExerciseType::American)
-		(this->*exerciseDelegate)();
+	ApplyJumpCondition<calculationType>(dividend.dividend);
 
-	(this->*applyOperatorDelegate)(uBefore);
+	if (exerciseType == EExerciseType::American)
+		Exercise<calculationType>();
 
-	(this->*discountDelegate)(dtBefore, dfBefore);
-	if (settings.exerciseType == EExerciseType::American)
-		(this->*exerciseDelegate)();
+	ApplyOperator<calculationType, exerciseType>(dividendOperators.Get(*u, dtBefore));
+	PostStep<calculationType, exerciseType>(dtBefore);
 }
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
 template<ECalculationType calculationType>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::ApplyJumpCondition(const double shift) noexcept
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::ApplyJumpCondition(const double shift) noexcept
 {
 #ifdef DEBUG
 	if (shift <= 0.0)
@@ -488,135 +864,119 @@ void CFDPricer<solverType, gridType, adjointDifferentiation>::ApplyJumpCondition
 	}
 #endif
 
-	const auto& grid = u.GetGrid();
+	// the exercise regions are shifted as well
+	ResetExerciseRegions();
 
-	size_t j = input.N - 1;
-	double w0 = shift / (grid.Get(input.N - 1) - grid.Get(input.N - 2));  // weight to attribute at point j - 1
-	double w1 = 1.0 - w0;
-	for (size_t i = input.N; i --> 0 ;)
+	// brackets and weights only depend on grid and dividend: they're computed once for all the pricers on this grid
+	const auto table = u->GetGrid().GetJumpTable(shift);
+	switch (calculationType)
 	{
-		const double shiftedValue = grid.Get(i) - shift;
-		if (shiftedValue <= 0.0)
-			return;
-
-		// since grid is monotonically increasing, this while-loop ensures
-		// that grid[j] and grid[j + 1] bracket shiftedValue
-		// Also, shiftedValue < grid[N - 1], so j \in { 0, ..., N - 1 }
-		while (j > 1 && grid.Get(j - 1) >= shiftedValue)
-			--j;
-
-		w0 = (grid.Get(j) - shiftedValue) / (grid.Get(j) - grid.Get(j - 1));  // weight to attribute at point j - 1
-		w1 = 1.0 - w0;
+		case ECalculationType::All:
+			ApplyJumpCondition<2>({ { &callData, &putData } }, *table);
+			break;
+		case ECalculationType::CallOnly:
+			ApplyJumpCondition<1>({ { &callData } }, *table);
+			break;
+		case ECalculationType::PutOnly:
+			ApplyJumpCondition<1>({ { &putData } }, *table);
+			break;
+		default:
+			break;
+	}
+}
 
-#ifdef DEBUG
-		if (j != 1 && (w0 < 0.0 || w1 < 0.0))
-		{
-			printf("*** NEGATIVE WEIGHTS ***\n");
-			return;
-		}
-#endif
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<size_t nRhs>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::ApplyJumpCondition(const std::array<PayoffData*, nRhs>& unaliased x,
+		const details::CJumpTable& unaliased table) noexcept
+{
+	constexpr bool hasVega = adjointDifferentiation == EAdjointDifferentiation::Vega || adjointDifferentiation == EAdjointDifferentiation::All;
+	constexpr bool hasRho = adjointDifferentiation == EAdjointDifferentiation::Rho || adjointDifferentiation == EAdjointDifferentiation::All;
+	constexpr size_t nVectorsPerRhs = 1 + (hasVega ? 1 : 0) + (hasRho ? 2 : 0);
 
-		switch (calculationType)
+	// all the computed quantities are interpolated in one pass
+	std::array<Value*, nRhs * nVectorsPerRhs> vectors;
+	for (size_t j = 0; j < nRhs; ++j)
+	{
+		Value** unaliased v = vectors.data() + j * nVectorsPerRhs;
+		*v++ = x[j]->payoff_i.data();
+		if (hasVega)
+			*v++ = x[j]->vega_i.data();
+		if (hasRho)
 		{
-			case ECalculationType::All:
-				callData.Lerp<adjointDifferentiation>(i, j, w0, w1);
-				putData.Lerp<adjointDifferentiation>(i, j, w0, w1);
-				break;
-			case ECalculationType::CallOnly:
-				callData.Lerp<adjointDifferentiation>(i, j, w0, w1);
-				break;
-			case ECalculationType::PutOnly:
-				putData.Lerp<adjointDifferentiation>(i, j, w0, w1);
-				break;
-			default:
-				break;
+			*v++ = x[j]->rho_i.data();
+			*v++ = x[j]->rhoBorrow_i.data();
 		}
 	}
+
+	table.Apply(vectors);
 }
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::PayoffInitialise(size_t& unaliased m) noexcept
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<ECalculationType calculationType, EExerciseType exerciseType>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::PayoffInitialise(size_t& unaliased m) noexcept
 {
-	if (m != input.M)
+	if (m != input->M)
 		return;
 
-	if (input.smoothing)
+	if (input->smoothing)
 	{
-		(this->*smoothingDelegate)();
+		PayoffSmoothing<calculationType>();
 		--m;
 	}
 	else
-		(this->*exerciseDelegate)();
+		Exercise<calculationType>();
 }
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::RefinedPayoffInitialise(size_t& unaliased m) noexcept
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<ECalculationType calculationType, EExerciseType exerciseType>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::RefinedPayoffInitialise(size_t& unaliased m) noexcept
 {
-	if (m != input.M)
+	if (m != input->M)
 		return;
 
-	double currentTime = input.T;
-	double previousTime = currentTime - u.GetDt();
+	double currentTime = input->T;
+	double previousTime = currentTime - u->GetDt();
 
-	if (input.smoothing)
+	if (input->smoothing)
 	{
-		(this->*refinedSmoothingDelegate)(previousTime, currentTime, input.dividends[divIdx]);
+		RefinedPayoffSmoothing<calculationType, exerciseType>(previousTime, currentTime, input->dividends[divIdx]);
 		--m;
 	}
 	else
 	{
-		(this->*exerciseDelegate)();
-		RefinedBackwardInduction(previousTime, currentTime, input.dividends[divIdx]);
+		Exercise<calculationType>();
+		RefinedBackwardInduction<calculationType, exerciseType>(previousTime, currentTime, input->dividends[divIdx]);
 	}
 }
 
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-template<ECalculationType calculationType>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::Accelerate(size_t& unaliased m,
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<ECalculationType acceleratedType, ECalculationType calculationType, EExerciseType exerciseType>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::Accelerate(size_t& unaliased m,
 		COutputData& unaliased callOutput, COutputData& unaliased putOutput,
-		TimeLeaves& unaliased callLeavesDt, TimeLeaves& unaliased putLeavesDt)
+		TimeLeaves& unaliased callLeavesDt, TimeLeaves& unaliased putLeavesDt) noexcept
 {
-	if (calculationType == ECalculationType::Null)
-		return;
+	// the non-accelerated option
+	constexpr ECalculationType remainingType = details::RemainingCalculationType(calculationType, acceleratedType);
 
-	if (input.dividends.size())
+	if (input->dividends.size())
 	{
 		// Price the accelerated option until last dividend time
-		const double lastDivTime = input.dividends[divIdx].time;
+		const double lastDivTime = input->dividends[divIdx].time;
 
 		 // this floors it to being the greatest integer j s.t. j * dt <= lastDivTime
-		double floatJ = lastDivTime / u.GetDt();
+		double floatJ = lastDivTime / u->GetDt();
 		size_t j = static_cast<size_t>(floatJ);
-		const double previousTime = j * u.GetDt();
+		const double previousTime = j * u->GetDt();
 
-		(this->*refinedSmoothingDelegate)(previousTime, input.T, input.dividends[divIdx]);
+		RefinedPayoffSmoothing<calculationType, exerciseType>(previousTime, input->T, input->dividends[divIdx]);
 
 		// Price the non-accelerated option
-		CPricerSettings newSettings(settings);
-		if (calculationType == ECalculationType::CallOnly)
-		{
-			if (calculatePut)
-				newSettings.calculationType = ECalculationType::PutOnly;
-			else
-				newSettings.calculationType = ECalculationType::Null;
-		}
-		else if (calculationType == ECalculationType::PutOnly)
-		{
-			if (calculateCall)
-				newSettings.calculationType = ECalculationType::CallOnly;
-			else
-				newSettings.calculationType = ECalculationType::Null;
-		}
+		PriceUntil<remainingType, exerciseType>(m, j, callLeavesDt, putLeavesDt);
 
-		UpdateDelegates(newSettings, false, false);
-		PriceUntil(m, j, callLeavesDt, putLeavesDt);
-
-		// make sure that div idx is the correct one
-		divIdx = input.dividends.size() - 2;
-
-		// Restore original settings
-		UpdateDelegates(settings, false, false);
+		// make sure that div idx is the correct one: with a single dividend there's none left, and the last one is never met again
+		divIdx = input->dividends.size() >= 2 ? input->dividends.size() - 2 : 0;
 
 		// Now the calculations are in line for both option types at step j
 		m = j;//(fabs(floatJ - j) > 1e-12) ? (j + 1) : j;
@@ -624,122 +984,208 @@ void CFDPricer<solverType, gridType, adjointDifferentiation>::Accelerate(size_t&
 	else
 	{
 		// Price the accelerated option
-		CBlackScholes bs(input);
-		SmoothingWorker<calculationType>(input.N >> 1, bs, input.T);
+		CBlackScholes bs(*input);
+		CBlackScholes::Smooth<acceleratedType, adjointDifferentiation>(*input, bs.GetCacheData(), &input->S, 1, 0.0,
+				SmoothingOutput(callData, input->N >> 1), SmoothingOutput(putData, input->N >> 1));
 
 		// Sets non-AD greeks
-		if (calculationType == ECalculationType::CallOnly)
+		if (acceleratedType == ECalculationType::CallOnly)
 		{
 			callOutput.delta = bs.Delta<EOptionType::Call>();
 			callOutput.gamma = bs.Gamma();
-			callOutput.rho = -input.T * callData.payoff_i[input.N >> 1];
+			callOutput.rho = -input->T * callData.payoff_i[input->N >> 1];
 			callOutput.rhoBorrow = bs.RhoBorrow<EOptionType::Call>();
 
 			// TODO: theta charm
 		}
-		else if (calculationType == ECalculationType::PutOnly)
+		else if (acceleratedType == ECalculationType::PutOnly)
 		{
 			putOutput.delta = bs.Delta<EOptionType::Put>();
 			putOutput.gamma = bs.Gamma();
-			putOutput.rho = -input.T * callData.payoff_i[input.N >> 1];
+			putOutput.rho = -input->T * callData.payoff_i[input->N >> 1];
 			putOutput.rhoBorrow = bs.RhoBorrow<EOptionType::Put>();
 
 			// TODO: theta charm
 		}
 
 		// Price the non-accelerated option
-		CPricerSettings newSettings(settings);
-		if (calculationType == ECalculationType::CallOnly)
+		size_t start = input->M;
+		if (start != 0)
 		{
-			if (calculatePut)
-				newSettings.calculationType = ECalculationType::PutOnly;
-			else
-				newSettings.calculationType = ECalculationType::Null;
+			PriceUntil<remainingType, exerciseType>(start, 0, callLeavesDt, putLeavesDt);
+			ComputeGreeks<remainingType>(callOutput, putOutput, callLeavesDt, putLeavesDt);
+			SetOutput<remainingType>(callOutput, putOutput);
 		}
-		else if (calculationType == ECalculationType::PutOnly)
-		{
-			if (calculateCall)
-				newSettings.calculationType = ECalculationType::CallOnly;
-			else
-				newSettings.calculationType = ECalculationType::Null;
-		}
-		UpdateDelegates(newSettings, false, false);
-
-		Price(callOutput, putOutput);
 
-		SetOutput<calculationType>(callOutput, putOutput);
+		SetOutput<acceleratedType>(callOutput, putOutput);
 
 		m = 0;
 	}
 }
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::Price(COutputData& unaliased callOutput, COutputData& unaliased putOutput) noexcept
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::Price(COutputData& unaliased callOutput, COutputData& unaliased putOutput) noexcept
+{
+	Dispatch([&](auto calculationType, auto exerciseType)
+	{
+		this->template PriceWorker<decltype(calculationType)::value, decltype(exerciseType)::value>(callOutput, putOutput);
+	});
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::Price(COutputData& unaliased callOutput, COutputData& unaliased putOutput,
+		CExerciseBoundary& unaliased callBoundary, CExerciseBoundary& unaliased putBoundary) noexcept
+{
+	for (CExerciseBoundary* boundary : std::array<CExerciseBoundary*, 2> { { &callBoundary, &putBoundary } })
+	{
+		boundary->time.resize(input->M + 1);
+		boundary->spot.assign(input->M + 1, std::numeric_limits<double>::quiet_NaN());
+		for (size_t m = 0; m <= input->M; ++m)
+			boundary->time[m] = m * u->GetDt();
+	}
+
+	this->callBoundary = &callBoundary;
+	this->putBoundary = &putBoundary;
+	Price(callOutput, putOutput);
+	this->callBoundary = this->putBoundary = nullptr;
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<typename Worker>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::Dispatch(Worker&& worker) noexcept
+{
+	// anything but American is European
+	if (settings->exerciseType == EExerciseType::American)
+		DispatchCalculationType<EExerciseType::American>(worker);
+	else
+		DispatchCalculationType<EExerciseType::European>(worker);
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<EExerciseType exerciseType, typename Worker>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::DispatchCalculationType(Worker& unaliased worker) noexcept
+{
+	using ExerciseType = std::integral_constant<EExerciseType, exerciseType>;
+	switch (settings->calculationType)
+	{
+		case ECalculationType::All:
+			worker(std::integral_constant<ECalculationType, ECalculationType::All>(), ExerciseType());
+			break;
+		case ECalculationType::CallOnly:
+			worker(std::integral_constant<ECalculationType, ECalculationType::CallOnly>(), ExerciseType());
+			break;
+		case ECalculationType::PutOnly:
+			worker(std::integral_constant<ECalculationType, ECalculationType::PutOnly>(), ExerciseType());
+			break;
+		case ECalculationType::Null:
+			worker(std::integral_constant<ECalculationType, ECalculationType::Null>(), ExerciseType());
+			break;
+		default:
+			printf("WRONG SETTINGS");
+			break;
+	}
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<ECalculationType calculationType, EExerciseType exerciseType>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::PriceWorker(COutputData& unaliased callOutput, COutputData& unaliased putOutput) noexcept
 {
 	TimeLeaves callLeavesDt, putLeavesDt;
 
-	size_t m = input.M;
-	(this->*accelerationDelegate)(m, callOutput, putOutput, callLeavesDt, putLeavesDt);
+	size_t m = input->M;
+	if (accelerateCall)
+		Accelerate<ECalculationType::CallOnly, calculationType, exerciseType>(m, callOutput, putOutput, callLeavesDt, putLeavesDt);
+	else if (acceleratePut)
+		Accelerate<ECalculationType::PutOnly, calculationType, exerciseType>(m, callOutput, putOutput, callLeavesDt, putLeavesDt);
 	if (m == 0)
 		return;
 
-	PriceUntil(m, 0, callLeavesDt, putLeavesDt);
+	PriceUntil<calculationType, exerciseType>(m, 0, callLeavesDt, putLeavesDt);
 
-	(this->*computeGreeksDelegate)(callOutput, putOutput, callLeavesDt, putLeavesDt);
-	(this->*setOutputDelegate)(callOutput, putOutput);
+	ComputeGreeks<calculationType>(callOutput, putOutput, callLeavesDt, putLeavesDt);
+	SetOutput<calculationType>(callOutput, putOutput);
 }
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::PriceUntil(size_t start, const size_t end, TimeLeaves& unaliased callLeavesDt, TimeLeaves& unaliased putLeavesDt) noexcept
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+template<ECalculationType calculationType, EExerciseType exerciseType>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::PriceUntil(size_t start, const size_t end, TimeLeaves& unaliased callLeavesDt, TimeLeaves& unaliased putLeavesDt) noexcept
 {
-	if (input.dividends.size())
+	ResetWindow();
+	ResetExerciseRegions();
+	frozenPoints = 0;
+
+	if (input->dividends.size())
 	{
-		double currentTime = start * u.GetDt();
-		double previousTime = currentTime - u.GetDt();
+		double currentTime = start * u->GetDt();
+		double previousTime = currentTime - u->GetDt();
 
-		if (input.dividends[divIdx].time >= previousTime && input.dividends[divIdx].time < currentTime)
-			RefinedPayoffInitialise(start);
+		if (input->dividends[divIdx].time >= previousTime && input->dividends[divIdx].time < currentTime)
+			RefinedPayoffInitialise<calculationType, exerciseType>(start);
 		else
-			PayoffInitialise(start);
+			PayoffInitialise<calculationType, exerciseType>(start);
+		RecordExerciseBoundary<calculationType, exerciseType>(start);
 
 		// might be updated from smoothing
-		currentTime = start * u.GetDt();
-		previousTime = currentTime - u.GetDt();
+		currentTime = start * u->GetDt();
+		previousTime = currentTime - u->GetDt();
 
 		for (; start --> end ;)
 		{
-			if (input.dividends[divIdx].time >= previousTime && input.dividends[divIdx].time < currentTime)
+			if (input->dividends[divIdx].time >= previousTime && input->dividends[divIdx].time < currentTime)
 			{
-				RefinedBackwardInduction(previousTime, currentTime, input.dividends[divIdx]);
+				RefinedBackwardInduction<calculationType, exerciseType>(previousTime, currentTime, input->dividends[divIdx]);
 				if (divIdx != 0)
 					--divIdx;
+
+				// the jump condition moves the frozen points as well
+				ResetWindow();
 			}
 			else
-				BackwardInduction();
+			{
+				// the block stops before the dividend: the times are updated as below, so that it's found at the same step
+				size_t nSteps = 1;
+				for (const size_t maxSteps = BlockSize(start, end); nSteps < maxSteps; ++nSteps)
+				{
+					const double nextTime = previousTime - u->GetDt();
+					if (input->dividends[divIdx].time >= nextTime && input->dividends[divIdx].time < previousTime)
+						break;
+
+					currentTime = previousTime;
+					previousTime = nextTime;
+				}
+
+				BackwardInduction<calculationType, exerciseType>(nSteps);
+				start -= nSteps - 1;
+			}
 
+			RecordExerciseBoundary<calculationType, exerciseType>(start);
 			if (start < 3)
 				SaveLeaves(start, callLeavesDt, putLeavesDt);
 
 			currentTime = previousTime;
-			previousTime -= u.GetDt();
+			previousTime -= u->GetDt();
 		}
 	}
 	else
 	{
-		PayoffInitialise(start);
+		PayoffInitialise<calculationType, exerciseType>(start);
+		RecordExerciseBoundary<calculationType, exerciseType>(start);
 
 		for (; start --> end ;)
 		{
-			BackwardInduction();
+			const size_t nSteps = BlockSize(start, end);
+			BackwardInduction<calculationType, exerciseType>(nSteps);
+			start -= nSteps - 1;
 
+			RecordExerciseBoundary<calculationType, exerciseType>(start);
 			if (start < 3)
 				SaveLeaves(start, callLeavesDt, putLeavesDt);
 		}
 	}
 }
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::SaveLeaves(const size_t m, TimeLeaves& unaliased callLeavesDt, TimeLeaves& unaliased putLeavesDt) const noexcept
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::SaveLeaves(const size_t m, TimeLeaves& unaliased callLeavesDt, TimeLeaves& unaliased putLeavesDt) const noexcept
 {
 	if (m == 0)
 		return;
@@ -747,40 +1193,40 @@ void CFDPricer<solverType, gridType, adjointDifferentiation>::SaveLeaves(const s
 	const size_t idx = 3 * (m - 1);
 	if (calculateCall)
 	{
-		callLeavesDt[idx]     = callData.payoff_i[(input.N >> 1) - 1];
-		callLeavesDt[idx + 1] = callData.payoff_i[input.N >> 1];
-		callLeavesDt[idx + 2] = callData.payoff_i[(input.N >> 1) + 1];
+		callLeavesDt[idx]     = callData.payoff_i[(input->N >> 1) - 1];
+		callLeavesDt[idx + 1] = callData.payoff_i[input->N >> 1];
+		callLeavesDt[idx + 2] = callData.payoff_i[(input->N >> 1) + 1];
 	}
 
 	if (calculatePut)
 	{
-		putLeavesDt[idx]     = putData.payoff_i[(input.N >> 1) - 1];
-		putLeavesDt[idx + 1] = putData.payoff_i[input.N >> 1];
-		putLeavesDt[idx + 2] = putData.payoff_i[(input.N >> 1) + 1];
+		putLeavesDt[idx]     = putData.payoff_i[(input->N >> 1) - 1];
+		putLeavesDt[idx + 1] = putData.payoff_i[input->N >> 1];
+		putLeavesDt[idx + 2] = putData.payoff_i[(input->N >> 1) + 1];
 	}
 }
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
 template<ECalculationType calculationType>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::SetOutput(COutputData& unaliased callOutput, COutputData& unaliased putOutput) const
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::SetOutput(COutputData& unaliased callOutput, COutputData& unaliased putOutput) const
 {
 	if (calculationType == ECalculationType::CallOnly || calculationType == ECalculationType::All)
 	{
-		callOutput.price = callData.payoff_i[input.N >> 1];
+		callOutput.price = callData.payoff_i[input->N >> 1];
 
 		switch (adjointDifferentiation)
 		{
 			case EAdjointDifferentiation::All:
-				callOutput.vega = callData.vega_i[input.N >> 1];
-				callOutput.rhoBorrow = callData.rhoBorrow_i[input.N >> 1];
-				callOutput.rho = callData.rho_i[input.N >> 1];
+				callOutput.vega = callData.vega_i[input->N >> 1];
+				callOutput.rhoBorrow = callData.rhoBorrow_i[input->N >> 1];
+				callOutput.rho = callData.rho_i[input->N >> 1];
 				break;
 			case EAdjointDifferentiation::Vega:
-				callOutput.vega = callData.vega_i[input.N >> 1];
+				callOutput.vega = callData.vega_i[input->N >> 1];
 				break;
 			case EAdjointDifferentiation::Rho:
-				callOutput.rhoBorrow = callData.rhoBorrow_i[input.N >> 1];
-				callOutput.rho = callData.rho_i[input.N >> 1];
+				callOutput.rhoBorrow = callData.rhoBorrow_i[input->N >> 1];
+				callOutput.rho = callData.rho_i[input->N >> 1];
 				break;
 			default:
 				break;
@@ -790,21 +1236,21 @@ void CFDPricer<solverType, gridType, adjointDifferentiation>::SetOutput(COutputD
 
 	if (calculationType == ECalculationType::PutOnly || calculationType == ECalculationType::All)
 	{
-		putOutput.price = putData.payoff_i[input.N >> 1];
+		putOutput.price = putData.payoff_i[input->N >> 1];
 
 		switch (adjointDifferentiation)
 		{
 			case EAdjointDifferentiation::All:
-				putOutput.vega = putData.vega_i[input.N >> 1];
-				putOutput.rhoBorrow = putData.rhoBorrow_i[input.N >> 1];
-				putOutput.rho = putData.rho_i[input.N >> 1];
+				putOutput.vega = putData.vega_i[input->N >> 1];
+				putOutput.rhoBorrow = putData.rhoBorrow_i[input->N >> 1];
+				putOutput.rho = putData.rho_i[input->N >> 1];
 				break;
 			case EAdjointDifferentiation::Vega:
-				putOutput.vega = putData.vega_i[input.N >> 1];
+				putOutput.vega = putData.vega_i[input->N >> 1];
 				break;
 			case EAdjointDifferentiation::Rho:
-				putOutput.rhoBorrow = putData.rhoBorrow_i[input.N >> 1];
-				putOutput.rho = putData.rho_i[input.N >> 1];
+				putOutput.rhoBorrow = putData.rhoBorrow_i[input->N >> 1];
+				putOutput.rho = putData.rho_i[input->N >> 1];
 				break;
 			default:
 				break;
@@ -812,14 +1258,14 @@ void CFDPricer<solverType, gridType, adjointDifferentiation>::SetOutput(COutputD
 	}
 }
 
-template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision, EOperatorStorage operatorStorage>
 template<ECalculationType calculationType>
-void CFDPricer<solverType, gridType, adjointDifferentiation>::ComputeGreeks(COutputData& unaliased callOutput, COutputData& unaliased putOutput, const TimeLeaves& unaliased callLeavesDt, const TimeLeaves& unaliased putLeavesDt) const
+void CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision, operatorStorage>::ComputeGreeks(COutputData& unaliased callOutput, COutputData& unaliased putOutput, const TimeLeaves& unaliased callLeavesDt, const TimeLeaves& unaliased putLeavesDt) const
 {
-	const auto& grid = u.GetGrid();
+	const auto& grid = u->GetGrid();
 
-	const double dxPlus  = grid.Get((input.N >> 1) + 1) - grid.Get((input.N >> 1));
-	const double dxMinus = grid.Get((input.N >> 1))     - grid.Get((input.N >> 1) - 1);
+	const double dxPlus  = grid.Get((input->N >> 1) + 1) - grid.Get((input->N >> 1));
+	const double dxMinus = grid.Get((input->N >> 1))     - grid.Get((input->N >> 1) - 1);
 	const double dx = dxPlus + dxMinus;
 
 	const double b0 = 1.0 / (dx * dxMinus);
@@ -830,17 +1276,17 @@ void CFDPricer<solverType, gridType, adjointDifferentiation>::ComputeGreeks(COut
 	const double a2 =  dxMinus * b2;
 	const double a1 = -a0 - a2;
 
-	double oneOverHalfDt = 1.0 / u.GetDt();
+	double oneOverHalfDt = 1.0 / u->GetDt();
 	const double oneOverDt2 = oneOverHalfDt * oneOverHalfDt;
 	oneOverHalfDt = .5;
 
 	if (calculationType == ECalculationType::CallOnly || calculationType == ECalculationType::All)
 	{
-		callOutput.delta = a0 * callData.payoff_i[(input.N >> 1) - 1] + a1 * callData.payoff_i[input.N >> 1] + a2 * callData.payoff_i[(input.N >> 1) + 1];
-		callOutput.gamma = 2.0 * (b0 * callData.payoff_i[(input.N >> 1) - 1] + b1 * callData.payoff_i[input.N >> 1] + b2 * callData.payoff_i[(input.N >> 1) + 1]);
+		callOutput.delta = a0 * callData.payoff_i[(input->N >> 1) - 1] + a1 * callData.payoff_i[input->N >> 1] + a2 * callData.payoff_i[(input->N >> 1) + 1];
+		callOutput.gamma = 2.0 * (b0 * callData.payoff_i[(input->N >> 1) - 1] + b1 * callData.payoff_i[input->N >> 1] + b2 * callData.payoff_i[(input->N >> 1) + 1]);
 
-		callOutput.theta  = oneOverHalfDt  * (callLeavesDt[4]                         - callData.payoff_i[input.N >> 1]);
-		callOutput.theta2 = oneOverDt2 *     (callLeavesDt[4] - 2.0 * callLeavesDt[1] + callData.payoff_i[input.N >> 1]);
+		callOutput.theta  = oneOverHalfDt  * (callLeavesDt[4]                         - callData.payoff_i[input->N >> 1]);
+		callOutput.theta2 = oneOverDt2 *     (callLeavesDt[4] - 2.0 * callLeavesDt[1] + callData.payoff_i[input->N >> 1]);
 
 		const double delta_2dt = a0 * callLeavesDt[3] + a1 * callLeavesDt[4] + a2 * callLeavesDt[5];
 		callOutput.charm = oneOverHalfDt * (delta_2dt - callOutput.delta);
@@ -848,11 +1294,11 @@ void CFDPricer<solverType, gridType, adjointDifferentiation>::ComputeGreeks(COut
 
 	if (calculationType == ECalculationType::PutOnly || calculationType == ECalculationType::All)
 	{
-		putOutput.delta = a0 * putData.payoff_i[(input.N >> 1) - 1] + a1 * putData.payoff_i[input.N >> 1] + a2 * putData.payoff_i[(input.N >> 1) + 1];
-		putOutput.gamma = 2.0 * (b0 * putData.payoff_i[(input.N >> 1) - 1] + b1 * putData.payoff_i[input.N >> 1] + b2 * putData.payoff_i[(input.N >> 1) + 1]);
+		putOutput.delta = a0 * putData.payoff_i[(input->N >> 1) - 1] + a1 * putData.payoff_i[input->N >> 1] + a2 * putData.payoff_i[(input->N >> 1) + 1];
+		putOutput.gamma = 2.0 * (b0 * putData.payoff_i[(input->N >> 1) - 1] + b1 * putData.payoff_i[input->N >> 1] + b2 * putData.payoff_i[(input->N >> 1) + 1]);
 
-		putOutput.theta  = oneOverHalfDt  * (putLeavesDt[4]                        - putData.payoff_i[input.N >> 1]);
-		putOutput.theta2 = oneOverDt2 *     (putLeavesDt[4] - 2.0 * putLeavesDt[1] + putData.payoff_i[input.N >> 1]);
+		putOutput.theta  = oneOverHalfDt  * (putLeavesDt[4]                        - putData.payoff_i[input->N >> 1]);
+		putOutput.theta2 = oneOverDt2 *     (putLeavesDt[4] - 2.0 * putLeavesDt[1] + putData.payoff_i[input->N >> 1]);
 
 		const double delta_2dt = a0 * putLeavesDt[3] + a1 * putLeavesDt[4] + a2 * putLeavesDt[5];
 		putOutput.charm = oneOverHalfDt * (delta_2dt - putOutput.delta);
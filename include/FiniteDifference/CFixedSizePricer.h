@@ -0,0 +1,56 @@
+/*
+ * CFixedSizePricer.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef FINITEDIFFERENCE_CFIXEDSIZEPRICER_H_
+#define FINITEDIFFERENCE_CFIXEDSIZEPRICER_H_
+
+#include <FiniteDifference/CFDPricer.h>
+#include <Flags.h>
+
+namespace fdpricing
+{
+
+/**
+ * Run time dispatch of input.N to the compile time sized CFDPricer specializations (129, 257 and 513 grid points):
+ * any other size is priced by the dynamic one
+ */
+template <ESolverType solverType=ESolverType::CrankNicolson,
+		EGridType gridType=EGridType::Adaptive,
+		EAdjointDifferentiation adjointDifferentiation=EAdjointDifferentiation::All,
+		EPrecision precision=EPrecision::Double>
+class CFixedSizePricer
+{
+public:
+	CFixedSizePricer(const CInputData& unaliased input, const CPricerSettings& unaliased settings) noexcept;
+
+	CFixedSizePricer(const CFixedSizePricer& rhs) = delete;
+	CFixedSizePricer(const CFixedSizePricer&& rhs) = delete;
+	CFixedSizePricer& operator=(const CFixedSizePricer& rhs) = delete;
+	CFixedSizePricer& operator=(const CFixedSizePricer&& rhs) = delete;
+
+	virtual ~CFixedSizePricer() = default;
+
+	void Price(COutputData& unaliased callOutput, COutputData& unaliased putOutput) noexcept;
+
+	/**
+	 * Whether N has a compile time sized specialization
+	 */
+	static bool IsFixedSize(const size_t N) noexcept;
+
+private:
+	const CInputData& unaliased input;
+	const CPricerSettings& unaliased settings;
+
+	template<size_t fixedN>
+	void PriceWorker(COutputData& unaliased callOutput, COutputData& unaliased putOutput) noexcept;
+};
+
+} /* namespace fdpricing */
+
+#include <FiniteDifference/CFixedSizePricer.tpp>
+
+#endif /* FINITEDIFFERENCE_CFIXEDSIZEPRICER_H_ */
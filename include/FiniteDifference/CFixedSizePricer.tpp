@@ -0,0 +1,61 @@
+/*
+ * CFixedSizePricer.tpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#include <Flags.h>
+
+namespace fdpricing
+{
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, EPrecision precision>
+CFixedSizePricer<solverType, gridType, adjointDifferentiation, precision>::CFixedSizePricer(const CInputData& unaliased input, const CPricerSettings& unaliased settings) noexcept
+	: input(input), settings(settings)
+{
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, EPrecision precision>
+bool CFixedSizePricer<solverType, gridType, adjointDifferentiation, precision>::IsFixedSize(const size_t N) noexcept
+{
+	switch (N)
+	{
+		case 129:
+		case 257:
+		case 513:
+			return true;
+		default:
+			return false;
+	}
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, EPrecision precision>
+void CFixedSizePricer<solverType, gridType, adjointDifferentiation, precision>::Price(COutputData& unaliased callOutput, COutputData& unaliased putOutput) noexcept
+{
+	switch (input.N)
+	{
+		case 129:
+			PriceWorker<129>(callOutput, putOutput);
+			break;
+		case 257:
+			PriceWorker<257>(callOutput, putOutput);
+			break;
+		case 513:
+			PriceWorker<513>(callOutput, putOutput);
+			break;
+		default:
+			PriceWorker<0>(callOutput, putOutput);
+			break;
+	}
+}
+
+template <ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, EPrecision precision>
+template<size_t fixedN>
+void CFixedSizePricer<solverType, gridType, adjointDifferentiation, precision>::PriceWorker(COutputData& unaliased callOutput, COutputData& unaliased putOutput) noexcept
+{
+	CFDPricer<solverType, gridType, adjointDifferentiation, fixedN, precision> pricer(input, settings);
+	pricer.Price(callOutput, putOutput);
+}
+
+} /* namespace fdpricing */
@@ -9,8 +9,13 @@
 #define FINITEDIFFERENCE_CGRID_H_
 
 #include <vector>
+#include <memory>
+#include <utility>
 #include <cmath>
 #include <stddef.h>
+
+#include <FiniteDifference/CStencilWeights.h>
+#include <FiniteDifference/CJumpTable.h>
 #include <Flags.h>
 
 namespace fdpricing
@@ -37,7 +42,7 @@ public:
 	CGrid(const double x0, const double lb, const double ub, const size_t N) noexcept;
 
 	CGrid(const CGrid& unaliased rhs) noexcept;
-	CGrid(const CGrid&& unaliased rhs) noexcept;
+	CGrid(CGrid&& unaliased rhs) noexcept;
 
 	virtual ~CGrid() = default;
 
@@ -58,6 +63,22 @@ public:
 		return N;
 	}
 
+	/**
+	 * Finite difference weights, computed once per grid: any operator on this grid is an axpy of them
+	 */
+	const details::CStencilWeights<>& GetStencilWeights() const noexcept
+	{
+		return stencilWeights;
+	}
+
+	/**
+	 * Jump condition of a cash dividend on this grid, computed once per dividend amount (see details::CJumpTable)
+	 */
+	std::shared_ptr<const details::CJumpTable> GetJumpTable(const double shift) const noexcept
+	{
+		return jumpTables.Get(data.data(), N, shift);
+	}
+
 	const size_t N;
 	const double x0;
 	const double lb;
@@ -66,7 +87,13 @@ public:
 private:
 	void Make() noexcept;
 
-	std::vector<double> data;
+	details::AlignedVector<double> data;
+	details::CStencilWeights<> stencilWeights;
+
+	/**
+	 * Not copied along with the grid: the copy builds its own tables
+	 */
+	mutable details::CJumpTableCache jumpTables;
 };
 
 
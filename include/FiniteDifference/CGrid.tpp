@@ -28,17 +28,18 @@ CGrid<gridType>::CGrid(const double x0, const double lb, const double ub, const
 #endif
 
 	Make();
+	stencilWeights.Make(*this);
 }
 
 template<EGridType gridType>
 CGrid<gridType>::CGrid(const CGrid& unaliased rhs) noexcept
-	: N(rhs.N), x0(rhs.x0), lb(rhs.lb), ub(rhs.ub), data(rhs.data)
+	: N(rhs.N), x0(rhs.x0), lb(rhs.lb), ub(rhs.ub), data(rhs.data), stencilWeights(rhs.stencilWeights)
 {
 }
 
 template<EGridType gridType>
-CGrid<gridType>::CGrid(const CGrid&& unaliased rhs) noexcept
-	: N(rhs.N), x0(rhs.x0), lb(rhs.lb), ub(rhs.ub), data(rhs.data)
+CGrid<gridType>::CGrid(CGrid&& unaliased rhs) noexcept
+	: N(rhs.N), x0(rhs.x0), lb(rhs.lb), ub(rhs.ub), data(std::move(rhs.data)), stencilWeights(std::move(rhs.stencilWeights))
 {
 }
 
@@ -0,0 +1,196 @@
+/*
+ * CJumpTable.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef FINITEDIFFERENCE_CJUMPTABLE_H_
+#define FINITEDIFFERENCE_CJUMPTABLE_H_
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <algorithm>
+#include <cstdio>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Utilities/CAlignedAllocator.h>
+#include <Utilities/CInstructionSet.h>
+#include <Flags.h>
+
+namespace details
+{
+
+/**
+ * Jump condition of a cash dividend D on a grid, V(S_i) <- V(S_i - D), as a linear interpolation:
+ * 	V_i <- w0_i * V_{j_i} + w1_i * V_{j_i + 1}, for i >= begin
+ * where S_{j_i} and S_{j_i + 1} bracket S_i - D (below S_1 it's extrapolated from S_0 and S_1). The points whose shifted value is not positive are left as they are.
+ * It only depends on grid and dividend, hence it's computed once and shared by all the pricers on the grid (see CGrid::GetJumpTable).
+ *
+ * The brackets are stored as runs of points with the same offset i - j_i: as D spans a slowly varying number of grid points, runs are long
+ * (tens of points on average), and each of them is interpolated with contiguous loads rather than gathers
+ */
+class CJumpTable
+{
+public:
+	/**
+	 * allocator: where the table lives, i.e. the same arena as the grid
+	 */
+	CJumpTable(const double* unaliased grid, const size_t N, const double shift, const CAlignedAllocator<double>& unaliased allocator) noexcept
+		: N(N), begin(N), w0(N, 0.0, allocator), w1(N, 0.0, allocator), runs(CAlignedAllocator<CRun>(allocator))
+	{
+		// same brackets as a top-down search: grid[j - 1] < S_i - D <= grid[j], with j >= 1. Runs go top-down as well
+		size_t j = N - 1;
+		for (size_t i = N; i --> 0 ;)
+		{
+			const double shiftedValue = grid[i] - shift;
+			if (shiftedValue <= 0.0)
+				break;
+
+			while (j > 1 && grid[j - 1] >= shiftedValue)
+				--j;
+
+			begin = i;
+			w0[i] = (grid[j] - shiftedValue) / (grid[j] - grid[j - 1]);
+			w1[i] = 1.0 - w0[i];
+
+#ifdef DEBUG
+			if (j != 1 && (w0[i] < 0.0 || w1[i] < 0.0))
+				printf("*** NEGATIVE WEIGHTS ***\n");
+#endif
+
+			const size_t offset = i - (j - 1);
+			if (runs.empty() || runs.back().offset != offset || runs.back().end - i > chunkSize)
+				runs.push_back(CRun { i, i + 1, offset });
+			else
+				runs.back().begin = i;
+		}
+	}
+
+	CJumpTable(const CJumpTable& rhs) = delete;
+	CJumpTable& operator=(const CJumpTable& rhs) = delete;
+
+	/**
+	 * Apply the jump condition to all the vectors x in one pass over the table. Every point reads points below it only, so the runs go top-down:
+	 * a run is computed out-of-place into an L1 scratch buffer, then copied back
+	 */
+	template<typename T, size_t nVectors>
+	void Apply(const std::array<T*, nVectors>& unaliased x) const noexcept
+	{
+		CInstructionSet::Dispatch([&](auto)
+		{
+			alignas(cacheLineSize) T buffer[chunkSize];
+			for (const auto& run : runs)
+			{
+				for (size_t k = 0; k < nVectors; ++k)
+				{
+					Interpolate(x[k] + run.begin - run.offset, buffer, run);
+					std::copy(buffer, buffer + (run.end - run.begin), x[k] + run.begin);
+				}
+			}
+		});
+	}
+
+	const size_t N;
+
+	/**
+	 * First point that is shifted
+	 */
+	size_t begin;
+
+private:
+	/**
+	 * Points [begin, end) whose lower bracket is j_i - 1 = i - offset
+	 */
+	struct CRun
+	{
+		size_t begin;
+		size_t end;
+		size_t offset;
+	};
+
+	/**
+	 * Max points per run, i.e. the size of the scratch buffer
+	 */
+	static constexpr size_t chunkSize = 256;
+
+	AlignedVector<double> w0;
+	AlignedVector<double> w1;
+	AlignedVector<CRun> runs;
+
+	/**
+	 * y[i - run.begin] for the points of run, where x starts at the lower bracket of run.begin.
+	 * The weights are double whatever T is, as in CPayoffData::Lerp
+	 */
+	template<typename T>
+	inline void Interpolate(const T* unaliased x, T* unaliased y, const CRun& unaliased run) const noexcept
+	{
+		const double* unaliased a = w0.data() + run.begin;
+		const double* unaliased b = w1.data() + run.begin;
+		for (size_t i = 0; i < run.end - run.begin; ++i)
+			y[i] = static_cast<T>(a[i] * x[i] + b[i] * x[i + 1]);
+	}
+};
+
+/**
+ * Jump tables of a grid, keyed by the dividend amount. Grids can be shared by pricers on different threads (see COperatorRegistry):
+ * lookups are rare (once per dividend), so they're simply serialized. Once full, the oldest table is evicted.
+ * The tables are allocated from the arena the cache has been built in, so they live as long as the grid
+ */
+class CJumpTableCache
+{
+public:
+	static constexpr size_t capacity = 16;
+
+	CJumpTableCache() noexcept
+		: next(0)
+	{
+		entries.reserve(capacity);
+	}
+
+	CJumpTableCache(const CJumpTableCache& rhs) = delete;
+	CJumpTableCache& operator=(const CJumpTableCache& rhs) = delete;
+
+	std::shared_ptr<const CJumpTable> Get(const double* unaliased grid, const size_t N, const double shift) noexcept
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (const auto& entry : entries)
+		{
+			if (entry.first == shift)
+				return entry.second;
+		}
+
+		std::shared_ptr<const CJumpTable> table = std::allocate_shared<CJumpTable>(CAlignedAllocator<CJumpTable>(allocator), grid, N, shift, allocator);
+		if (entries.size() < capacity)
+		{
+			entries.emplace_back(shift, table);
+			return table;
+		}
+
+		entries[next] = std::make_pair(shift, table);
+		next = (next + 1) % capacity;
+		return table;
+	}
+
+private:
+	std::mutex mutex;
+
+	/**
+	 * Captures the arena of the thread building the cache
+	 */
+	CAlignedAllocator<double> allocator;
+
+	/**
+	 * Next entry to be evicted
+	 */
+	size_t next;
+
+	AlignedVector<std::pair<double, std::shared_ptr<const CJumpTable>>> entries;
+};
+
+}
+
+#endif /* FINITEDIFFERENCE_CJUMPTABLE_H_ */
@@ -0,0 +1,256 @@
+/*
+ * CMatrixFreeEvolutionOperator.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef FINITEDIFFERENCE_CMATRIXFREEEVOLUTIONOPERATOR_H_
+#define FINITEDIFFERENCE_CMATRIXFREEEVOLUTIONOPERATOR_H_
+
+#include <array>
+#include <memory>
+#include <stddef.h>
+
+#include <FiniteDifference/CEvolutionOperator.h>
+#include <FiniteDifference/CStencilWeights.h>
+#include <FiniteDifference/CGrid.h>
+#include <Data/CInputData.h>
+#include <Data/CPayoffData.h>
+#include <Data/ESolverType.h>
+#include <Data/EPrecision.h>
+#include <Flags.h>
+
+namespace fdpricing
+{
+
+/**
+ * Drop-in replacement of CEvolutionOperator that does not store the tridiagonal matrices (and their Jacobians):
+ * only the stencil weights of the grid and the Thomas factors are kept, while the coefficients are computed from sigma, b and dt within the sweeps.
+ * It reads 6 arrays per step instead of up to 27, which pays off once the assembled operators do not fit in cache anymore.
+ *
+ * fixedN, precision: see CTridiagonalOperator
+ */
+template<ESolverType solverType=ESolverType::CrankNicolson,
+		EGridType gridType=EGridType::Adaptive,
+		EAdjointDifferentiation adjointDifferentiation=EAdjointDifferentiation::All,
+		size_t fixedN=0,
+		EPrecision precision=EPrecision::Double>
+class CMatrixFreeEvolutionOperator
+{
+public:
+	typedef typename details::CPrecisionTraits<precision>::Value Value;
+	typedef typename details::CPrecisionTraits<precision>::Factor Factor;
+	typedef typename CPayoffDataSelector<fixedN, Value>::Type PayoffData;
+
+	CMatrixFreeEvolutionOperator(const CInputData& unaliased input, const CFiniteDifferenceSettings& unaliased settings) noexcept;
+
+	/**
+	 * Operator for input on the grid of rhs, which has to be built with the same S and N (see CFDPricer::Reprice): grid and stencil weights are shared
+	 */
+	CMatrixFreeEvolutionOperator(const CInputData& unaliased input, const CMatrixFreeEvolutionOperator& unaliased rhs, const CFiniteDifferenceSettings& unaliased settings) noexcept;
+
+	/**
+	 * Pseudo copy constructor: the copy is allowed only if dt needs to change (e.g. when a dividend occurs between time grid points).
+	 * Grid and stencil weights are shared with rhs, rather than copied
+	 */
+	CMatrixFreeEvolutionOperator(const CMatrixFreeEvolutionOperator& rhs, const double dt) noexcept;
+
+	virtual ~CMatrixFreeEvolutionOperator() = default;
+
+	/**
+	 * Make this class not copy-/move-able
+	 */
+	CMatrixFreeEvolutionOperator(const CMatrixFreeEvolutionOperator& rhs) = delete;
+	CMatrixFreeEvolutionOperator(const CMatrixFreeEvolutionOperator&& rhs) = delete;
+	CMatrixFreeEvolutionOperator& operator=(const CMatrixFreeEvolutionOperator& rhs) = delete;
+	CMatrixFreeEvolutionOperator& operator=(const CMatrixFreeEvolutionOperator&& rhs) = delete;
+
+	/**
+	 * See CEvolutionOperator::Apply
+	 */
+	void Apply(PayoffData& unaliased x) const noexcept;
+
+	template<size_t nRhs>
+	void Apply(const std::array<PayoffData*, nRhs>& unaliased x) const noexcept;
+
+	/**
+	 * No active window: the whole grid is updated, which is always consistent
+	 */
+	template<size_t nRhs>
+	void Apply(const std::array<PayoffData*, nRhs>& unaliased x, const details::CActiveWindow<Factor>& unaliased window) const noexcept;
+	void Factorize(const size_t begin, const size_t end, Factor* unaliased upperFactor, Factor* unaliased inversePivot) const noexcept;
+
+	/**
+	 * No Brennan-Schwartz: the solves are unconstrained, and the early exercise is left to the caller (see CFDPricer)
+	 */
+	template<size_t nRhs>
+	void Apply(const std::array<PayoffData*, nRhs>& unaliased x, const details::CExerciseCondition<Value, nRhs>& unaliased exercise) const noexcept;
+
+	/**
+	 * Not blocked: the stencil weights are recomputed on the fly, so there's little memory traffic to save. The tile is the whole grid
+	 */
+	template<size_t nRhs, typename PostStep>
+	void Apply(const std::array<PayoffData*, nRhs>& unaliased x, const size_t nSteps, const size_t tileSize, Value* unaliased buffer, PostStep&& postStep) const noexcept;
+
+	/**
+	 * No cyclic reduction: the Thomas factors are the only ones
+	 */
+	template<size_t nRhs>
+	void Apply(const std::array<PayoffData*, nRhs>& unaliased x, Value* unaliased buffer) const noexcept;
+
+	bool HasCyclicReduction() const noexcept
+	{
+		return false;
+	}
+
+	/**
+	 * No exercise within the solves: the early exercise is projected
+	 */
+	bool HasBrennanSchwartz() const noexcept
+	{
+		return false;
+	}
+
+	/**
+	 * Not partitioned: the only partition is the whole grid, updated by the first thread
+	 */
+	template<size_t nRhs>
+	void Apply(const std::array<PayoffData*, nRhs>& unaliased x, const size_t p, details::CThreadTeam& team, Value* unaliased buffer) const noexcept;
+
+	size_t GetPartitions() const noexcept
+	{
+		return 1;
+	}
+
+	size_t GetPartitionBegin(const size_t p) const noexcept
+	{
+		return p == 0 ? 0 : grid->size();
+	}
+
+	const CGrid<gridType>& GetGrid() const noexcept
+	{
+		return *grid;
+	}
+
+	double GetDt() const noexcept
+	{
+		return dt;
+	}
+
+	double GetDiscountFactor() const noexcept
+	{
+		return discountFactor;
+	}
+
+	/**
+	 * See CEvolutionOperator::IsBuiltFor
+	 */
+	bool IsBuiltFor(const CInputData& unaliased input) const noexcept
+	{
+		return sigma == Value(input.sigma) && b == Value(input.b) && r == input.r && dt == input.T / input.M;
+	}
+
+private:
+	static constexpr bool hasRho = adjointDifferentiation == EAdjointDifferentiation::Rho || adjointDifferentiation == EAdjointDifferentiation::All;
+	static constexpr bool hasVega = adjointDifferentiation == EAdjointDifferentiation::Vega || adjointDifferentiation == EAdjointDifferentiation::All;
+
+	/**
+	 * Vectors per input: payoff and rho do not need any Jacobian correction, vega and rho borrow do.
+	 * They are laid out as [payoffs | rho's | vega's | rho borrow's]
+	 */
+	static constexpr size_t nUncoupledVectors = hasRho ? 2 : 1;
+	static constexpr size_t nVectors = nUncoupledVectors + (hasVega ? 1 : 0) + (hasRho ? 1 : 0);
+
+	/**
+	 * alpha * I + beta * L
+	 */
+	struct COperator
+	{
+		Value alpha = Value(0.0);
+		Value beta = Value(0.0);
+	};
+
+	/**
+	 * Coefficients of a row of an operator and of its Jacobians w.r.t. sigma and b
+	 */
+	struct CRow
+	{
+		Value sub, diag, super;
+		Value vegaSub, vegaDiag, vegaSuper;
+		Value rhoBorrowSub, rhoBorrowDiag, rhoBorrowSuper;
+	};
+
+	const std::shared_ptr<const CGrid<gridType>> grid;
+	const Value sigma;
+	const Value b;
+
+	const double dt;
+	const double r;
+	const double discountFactor;
+
+	std::shared_ptr<const details::CStencilWeights<Value, fixedN>> weights;
+	COperator A; // right operator
+	COperator B; // left operator
+
+	/**
+	 * Thomas Algorithm factors of A: c'_i and 1 / (b_i - a_i * c'_{i - 1})
+	 */
+	details::Storage<Value, fixedN> upperFactor;
+	details::Storage<Value, fixedN> inversePivot;
+
+	void ctor() noexcept;
+	void Factorize() noexcept;
+
+	/**
+	 * Compute the i-th row of op
+	 */
+	inline void GetRow(CRow& unaliased row, const COperator& unaliased op, const size_t i) const noexcept;
+
+	/**
+	 * Right boundary row: as in CTridiagonalOperator, the vega Jacobian has no sub-diagonal there
+	 */
+	inline void GetLastRow(CRow& unaliased row, const COperator& unaliased op) const noexcept;
+
+	/**
+	 * out = op \cdot x at the row whose stencil values are previous, current and next
+	 */
+	template<size_t nRhs>
+	inline void Dot(std::array<Value, nRhs * nVectors>& unaliased out, const CRow& unaliased row,
+			const std::array<Value, nRhs * nVectors>& unaliased previous, const std::array<Value, nRhs * nVectors>& unaliased current, const std::array<Value, nRhs * nVectors>& unaliased next) const noexcept;
+
+	template<size_t nRhs>
+	void SetVectors(std::array<Value*, nRhs * nVectors>& unaliased x, const std::array<PayoffData*, nRhs>& unaliased payoffData) const noexcept;
+
+	/**
+	 * x = A \cdot x
+	 */
+	template<size_t nRhs>
+	void Dot(const std::array<Value*, nRhs * nVectors>& unaliased x) const noexcept;
+
+	/**
+	 * x = A^{-1} \cdot x, where the rhs of the coupled tangents is corrected with - J_A \cdot payoff, once the payoff is known
+	 */
+	template<size_t nRhs>
+	void Solve(const std::array<Value*, nRhs * nVectors>& unaliased x) const noexcept;
+
+	/**
+	 * x = A^{-1} \cdot B \cdot x: B \cdot x (and J_B \cdot payoff) is computed during the forward substitution
+	 */
+	template<size_t nRhs>
+	void DotSolve(const std::array<Value*, nRhs * nVectors>& unaliased x) const noexcept;
+
+	/**
+	 * Forward substitution of the coupled tangents with rhs - J_A \cdot payoff, given the forward substituted rhs
+	 */
+	template<size_t nRhs>
+	void ForwardSubstituteJacobians(const std::array<Value*, nRhs * nVectors>& unaliased x) const noexcept;
+
+	void BackSubstitute(Value* unaliased x) const noexcept;
+};
+
+} /* namespace fdpricing */
+
+#include <FiniteDifference/CMatrixFreeEvolutionOperator.tpp>
+
+#endif /* FINITEDIFFERENCE_CMATRIXFREEEVOLUTIONOPERATOR_H_ */
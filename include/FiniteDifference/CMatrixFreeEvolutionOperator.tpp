@@ -0,0 +1,434 @@
+/*
+ * CMatrixFreeEvolutionOperator.tpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#include <cmath>
+
+#include <Flags.h>
+
+namespace fdpricing
+{
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::CMatrixFreeEvolutionOperator(const CInputData& unaliased input, const CFiniteDifferenceSettings& unaliased settings) noexcept
+	: grid(details::MakeShared<const CGrid<gridType>>(input.S, settings.lowerFactor * input.S, settings.upperFactor * input.S, input.N)),
+	  sigma(input.sigma),
+	  b(input.b),
+	  dt(input.T / input.M),
+	  r(input.r),
+	  discountFactor(exp(-r * dt))
+{
+	auto weights = details::MakeShared<details::CStencilWeights<Value, fixedN>>();
+	weights->Assign(grid->GetStencilWeights(), grid->size());
+	this->weights = weights;
+
+	ctor();
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::CMatrixFreeEvolutionOperator(const CInputData& unaliased input, const CMatrixFreeEvolutionOperator& unaliased rhs,
+		const CFiniteDifferenceSettings& unaliased) noexcept
+	: grid(rhs.grid),
+	  sigma(input.sigma),
+	  b(input.b),
+	  dt(input.T / input.M),
+	  r(input.r),
+	  discountFactor(exp(-r * dt)),
+	  weights(rhs.weights)
+{
+	ctor();
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::CMatrixFreeEvolutionOperator(const CMatrixFreeEvolutionOperator& rhs, const double dt) noexcept
+	: grid(rhs.grid), sigma(rhs.sigma), b(rhs.b), dt(dt), r(rhs.r), discountFactor(exp(-r * dt)), weights(rhs.weights)
+{
+	ctor();
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::ctor() noexcept
+{
+	// Same operators as CEvolutionOperator, with the discount factor folded in
+	switch (solverType)
+	{
+		case ESolverType::ExplicitEuler:
+			A.alpha = Value(discountFactor);
+			A.beta = Value(discountFactor * dt);
+			break;
+		case ESolverType::ImplicitEuler:
+			A.alpha = Value(1.0 / discountFactor);
+			A.beta = Value(-dt / discountFactor);
+			Factorize();
+			break;
+		case ESolverType::CrankNicolson:
+			A.alpha = Value(1.0);
+			A.beta = Value(-.5 * dt);
+			Factorize();
+			B.alpha = Value(discountFactor);
+			B.beta = Value(.5 * dt * discountFactor);
+			break;
+		default:
+			break;
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Factorize() noexcept
+{
+	const size_t N = fixedN ? fixedN : grid->size();
+	upperFactor.resize(details::Padded<Value>(N));
+	inversePivot.resize(details::Padded<Value>(N));
+
+	CRow row;
+	GetRow(row, A, 0);
+	inversePivot[0] = Value(1.0) / row.diag;
+	upperFactor[0] = row.super * inversePivot[0];
+	for (size_t i = 1; i < N; ++i)
+	{
+		GetRow(row, A, i);
+		inversePivot[i] = Value(1.0) / (row.diag - row.sub * upperFactor[i - 1]);
+		upperFactor[i] = row.super * inversePivot[i];
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+inline void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::GetRow(CRow& unaliased row, const COperator& unaliased op, const size_t i) const noexcept
+{
+	const Value sigma2 = sigma * sigma;
+	row.sub   = op.beta * (sigma2 * weights->volatilitySub[i]   - b * weights->driftSub[i]);
+	row.super = op.beta * (sigma2 * weights->volatilitySuper[i] + b * weights->driftSuper[i]);
+	row.diag  = op.alpha - row.sub - row.super;
+
+	if (hasVega)
+	{
+		const Value dVolDSigma = Value(2.0) * sigma * op.beta;
+		row.vegaSub   = dVolDSigma * weights->volatilitySub[i];
+		row.vegaSuper = dVolDSigma * weights->volatilitySuper[i];
+		row.vegaDiag  = -row.vegaSub - row.vegaSuper;
+	}
+
+	if (hasRho)
+	{
+		row.rhoBorrowSub   = -op.beta * weights->driftSub[i];
+		row.rhoBorrowSuper =  op.beta * weights->driftSuper[i];
+		row.rhoBorrowDiag  = -row.rhoBorrowSub - row.rhoBorrowSuper;
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+inline void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::GetLastRow(CRow& unaliased row, const COperator& unaliased op) const noexcept
+{
+	GetRow(row, op, (fixedN ? fixedN : grid->size()) - 1);
+	row.vegaSub = Value(0.0);
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+inline void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Dot(std::array<Value, nRhs * nVectors>& unaliased out, const CRow& unaliased row,
+		const std::array<Value, nRhs * nVectors>& unaliased previous, const std::array<Value, nRhs * nVectors>& unaliased current, const std::array<Value, nRhs * nVectors>& unaliased next) const noexcept
+{
+	for (size_t k = 0; k < nRhs * nVectors; ++k)
+		out[k] = row.sub * previous[k] + row.diag * current[k] + row.super * next[k];
+
+	// Jacobian terms: the first nRhs vectors are the payoffs
+	size_t offset = nRhs * nUncoupledVectors;
+	if (hasVega)
+	{
+		for (size_t j = 0; j < nRhs; ++j)
+			out[offset + j] += row.vegaSub * previous[j] + row.vegaDiag * current[j] + row.vegaSuper * next[j];
+		offset += nRhs;
+	}
+	if (hasRho)
+	{
+		for (size_t j = 0; j < nRhs; ++j)
+			out[offset + j] += row.rhoBorrowSub * previous[j] + row.rhoBorrowDiag * current[j] + row.rhoBorrowSuper * next[j];
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::SetVectors(std::array<Value*, nRhs * nVectors>& unaliased x, const std::array<PayoffData*, nRhs>& unaliased payoffData) const noexcept
+{
+	size_t offset = 0;
+	for (size_t j = 0; j < nRhs; ++j)
+		x[offset + j] = payoffData[j]->payoff_i.data();
+	offset += nRhs;
+
+	if (hasRho)
+	{
+		for (size_t j = 0; j < nRhs; ++j)
+			x[offset + j] = payoffData[j]->rho_i.data();
+		offset += nRhs;
+	}
+	if (hasVega)
+	{
+		for (size_t j = 0; j < nRhs; ++j)
+			x[offset + j] = payoffData[j]->vega_i.data();
+		offset += nRhs;
+	}
+	if (hasRho)
+	{
+		for (size_t j = 0; j < nRhs; ++j)
+			x[offset + j] = payoffData[j]->rhoBorrow_i.data();
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Apply(PayoffData& unaliased x) const noexcept
+{
+	Apply(std::array<PayoffData*, 1> { { &x } });
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Apply(const std::array<PayoffData*, nRhs>& unaliased payoffData) const noexcept
+{
+	std::array<Value*, nRhs * nVectors> x;
+	SetVectors<nRhs>(x, payoffData);
+
+	switch (solverType)
+	{
+		case ESolverType::ExplicitEuler:
+			Dot<nRhs>(x);
+			break;
+		case ESolverType::ImplicitEuler:
+			Solve<nRhs>(x);
+			break;
+		case ESolverType::CrankNicolson:
+			DotSolve<nRhs>(x);
+			break;
+		default:
+			break;
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Apply(const std::array<PayoffData*, nRhs>& unaliased x,
+		const details::CActiveWindow<Factor>&) const noexcept
+{
+	Apply(x);
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Factorize(const size_t, const size_t, Factor*, Factor*) const noexcept
+{
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Apply(const std::array<PayoffData*, nRhs>& unaliased x,
+		const details::CExerciseCondition<Value, nRhs>&) const noexcept
+{
+	Apply(x);
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Apply(const std::array<PayoffData*, nRhs>& unaliased x, Value* unaliased) const noexcept
+{
+	Apply(x);
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Apply(const std::array<PayoffData*, nRhs>& unaliased x, const size_t p,
+		details::CThreadTeam&, Value* unaliased) const noexcept
+{
+	if (p == 0)
+		Apply(x);
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs, typename PostStep>
+void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Apply(const std::array<PayoffData*, nRhs>& unaliased x, const size_t nSteps, const size_t,
+		Value*, PostStep&& postStep) const noexcept
+{
+	const auto tile = details::WholeTile<Value>(x);
+	for (size_t step = 0; step < nSteps; ++step)
+	{
+		Apply(x);
+		postStep(tile, step);
+	}
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Dot(const std::array<Value*, nRhs * nVectors>& unaliased x) const noexcept
+{
+	constexpr size_t K = nRhs * nVectors;
+	const size_t N = fixedN ? fixedN : grid->size();
+
+	// the old values are needed by the next row: keep the stencil in registers
+	std::array<Value, K> previous, current, next, out;
+	previous.fill(Value(0.0));
+	for (size_t k = 0; k < K; ++k)
+		current[k] = x[k][0];
+
+	CRow row;
+	for (size_t i = 0; i < N - 1; ++i)
+	{
+		for (size_t k = 0; k < K; ++k)
+			next[k] = x[k][i + 1];
+
+		GetRow(row, A, i);
+		Dot<nRhs>(out, row, previous, current, next);
+		for (size_t k = 0; k < K; ++k)
+			x[k][i] = out[k];
+
+		previous = current;
+		current = next;
+	}
+
+	next.fill(Value(0.0));
+	GetLastRow(row, A);
+	Dot<nRhs>(out, row, previous, current, next);
+	for (size_t k = 0; k < K; ++k)
+		x[k][N - 1] = out[k];
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::Solve(const std::array<Value*, nRhs * nVectors>& unaliased x) const noexcept
+{
+	constexpr size_t K = nRhs * nVectors;
+	const size_t N = fixedN ? fixedN : grid->size();
+
+	// Forward substitution of all the rhs's: the Jacobian correction is added later, as it depends on the updated payoff
+	for (size_t k = 0; k < K; ++k)
+		x[k][0] *= inversePivot[0];
+
+	CRow row;
+	for (size_t i = 1; i < N; ++i)
+	{
+		GetRow(row, A, i);
+		for (size_t k = 0; k < K; ++k)
+			x[k][i] = (x[k][i] - row.sub * x[k][i - 1]) * inversePivot[i];
+	}
+
+	for (size_t k = 0; k < nRhs * nUncoupledVectors; ++k)
+		BackSubstitute(x[k]);
+
+	ForwardSubstituteJacobians<nRhs>(x);
+	for (size_t k = nRhs * nUncoupledVectors; k < K; ++k)
+		BackSubstitute(x[k]);
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::DotSolve(const std::array<Value*, nRhs * nVectors>& unaliased x) const noexcept
+{
+	constexpr size_t K = nRhs * nVectors;
+	const size_t N = fixedN ? fixedN : grid->size();
+
+	// B \cdot x is computed with the old values, while x is overwritten with the forward substitution
+	std::array<Value, K> previous, current, next, out;
+	previous.fill(Value(0.0));
+	for (size_t k = 0; k < K; ++k)
+	{
+		current[k] = x[k][0];
+		next[k] = x[k][1];
+	}
+
+	CRow row;
+	GetRow(row, B, 0);
+	Dot<nRhs>(out, row, previous, current, next);
+	for (size_t k = 0; k < K; ++k)
+		x[k][0] = out[k] * inversePivot[0];
+
+	for (size_t i = 1; i < N - 1; ++i)
+	{
+		previous = current;
+		current = next;
+		for (size_t k = 0; k < K; ++k)
+			next[k] = x[k][i + 1];
+
+		GetRow(row, B, i);
+		Dot<nRhs>(out, row, previous, current, next);
+
+		GetRow(row, A, i);
+		for (size_t k = 0; k < K; ++k)
+			x[k][i] = (out[k] - row.sub * x[k][i - 1]) * inversePivot[i];
+	}
+
+	previous = current;
+	current = next;
+	next.fill(Value(0.0));
+	GetLastRow(row, B);
+	Dot<nRhs>(out, row, previous, current, next);
+
+	GetRow(row, A, N - 1);
+	for (size_t k = 0; k < K; ++k)
+		x[k][N - 1] = (out[k] - row.sub * x[k][N - 2]) * inversePivot[N - 1];
+
+	for (size_t k = 0; k < nRhs * nUncoupledVectors; ++k)
+		BackSubstitute(x[k]);
+
+	ForwardSubstituteJacobians<nRhs>(x);
+	for (size_t k = nRhs * nUncoupledVectors; k < K; ++k)
+		BackSubstitute(x[k]);
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::ForwardSubstituteJacobians(const std::array<Value*, nRhs * nVectors>& unaliased x) const noexcept
+{
+	constexpr size_t K = nRhs * nVectors;
+	constexpr size_t nCoupled = K - nRhs * nUncoupledVectors;
+	if (!nCoupled)
+		return;
+
+	const size_t N = fixedN ? fixedN : grid->size();
+
+	// F(-J_A \cdot payoff): the payoff stencil is taken from the updated (i.e. back substituted) payoff
+	// only the Jacobian terms are needed: the coupled vectors do not enter the product, hence they are left to 0
+	std::array<Value, K> previous, current, next, out, forward;
+	previous.fill(Value(0.0));
+	current.fill(Value(0.0));
+	next.fill(Value(0.0));
+	forward.fill(Value(0.0));
+	for (size_t j = 0; j < nRhs; ++j)
+		current[j] = x[j][0];
+
+	CRow row;
+	for (size_t i = 0; i < N - 1; ++i)
+	{
+		for (size_t j = 0; j < nRhs; ++j)
+			next[j] = x[j][i + 1];
+
+		GetRow(row, A, i);
+		Dot<nRhs>(out, row, previous, current, next);
+		for (size_t k = nRhs * nUncoupledVectors; k < K; ++k)
+		{
+			forward[k] = (-out[k] - row.sub * forward[k]) * inversePivot[i];
+			x[k][i] += forward[k];
+		}
+
+		for (size_t j = 0; j < nRhs; ++j)
+		{
+			previous[j] = current[j];
+			current[j] = next[j];
+		}
+	}
+
+	for (size_t j = 0; j < nRhs; ++j)
+		next[j] = Value(0.0);
+	GetLastRow(row, A);
+	Dot<nRhs>(out, row, previous, current, next);
+	for (size_t k = nRhs * nUncoupledVectors; k < K; ++k)
+		x[k][N - 1] += (-out[k] - row.sub * forward[k]) * inversePivot[N - 1];
+}
+
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CMatrixFreeEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision>::BackSubstitute(Value* unaliased x) const noexcept
+{
+	const size_t N = fixedN ? fixedN : grid->size();
+	for (size_t i = N - 1; i-- > 0;)
+		x[i] -= upperFactor[i] * x[i + 1];
+}
+
+}
@@ -0,0 +1,371 @@
+/*
+ * COperatorRegistry.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef FINITEDIFFERENCE_COPERATORREGISTRY_H_
+#define FINITEDIFFERENCE_COPERATORREGISTRY_H_
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <limits>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <FiniteDifference/CEvolutionOperator.h>
+#include <Data/CInputData.h>
+#include <Utilities/CArena.h>
+#include <Flags.h>
+
+namespace details
+{
+
+/**
+ * Hash of the doubles and sizes in a registry key
+ */
+struct CHashCombiner
+{
+	size_t value = 0;
+
+	template<typename T>
+	CHashCombiner& operator()(const T& x) noexcept
+	{
+		value ^= std::hash<T>()(x) + 0x9e3779b97f4a7c15ull + (value << 6) + (value >> 2);
+		return *this;
+	}
+};
+
+}
+
+namespace fdpricing
+{
+
+/**
+ * Thread-safe registry of immutable evolution operators, shared by all the pricers whose input yields the same operator:
+ * 	- grids are shared by the inputs with the same S, N and grid bounds
+ * 	- space discretizations (L) are shared by the inputs with the same grid, sigma and b
+ * 	- evolution operators (i.e. factorized A and B) are shared by the inputs with the same L, r and dt
+ *
+ * Reads are lock-free: they look up an immutable snapshot of the registry, which is replaced (copy on write) under a lock by the insertions.
+ * Each thread keeps the last snapshot it read, and takes the lock only when the version of the registry tells it's been replaced since.
+ * Hence a replaced snapshot is released by a thread only at its next read (or when it exits).
+ *
+ * Once full, the least recently used operator is evicted: pricers holding it are not affected, as it is reference counted.
+ * Usage is tracked per snapshot rather than per read, so that the readers of a hot operator do not keep writing to the same cache line:
+ * a read stamps the entry with the version of the snapshot, which it writes only if the entry was not stamped since that version was published.
+ *
+ * Operators are always built on the heap, as they outlive the arena of the thread that asks for them first.
+ */
+template<ESolverType solverType=ESolverType::CrankNicolson,
+		EGridType gridType=EGridType::Adaptive,
+		EAdjointDifferentiation adjointDifferentiation=EAdjointDifferentiation::All,
+		size_t fixedN=0,
+		EPrecision precision=EPrecision::Double>
+class COperatorRegistry
+{
+public:
+	typedef CEvolutionOperator<solverType, gridType, adjointDifferentiation, fixedN, precision> Operator;
+	typedef typename Operator::TridiagonalOperator TridiagonalOperator;
+
+	/**
+	 * capacity: max number of evolution operators, at least 1
+	 */
+	explicit COperatorRegistry(const size_t capacity) noexcept
+		: capacity(std::max<size_t>(capacity, 1)), id(NextId()), snapshot(std::make_shared<const Map>())
+	{
+	}
+
+	COperatorRegistry(const COperatorRegistry& rhs) = delete;
+	COperatorRegistry& operator=(const COperatorRegistry& rhs) = delete;
+
+	/**
+	 * The operator for input and settings: it's built if it's not registered yet
+	 */
+	std::shared_ptr<const Operator> Get(const CInputData& unaliased input, const CFiniteDifferenceSettings& unaliased settings) noexcept
+	{
+		const CKey key(input, settings);
+		const CReader& reader = Read();
+		const auto it = reader.map->find(key);
+		if (it != reader.map->end())
+		{
+			Touch(*it->second, reader.version);
+			return it->second->u;
+		}
+
+		std::lock_guard<std::mutex> lock(writeMutex);
+		details::CArenaScope heap(nullptr);
+		std::shared_ptr<Map> newMap = std::make_shared<Map>(*snapshot);
+		const auto u = Insert(*newMap, key, input, settings);
+		Publish(std::move(newMap));
+
+		return u;
+	}
+
+	/**
+	 * Build the operators of all the inputs (e.g. the whole portfolio, before the market opens): the snapshot is replaced only once.
+	 * If there are more distinct operators than the capacity, only the last ones are kept
+	 */
+	void Prewarm(const std::vector<CInputData>& unaliased inputs, const CFiniteDifferenceSettings& unaliased settings) noexcept
+	{
+		std::lock_guard<std::mutex> lock(writeMutex);
+		details::CArenaScope heap(nullptr);
+		std::shared_ptr<Map> newMap = std::make_shared<Map>(*snapshot);
+		for (const auto& input : inputs)
+			Insert(*newMap, CKey(input, settings), input, settings);
+		Publish(std::move(newMap));
+	}
+
+	size_t size() const noexcept
+	{
+		std::lock_guard<std::mutex> lock(writeMutex);
+		return snapshot->size();
+	}
+
+	void Clear() noexcept
+	{
+		std::lock_guard<std::mutex> lock(writeMutex);
+		Publish(std::make_shared<Map>());
+		grids.clear();
+		spaceDiscretizations.clear();
+	}
+
+private:
+	struct CGridKey
+	{
+		double S;
+		double lowerFactor;
+		double upperFactor;
+		size_t N;
+
+		CGridKey(const CInputData& unaliased input, const CFiniteDifferenceSettings& unaliased settings) noexcept
+			: S(input.S), lowerFactor(settings.lowerFactor), upperFactor(settings.upperFactor), N(input.N)
+		{
+		}
+
+		bool operator==(const CGridKey& rhs) const noexcept
+		{
+			return S == rhs.S && lowerFactor == rhs.lowerFactor && upperFactor == rhs.upperFactor && N == rhs.N;
+		}
+
+		size_t Hash() const noexcept
+		{
+			return details::CHashCombiner()(S)(lowerFactor)(upperFactor)(N).value;
+		}
+	};
+
+	struct CSpaceKey
+	{
+		CGridKey grid;
+		double sigma;
+		double b;
+
+		CSpaceKey(const CInputData& unaliased input, const CFiniteDifferenceSettings& unaliased settings) noexcept
+			: grid(input, settings), sigma(input.sigma), b(input.b)
+		{
+		}
+
+		bool operator==(const CSpaceKey& rhs) const noexcept
+		{
+			return grid == rhs.grid && sigma == rhs.sigma && b == rhs.b;
+		}
+
+		size_t Hash() const noexcept
+		{
+			return details::CHashCombiner()(grid.Hash())(sigma)(b).value;
+		}
+	};
+
+	/**
+	 * The settings that shape the operator are part of the key: the partitions, the solver and the exercise within the solves it's built with
+	 * (resolved for its grid), as the pricers run its steps accordingly
+	 */
+	struct CKey
+	{
+		CSpaceKey space;
+		double r;
+		double dt;
+		size_t partitions;
+		bool cyclicReduction;
+		bool brennanSchwartz;
+
+		CKey(const CInputData& unaliased input, const CFiniteDifferenceSettings& unaliased settings) noexcept
+			: space(input, settings), r(input.r), dt(input.T / input.M),
+			  partitions(Operator::Partitions(input.N, settings)), cyclicReduction(Operator::HasCyclicReduction(input.N, settings)),
+			  brennanSchwartz(Operator::HasBrennanSchwartz(settings))
+		{
+		}
+
+		bool operator==(const CKey& rhs) const noexcept
+		{
+			return space == rhs.space && r == rhs.r && dt == rhs.dt
+					&& partitions == rhs.partitions && cyclicReduction == rhs.cyclicReduction && brennanSchwartz == rhs.brennanSchwartz;
+		}
+
+		size_t Hash() const noexcept
+		{
+			return details::CHashCombiner()(space.Hash())(r)(dt)(partitions)(cyclicReduction)(brennanSchwartz).value;
+		}
+	};
+
+	template<typename Key>
+	struct CHash
+	{
+		size_t operator()(const Key& key) const noexcept
+		{
+			return key.Hash();
+		}
+	};
+
+	/**
+	 * lastUsed is the only mutable state of a snapshot: it's updated with relaxed atomics by the readers (see Touch)
+	 */
+	struct CEntry
+	{
+		std::shared_ptr<const Operator> u;
+		mutable std::atomic<uint64_t> lastUsed;
+
+		CEntry(const std::shared_ptr<const Operator>& u, const uint64_t lastUsed) noexcept : u(u), lastUsed(lastUsed) {}
+	};
+
+	typedef std::unordered_map<CKey, std::shared_ptr<const CEntry>, CHash<CKey>> Map;
+
+	/**
+	 * Snapshot last read by a thread, with the version it was published with: one per thread and registry type,
+	 * so a thread reading from several registries of the same type takes the lock whenever it switches between them
+	 */
+	struct CReader
+	{
+		uint64_t registry = 0;
+		uint64_t version = 0;
+		std::shared_ptr<const Map> map;
+	};
+
+	const size_t capacity;
+
+	/**
+	 * Unique across the registries, so that a reader can't mistake a registry for one destroyed before at the same address
+	 */
+	const uint64_t id;
+
+	/**
+	 * Replaced under writeMutex (see Publish), which is also the only place where the clock is advanced:
+	 * each insertion and each publication take the next tick, and version is the tick of the current snapshot
+	 */
+	std::shared_ptr<const Map> snapshot;
+	mutable std::mutex writeMutex;
+	uint64_t clock = 0;
+	std::atomic<uint64_t> version { 0 };
+
+	/**
+	 * Grids and space discretizations are owned by the operators: these are only used for sharing them, under writeMutex
+	 */
+	std::unordered_map<CGridKey, std::weak_ptr<const CGrid<gridType>>, CHash<CGridKey>> grids;
+	std::unordered_map<CSpaceKey, std::weak_ptr<const TridiagonalOperator>, CHash<CSpaceKey>> spaceDiscretizations;
+
+	static uint64_t NextId() noexcept
+	{
+		static std::atomic<uint64_t> lastId { 0 };
+		return lastId.fetch_add(1, std::memory_order_relaxed) + 1;
+	}
+
+	/**
+	 * The snapshot of the calling thread, refreshed under the lock only if it's been replaced
+	 */
+	const CReader& Read() noexcept
+	{
+		static thread_local CReader reader;
+
+		if (reader.registry != id || reader.version != version.load(std::memory_order_acquire))
+		{
+			std::lock_guard<std::mutex> lock(writeMutex);
+			reader.registry = id;
+			reader.version = version.load(std::memory_order_relaxed);
+			reader.map = snapshot;
+		}
+
+		return reader;
+	}
+
+	/**
+	 * Under writeMutex
+	 */
+	void Publish(std::shared_ptr<const Map>&& map) noexcept
+	{
+		snapshot = std::move(map);
+		version.store(++clock, std::memory_order_release);
+	}
+
+	/**
+	 * Written only if it's not been stamped since the snapshot at hand was published, i.e. once per entry and snapshot in the steady state
+	 */
+	static void Touch(const CEntry& unaliased entry, const uint64_t stamp) noexcept
+	{
+		if (entry.lastUsed.load(std::memory_order_relaxed) < stamp)
+			entry.lastUsed.store(stamp, std::memory_order_relaxed);
+	}
+
+	std::shared_ptr<const Operator> Insert(Map& unaliased map, const CKey& unaliased key, const CInputData& unaliased input, const CFiniteDifferenceSettings& unaliased settings) noexcept
+	{
+		// it might have been inserted by another thread in the meantime
+		const auto it = map.find(key);
+		if (it != map.end())
+		{
+			Touch(*it->second, ++clock);
+			return it->second->u;
+		}
+
+		if (map.size() >= capacity)
+			EvictLeastRecentlyUsed(map);
+
+		std::shared_ptr<const CGrid<gridType>> grid = grids[key.space.grid].lock();
+		if (!grid)
+		{
+			grid = std::make_shared<const CGrid<gridType>>(input.S, settings.lowerFactor * input.S, settings.upperFactor * input.S, input.N);
+			grids[key.space.grid] = grid;
+		}
+
+		std::shared_ptr<const TridiagonalOperator> L = spaceDiscretizations[key.space].lock();
+		if (!L)
+		{
+			L = std::make_shared<const TridiagonalOperator>(input, *grid);
+			spaceDiscretizations[key.space] = L;
+		}
+
+		const auto u = std::make_shared<const Operator>(input, grid, L, settings);
+		map.emplace(key, std::make_shared<const CEntry>(u, ++clock));
+
+		return u;
+	}
+
+	void EvictLeastRecentlyUsed(Map& unaliased map) noexcept
+	{
+		auto leastRecentlyUsed = map.begin();
+		uint64_t minLastUsed = std::numeric_limits<uint64_t>::max();
+		for (auto it = map.begin(); it != map.end(); ++it)
+		{
+			const uint64_t lastUsed = it->second->lastUsed.load(std::memory_order_relaxed);
+			if (lastUsed < minLastUsed)
+			{
+				minLastUsed = lastUsed;
+				leastRecentlyUsed = it;
+			}
+		}
+		map.erase(leastRecentlyUsed);
+
+		// drop the grids and the space discretizations that are not used anymore
+		for (auto it = grids.begin(); it != grids.end();)
+			it = it->second.expired() ? grids.erase(it) : std::next(it);
+		for (auto it = spaceDiscretizations.begin(); it != spaceDiscretizations.end();)
+			it = it->second.expired() ? spaceDiscretizations.erase(it) : std::next(it);
+	}
+};
+
+} /* namespace fdpricing */
+
+#endif /* FINITEDIFFERENCE_COPERATORREGISTRY_H_ */
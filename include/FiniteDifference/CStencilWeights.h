@@ -0,0 +1,97 @@
+/*
+ * CStencilWeights.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef FINITEDIFFERENCE_CSTENCILWEIGHTS_H_
+#define FINITEDIFFERENCE_CSTENCILWEIGHTS_H_
+
+#include <stddef.h>
+
+#include <Utilities/CAlignedAllocator.h>
+#include <Utilities/CFixedVector.h>
+#include <Flags.h>
+
+namespace details
+{
+
+/**
+ * Per node weights of the second order uneven mesh finite difference of the Black-Scholes operator, which only depend on the grid
+ * (hence CGrid caches them), so that the operator for any (sigma, b) is an axpy:
+ *
+ * 	sub_i   = sigma^2 * volatilitySub_i   - b * driftSub_i
+ * 	super_i = sigma^2 * volatilitySuper_i + b * driftSuper_i
+ * 	diag_i  = -sub_i - super_i
+ *
+ * The boundary rows have zero drift, hence their drift weights are 0.
+ * The vega and rho borrow Jacobians are 2 * sigma * volatility weights and +/- drift weights respectively
+ */
+template<typename T=double, size_t fixedN=0>
+class CStencilWeights
+{
+public:
+	Storage<T, fixedN> volatilitySub;
+	Storage<T, fixedN> volatilitySuper;
+	Storage<T, fixedN> driftSub;
+	Storage<T, fixedN> driftSuper;
+
+	/**
+	 * Grid: CGrid. It's a template parameter as the grid itself caches its weights
+	 */
+	template<typename Grid>
+	void Make(const Grid& unaliased grid) noexcept
+	{
+		const size_t N = grid.size();
+		volatilitySub.resize(Padded<T>(N), T(0.0));
+		volatilitySuper.resize(Padded<T>(N), T(0.0));
+		driftSub.resize(Padded<T>(N), T(0.0));
+		driftSuper.resize(Padded<T>(N), T(0.0));
+
+		// Left BC: zero drift
+		double dx = grid.Get(1) - grid.Get(0);
+		volatilitySuper[0] = grid.Get(0) * grid.Get(0) / (dx * dx);
+
+		for (size_t i = 1; i < N - 1; ++i)
+		{
+			const double dxPlus  = grid.Get(i + 1) - grid.Get(i);
+			const double dxMinus = grid.Get(i)     - grid.Get(i - 1);
+			const double dx = dxPlus + dxMinus;
+
+			volatilitySub[i]   = grid.Get(i) * grid.Get(i) / (dxMinus * dx);
+			volatilitySuper[i] = grid.Get(i) * grid.Get(i) / (dxPlus  * dx);
+			driftSub[i]   = dxPlus  * grid.Get(i) / (dxMinus * dx);
+			driftSuper[i] = dxMinus * grid.Get(i) / (dxPlus  * dx);
+		}
+
+		// Right BC: zero drift
+		dx = grid.Get(N - 1) - grid.Get(N - 2);
+		volatilitySub[N - 1] = grid.Get(N - 1) * grid.Get(N - 1) / (dx * dx);
+	}
+
+	/**
+	 * Copy the first N weights of rhs, converting them to T
+	 */
+	template<typename U, size_t n>
+	void Assign(const CStencilWeights<U, n>& unaliased rhs, const size_t N) noexcept
+	{
+		Assign(volatilitySub, rhs.volatilitySub, N);
+		Assign(volatilitySuper, rhs.volatilitySuper, N);
+		Assign(driftSub, rhs.driftSub, N);
+		Assign(driftSuper, rhs.driftSuper, N);
+	}
+
+private:
+	template<typename Source>
+	static void Assign(Storage<T, fixedN>& unaliased lhs, const Source& unaliased rhs, const size_t N) noexcept
+	{
+		lhs.resize(Padded<T>(N), T(0.0));
+		for (size_t i = 0; i < N; ++i)
+			lhs[i] = T(rhs[i]);
+	}
+};
+
+}
+
+#endif /* FINITEDIFFERENCE_CSTENCILWEIGHTS_H_ */
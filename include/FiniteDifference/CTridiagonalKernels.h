@@ -0,0 +1,341 @@
+/*
+ * CTridiagonalKernels.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef FINITEDIFFERENCE_CTRIDIAGONALKERNELS_H_
+#define FINITEDIFFERENCE_CTRIDIAGONALKERNELS_H_
+
+#include <array>
+#include <cmath>
+#include <algorithm>
+#include <stddef.h>
+
+#include <Utilities/CSimd.h>
+#include <Utilities/CInstructionSet.h>
+#include <Flags.h>
+
+namespace details
+{
+
+/**
+ * A vector taking part in a multiple right-hand side Dot: if source is set, the Jacobian term J \cdot x_{source} is added to A \cdot x,
+ * where x_{source} is another vector of the same sweep (i.e. its value before the update is used)
+ */
+template<typename T>
+struct CSweepVector
+{
+	static constexpr size_t noSource = static_cast<size_t>(-1);
+
+	T* x = nullptr;
+	size_t source = noSource;
+	const T* jacobianSub = nullptr;
+	const T* jacobianDiag = nullptr;
+	const T* jacobianSuper = nullptr;
+};
+
+/**
+ * Jacobian correction out += factor * J \cdot x
+ */
+template<typename T>
+struct CJacobianTerm
+{
+	T* out = nullptr;
+	const T* x = nullptr;
+	const T* jacobianSub = nullptr;
+	const T* jacobianDiag = nullptr;
+	const T* jacobianSuper = nullptr;
+};
+
+/**
+ * Sizes of the hybrid cyclic reduction working on S rows at a time (see CTridiagonalKernels::CyclicReductionSolve):
+ * its rows (n rounded up to a multiple of S), its levels (log2(S)), its factors and its scratch buffer for K vectors
+ */
+constexpr size_t CyclicReductionRows(const size_t S, const size_t n) noexcept
+{
+	return (n + S - 1) / S * S;
+}
+
+constexpr size_t CyclicReductionLevels(const size_t S) noexcept
+{
+	return S > 1 ? 1 + CyclicReductionLevels(S / 2) : 0;
+}
+
+constexpr size_t CyclicReductionFactorsSize(const size_t S, const size_t n) noexcept
+{
+	return (2 * CyclicReductionLevels(S) + 3) * CyclicReductionRows(S, n);
+}
+
+constexpr size_t CyclicReductionBufferSize(const size_t S, const size_t K, const size_t n) noexcept
+{
+	return 2 * K * (CyclicReductionRows(S, n) + 2 * S);
+}
+
+/**
+ * Explicitly vectorized kernels working on the three diagonals of a tridiagonal matrix.
+ * They only use raw pointers, so that they can be used with any storage.
+ *
+ * Every kernel works on K vectors at once, so that each matrix coefficient is loaded once per sweep.
+ * If fixedN is not 0, it replaces the run time size n, so that all the trip counts are known at compile time
+ */
+template<typename T, typename Pack=CPack<T>, size_t fixedN=0>
+class CTridiagonalKernels
+{
+public:
+	/**
+	 * Compute x_k = A \cdot x_k + J_k \cdot x_{source_k} in place
+	 */
+	template<size_t K>
+	static void Dot(const T* unaliased sub, const T* unaliased diag, const T* unaliased super, const std::array<CSweepVector<T>, K>& unaliased x, const size_t n) noexcept;
+
+	/**
+	 * Compute out_k += factor * J_k \cdot x_k
+	 */
+	template<size_t K>
+	static void Add(const T factor, const std::array<CJacobianTerm<T>, K>& unaliased terms, const size_t n) noexcept;
+
+	/**
+	 * Compute x_k -= left_k * spikeLeft + right_k * spikeRight: the correction of the partition method, where left_k and right_k
+	 * are the separators around the partition (see CTridiagonalOperator::Partition)
+	 */
+	template<size_t K>
+	static void SubtractSpikes(const std::array<T*, K>& unaliased x, const std::array<T, K>& unaliased left, const std::array<T, K>& unaliased right,
+			const T* unaliased spikeLeft, const T* unaliased spikeRight, const size_t n) noexcept;
+
+	/**
+	 * LU factorization for the Thomas algorithm:
+	 *
+	 * 	upper_i = super_i * inversePivot_i
+	 * 	inversePivot_i = 1 / (diag_i - sub_i * upper_{i - 1})
+	 *
+	 * The factors can be stored with a lower precision F than the matrix: they are computed in T anyway
+	 */
+	template<typename F>
+	static void Factorize(F* unaliased upper, F* unaliased inversePivot, const T* unaliased sub, const T* unaliased diag, const T* unaliased super, const size_t n) noexcept;
+
+	/**
+	 * Forward and backward substitution using the factors computed in Factorize
+	 */
+	template<size_t K, typename F>
+	static void Solve(const std::array<T*, K>& unaliased x, const T* unaliased sub, const F* unaliased upper, const F* unaliased inversePivot, const size_t n) noexcept;
+
+	/**
+	 * UL factorization, i.e. the Thomas algorithm going down the grid:
+	 *
+	 * 	lower_i = sub_i * inversePivot_i
+	 * 	inversePivot_i = 1 / (diag_i - super_i * lower_{i + 1})
+	 */
+	template<typename F>
+	static void FactorizeReversed(F* unaliased lower, F* unaliased inversePivot, const T* unaliased sub, const T* unaliased diag, const T* unaliased super, const size_t n) noexcept;
+
+	/**
+	 * Brennan-Schwartz: same as Solve, where the first P vectors are bounded below by sign_k * intrinsic as soon as they are back substituted.
+	 * This solves the linear complementarity problem x_k >= sign_k * intrinsic if the exercise region is attached to the grid boundary the
+	 * back substitution starts from:
+	 * 	- not reversed, the upper one (call): coupling = sub, factor = upper and inversePivot from Factorize
+	 * 	- reversed, the lower one (put): coupling = super, factor = lower and inversePivot from FactorizeReversed
+	 */
+	template<bool reversed, size_t K, size_t P, typename F>
+	static void ProjectedSolve(const std::array<T*, K>& unaliased x, const T* unaliased intrinsic, const std::array<T, P>& unaliased sign,
+			const T* unaliased coupling, const F* unaliased factor, const F* unaliased inversePivot, const size_t n) noexcept;
+
+	/**
+	 * Back substitution of ProjectedSolve, for a right hand side which has already been forward substituted (see DotForwardSubstitute)
+	 */
+	template<bool reversed, size_t K, size_t P, typename F>
+	static void ProjectedBackSubstitute(const std::array<T*, K>& unaliased x, const T* unaliased intrinsic, const std::array<T, P>& unaliased sign,
+			const F* unaliased factor, const size_t n) noexcept;
+
+	/**
+	 * Hybrid of parallel cyclic reduction and Thomas algorithm, which uses the full vector width on a single system.
+	 * Each level of the reduction eliminates the neighbours at distance s of every row, doubling the distance of its couplings:
+	 *
+	 * 	alpha_i = -sub_i / diag_{i - s}, gamma_i = -super_i / diag_{i + s}
+	 * 	x_i += alpha_i * x_{i - s} + gamma_i * x_{i + s}
+	 *
+	 * so that after log2(S) levels the rows i = j mod S make S independent systems. The Thomas algorithm solves them all at once,
+	 * as each of its steps advances S consecutive rows: the recurrences are S times shorter. The rows beyond n are the identity.
+	 *
+	 * factors: CyclicReductionFactorsSize(S, n) elements, laid out as [alpha | gamma] per level, then the Thomas factors of the reduced
+	 * system [sub | upper | inversePivot]. They have the precision of the matrix
+	 */
+	template<size_t S>
+	static void FactorizeCyclicReduction(T* unaliased factors, const T* unaliased sub, const T* unaliased diag, const T* unaliased super, const size_t n) noexcept;
+
+	/**
+	 * Solve with the factors computed in FactorizeCyclicReduction. S has to be a multiple of the pack width.
+	 *
+	 * buffer: scratch memory of (at least) CyclicReductionBufferSize(S, K, n) elements
+	 */
+	template<size_t K, size_t S>
+	static void CyclicReductionSolve(const std::array<T*, K>& unaliased x, const T* unaliased factors, T* unaliased buffer, const size_t n) noexcept;
+
+	/**
+	 * Fused explicit/implicit step: forward substitution of A applied to B \cdot x_k + J_k \cdot x_{source_k}, where the dot product
+	 * is computed on the fly. The backward substitution is left to BackSubstitute.
+	 *
+	 * As in ProjectedSolve, the elimination goes up the grid with the LU factors (coupling = sub), or down the grid with the UL ones
+	 * if reversed (coupling = super): the old value of the neighbour already eliminated is carried along.
+	 */
+	template<bool reversed = false, size_t K, typename F>
+	static void DotForwardSubstitute(const T* unaliased dotSub, const T* unaliased dotDiag, const T* unaliased dotSuper, const std::array<CSweepVector<T>, K>& unaliased x,
+			const T* unaliased coupling, const F* unaliased inversePivot, const size_t n) noexcept;
+
+	/**
+	 * Compute out_k += factor * F(J_k \cdot x_k), where F is the forward substitution of A and the Jacobian product is computed on the fly.
+	 * As F is linear, this corrects a right hand side which has already been forward substituted.
+	 */
+	template<bool reversed = false, size_t K, typename F>
+	static void AddForwardSubstitute(const T factor, const std::array<CJacobianTerm<T>, K>& unaliased terms, const T* unaliased coupling, const F* unaliased inversePivot, const size_t n) noexcept;
+
+	template<bool reversed = false, size_t K, typename F>
+	static void BackSubstitute(const std::array<T*, K>& unaliased x, const F* unaliased factor, const size_t n) noexcept;
+
+private:
+	typedef typename Pack::Type Vector;
+
+	/**
+	 * s-th row in elimination order: up the grid for the LU factors, down the grid for the UL ones
+	 */
+	template<bool reversed>
+	static constexpr size_t Row(const size_t s, const size_t n) noexcept
+	{
+		return reversed ? n - 1 - s : s;
+	}
+
+	/**
+	 * (A \cdot x)_{i}, ..., (A \cdot x)_{i + width - 1} for interior rows
+	 */
+	static inline Vector Row(const T* unaliased sub, const T* unaliased diag, const T* unaliased super, const T* unaliased x, const size_t i) noexcept
+	{
+		return Pack::Load(sub + i) * Pack::Load(x + i - 1) + Pack::Load(diag + i) * Pack::Load(x + i) + Pack::Load(super + i) * Pack::Load(x + i + 1);
+	}
+
+	template<size_t K>
+	static inline void Row(std::array<Vector, K>& unaliased out, const T* unaliased sub, const T* unaliased diag, const T* unaliased super, const std::array<CSweepVector<T>, K>& unaliased x, const size_t i) noexcept
+	{
+		for (size_t k = 0; k < K; ++k)
+		{
+			out[k] = Row(sub, diag, super, x[k].x, i);
+			if (x[k].source != CSweepVector<T>::noSource)
+				out[k] += Row(x[k].jacobianSub, x[k].jacobianDiag, x[k].jacobianSuper, x[x[k].source].x, i);
+		}
+	}
+};
+
+/**
+ * Same interface as CTridiagonalKernels, running the variant compiled for the instruction set picked at startup (see CInstructionSet):
+ * each variant uses the widest packs of its instruction set.
+ * Only Dot, Add, SubtractSpikes and CyclicReductionSolve are data parallel: the factorizations and the substitutions are recurrences, which run the baseline variant,
+ * as wider registers do not help them and the AVX-512 ones even slow them down
+ */
+template<typename T, size_t fixedN=0>
+class CDispatchedTridiagonalKernels
+{
+public:
+	template<size_t K>
+	static void Dot(const T* unaliased sub, const T* unaliased diag, const T* unaliased super, const std::array<CSweepVector<T>, K>& unaliased x, const size_t n) noexcept
+	{
+		CInstructionSet::Dispatch([&](auto instructionSet)
+		{
+			Kernels<decltype(instructionSet)::value>::template Dot<K>(sub, diag, super, x, n);
+		});
+	}
+
+	template<size_t K>
+	static void Add(const T factor, const std::array<CJacobianTerm<T>, K>& unaliased terms, const size_t n) noexcept
+	{
+		CInstructionSet::Dispatch([&](auto instructionSet)
+		{
+			Kernels<decltype(instructionSet)::value>::template Add<K>(factor, terms, n);
+		});
+	}
+
+	template<size_t K>
+	static void SubtractSpikes(const std::array<T*, K>& unaliased x, const std::array<T, K>& unaliased left, const std::array<T, K>& unaliased right,
+			const T* unaliased spikeLeft, const T* unaliased spikeRight, const size_t n) noexcept
+	{
+		CInstructionSet::Dispatch([&](auto instructionSet)
+		{
+			Kernels<decltype(instructionSet)::value>::template SubtractSpikes<K>(x, left, right, spikeLeft, spikeRight, n);
+		});
+	}
+
+	template<typename F>
+	static void Factorize(F* unaliased upper, F* unaliased inversePivot, const T* unaliased sub, const T* unaliased diag, const T* unaliased super, const size_t n) noexcept
+	{
+		Kernels<EInstructionSet::Sse2>::Factorize(upper, inversePivot, sub, diag, super, n);
+	}
+
+	template<size_t K, typename F>
+	static void Solve(const std::array<T*, K>& unaliased x, const T* unaliased sub, const F* unaliased upper, const F* unaliased inversePivot, const size_t n) noexcept
+	{
+		Kernels<EInstructionSet::Sse2>::template Solve<K>(x, sub, upper, inversePivot, n);
+	}
+
+	template<typename F>
+	static void FactorizeReversed(F* unaliased lower, F* unaliased inversePivot, const T* unaliased sub, const T* unaliased diag, const T* unaliased super, const size_t n) noexcept
+	{
+		Kernels<EInstructionSet::Sse2>::FactorizeReversed(lower, inversePivot, sub, diag, super, n);
+	}
+
+	template<bool reversed, size_t K, size_t P, typename F>
+	static void ProjectedSolve(const std::array<T*, K>& unaliased x, const T* unaliased intrinsic, const std::array<T, P>& unaliased sign,
+			const T* unaliased coupling, const F* unaliased factor, const F* unaliased inversePivot, const size_t n) noexcept
+	{
+		Kernels<EInstructionSet::Sse2>::template ProjectedSolve<reversed, K, P>(x, intrinsic, sign, coupling, factor, inversePivot, n);
+	}
+
+	template<bool reversed, size_t K, size_t P, typename F>
+	static void ProjectedBackSubstitute(const std::array<T*, K>& unaliased x, const T* unaliased intrinsic, const std::array<T, P>& unaliased sign,
+			const F* unaliased factor, const size_t n) noexcept
+	{
+		Kernels<EInstructionSet::Sse2>::template ProjectedBackSubstitute<reversed, K, P>(x, intrinsic, sign, factor, n);
+	}
+
+	template<size_t S>
+	static void FactorizeCyclicReduction(T* unaliased factors, const T* unaliased sub, const T* unaliased diag, const T* unaliased super, const size_t n) noexcept
+	{
+		Kernels<EInstructionSet::Sse2>::template FactorizeCyclicReduction<S>(factors, sub, diag, super, n);
+	}
+
+	template<size_t K, size_t S>
+	static void CyclicReductionSolve(const std::array<T*, K>& unaliased x, const T* unaliased factors, T* unaliased buffer, const size_t n) noexcept
+	{
+		CInstructionSet::Dispatch([&](auto instructionSet)
+		{
+			Kernels<decltype(instructionSet)::value>::template CyclicReductionSolve<K, S>(x, factors, buffer, n);
+		});
+	}
+
+	template<bool reversed = false, size_t K, typename F>
+	static void DotForwardSubstitute(const T* unaliased dotSub, const T* unaliased dotDiag, const T* unaliased dotSuper, const std::array<CSweepVector<T>, K>& unaliased x,
+			const T* unaliased coupling, const F* unaliased inversePivot, const size_t n) noexcept
+	{
+		Kernels<EInstructionSet::Sse2>::template DotForwardSubstitute<reversed, K>(dotSub, dotDiag, dotSuper, x, coupling, inversePivot, n);
+	}
+
+	template<bool reversed = false, size_t K, typename F>
+	static void AddForwardSubstitute(const T factor, const std::array<CJacobianTerm<T>, K>& unaliased terms, const T* unaliased coupling, const F* unaliased inversePivot, const size_t n) noexcept
+	{
+		Kernels<EInstructionSet::Sse2>::template AddForwardSubstitute<reversed, K>(factor, terms, coupling, inversePivot, n);
+	}
+
+	template<bool reversed = false, size_t K, typename F>
+	static void BackSubstitute(const std::array<T*, K>& unaliased x, const F* unaliased factor, const size_t n) noexcept
+	{
+		Kernels<EInstructionSet::Sse2>::template BackSubstitute<reversed, K>(x, factor, n);
+	}
+
+private:
+	template<EInstructionSet instructionSet>
+	using Kernels = CTridiagonalKernels<T, CPack<T, CInstructionSetTraits<instructionSet>::registerSize>, fixedN>;
+};
+
+}
+
+#include <FiniteDifference/CTridiagonalKernels.tpp>
+
+#endif /* FINITEDIFFERENCE_CTRIDIAGONALKERNELS_H_ */
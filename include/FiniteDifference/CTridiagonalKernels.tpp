@@ -0,0 +1,476 @@
+/*
+ * CTridiagonalKernels.tpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#include <Flags.h>
+
+namespace details
+{
+
+template<typename T, typename Pack, size_t fixedN>
+template<size_t K>
+void CTridiagonalKernels<T, Pack, fixedN>::Dot(const T* unaliased sub, const T* unaliased diag, const T* unaliased super, const std::array<CSweepVector<T>, K>& unaliased x, const size_t n) noexcept
+{
+	const size_t N = fixedN ? fixedN : n;
+	constexpr size_t W = Pack::width;
+	constexpr size_t noSource = CSweepVector<T>::noSource;
+
+	// the first row can be written only once the second row has been computed
+	std::array<T, K> first;
+	for (size_t k = 0; k < K; ++k)
+	{
+		first[k] = diag[0] * x[k].x[0] + super[0] * x[k].x[1];
+		if (x[k].source != noSource)
+			first[k] += x[k].jacobianDiag[0] * x[x[k].source].x[0] + x[k].jacobianSuper[0] * x[x[k].source].x[1];
+	}
+
+	// the previous (old) values of x, needed by the scalar rows
+	std::array<T, K> previous;
+	for (size_t k = 0; k < K; ++k)
+		previous[k] = x[k].x[0];
+
+	size_t i = 1;
+	if (N - 2 >= W)
+	{
+		// The store of each block is delayed by one iteration, so that the next block still reads the old x_{i - 1}
+		std::array<Vector, K> pending, current;
+		Row(pending, sub, diag, super, x, i);
+		for (size_t k = 0; k < K; ++k)
+			x[k].x[0] = first[k];
+
+		for (i += W; i + W <= N - 1; i += W)
+		{
+			Row(current, sub, diag, super, x, i);
+			for (size_t k = 0; k < K; ++k)
+				Pack::Store(x[k].x + i - W, pending[k]);
+			pending = current;
+		}
+
+		for (size_t k = 0; k < K; ++k)
+			previous[k] = x[k].x[i - 1];
+		for (size_t k = 0; k < K; ++k)
+			Pack::Store(x[k].x + i - W, pending[k]);
+	}
+	else
+	{
+		for (size_t k = 0; k < K; ++k)
+			x[k].x[0] = first[k];
+	}
+
+	std::array<T, K> current;
+	for (; i < N - 1; ++i)
+	{
+		for (size_t k = 0; k < K; ++k)
+			current[k] = x[k].x[i];
+
+		for (size_t k = 0; k < K; ++k)
+		{
+			x[k].x[i] = sub[i] * previous[k] + diag[i] * current[k] + super[i] * x[k].x[i + 1];
+			if (x[k].source != noSource)
+				x[k].x[i] += x[k].jacobianSub[i] * previous[x[k].source] + x[k].jacobianDiag[i] * current[x[k].source] + x[k].jacobianSuper[i] * x[x[k].source].x[i + 1];
+		}
+
+		previous = current;
+	}
+
+	for (size_t k = 0; k < K; ++k)
+		current[k] = x[k].x[N - 1];
+
+	for (size_t k = 0; k < K; ++k)
+	{
+		x[k].x[N - 1] = sub[N - 1] * previous[k] + diag[N - 1] * current[k];
+		if (x[k].source != noSource)
+			x[k].x[N - 1] += x[k].jacobianSub[N - 1] * previous[x[k].source] + x[k].jacobianDiag[N - 1] * current[x[k].source];
+	}
+}
+
+template<typename T, typename Pack, size_t fixedN>
+template<size_t K>
+void CTridiagonalKernels<T, Pack, fixedN>::Add(const T factor, const std::array<CJacobianTerm<T>, K>& unaliased terms, const size_t n) noexcept
+{
+	const size_t N = fixedN ? fixedN : n;
+	constexpr size_t W = Pack::width;
+
+	for (size_t k = 0; k < K; ++k)
+		terms[k].out[0] += factor * (terms[k].jacobianDiag[0] * terms[k].x[0] + terms[k].jacobianSuper[0] * terms[k].x[1]);
+
+	size_t i = 1;
+	const Vector vFactor = Pack::Broadcast(factor);
+	for (; i + W <= N - 1; i += W)
+	{
+		for (size_t k = 0; k < K; ++k)
+			Pack::Store(terms[k].out + i, Pack::Load(terms[k].out + i) + vFactor * Row(terms[k].jacobianSub, terms[k].jacobianDiag, terms[k].jacobianSuper, terms[k].x, i));
+	}
+
+	for (; i < N - 1; ++i)
+	{
+		for (size_t k = 0; k < K; ++k)
+			terms[k].out[i] += factor * (terms[k].jacobianSub[i] * terms[k].x[i - 1] + terms[k].jacobianDiag[i] * terms[k].x[i] + terms[k].jacobianSuper[i] * terms[k].x[i + 1]);
+	}
+
+	for (size_t k = 0; k < K; ++k)
+		terms[k].out[N - 1] += factor * (terms[k].jacobianSub[N - 1] * terms[k].x[N - 2] + terms[k].jacobianDiag[N - 1] * terms[k].x[N - 1]);
+}
+
+template<typename T, typename Pack, size_t fixedN>
+template<size_t K>
+void CTridiagonalKernels<T, Pack, fixedN>::SubtractSpikes(const std::array<T*, K>& unaliased x, const std::array<T, K>& unaliased left, const std::array<T, K>& unaliased right,
+		const T* unaliased spikeLeft, const T* unaliased spikeRight, const size_t n) noexcept
+{
+	const size_t N = fixedN ? fixedN : n;
+	constexpr size_t W = Pack::width;
+
+	// the spikes are loaded once for all the vectors
+	size_t i = 0;
+	for (; i + W <= N; i += W)
+	{
+		const Vector vSpikeLeft = Pack::Load(spikeLeft + i);
+		const Vector vSpikeRight = Pack::Load(spikeRight + i);
+		for (size_t k = 0; k < K; ++k)
+			Pack::Store(x[k] + i, Pack::Load(x[k] + i) - (left[k] * vSpikeLeft + right[k] * vSpikeRight));
+	}
+
+	for (; i < N; ++i)
+	{
+		for (size_t k = 0; k < K; ++k)
+			x[k][i] -= left[k] * spikeLeft[i] + right[k] * spikeRight[i];
+	}
+}
+
+template<typename T, typename Pack, size_t fixedN>
+template<typename F>
+void CTridiagonalKernels<T, Pack, fixedN>::Factorize(F* unaliased upper, F* unaliased inversePivot, const T* unaliased sub, const T* unaliased diag, const T* unaliased super, const size_t n) noexcept
+{
+	const size_t N = fixedN ? fixedN : n;
+	inversePivot[0] = T(1.0) / diag[0];
+	upper[0] = super[0] * inversePivot[0];
+
+	for (size_t i = 1; i < N; ++i)
+	{
+		inversePivot[i] = T(1.0) / (diag[i] - sub[i] * upper[i - 1]);
+		upper[i] = super[i] * inversePivot[i];
+	}
+}
+
+template<typename T, typename Pack, size_t fixedN>
+template<size_t K, typename F>
+void CTridiagonalKernels<T, Pack, fixedN>::Solve(const std::array<T*, K>& unaliased x, const T* unaliased sub, const F* unaliased upper, const F* unaliased inversePivot, const size_t n) noexcept
+{
+	const size_t N = fixedN ? fixedN : n;
+	for (size_t k = 0; k < K; ++k)
+		x[k][0] *= inversePivot[0];
+
+	for (size_t i = 1; i < N; ++i)
+	{
+		for (size_t k = 0; k < K; ++k)
+			x[k][i] = (x[k][i] - sub[i] * x[k][i - 1]) * inversePivot[i];
+	}
+
+	BackSubstitute(x, upper, N);
+}
+
+template<typename T, typename Pack, size_t fixedN>
+template<typename F>
+void CTridiagonalKernels<T, Pack, fixedN>::FactorizeReversed(F* unaliased lower, F* unaliased inversePivot, const T* unaliased sub, const T* unaliased diag, const T* unaliased super, const size_t n) noexcept
+{
+	const size_t N = fixedN ? fixedN : n;
+	inversePivot[N - 1] = T(1.0) / diag[N - 1];
+	lower[N - 1] = sub[N - 1] * inversePivot[N - 1];
+
+	for (size_t i = N - 1; i --> 0 ;)
+	{
+		inversePivot[i] = T(1.0) / (diag[i] - super[i] * lower[i + 1]);
+		lower[i] = sub[i] * inversePivot[i];
+	}
+}
+
+template<typename T, typename Pack, size_t fixedN>
+template<bool reversed, size_t K, size_t P, typename F>
+void CTridiagonalKernels<T, Pack, fixedN>::ProjectedSolve(const std::array<T*, K>& unaliased x, const T* unaliased intrinsic, const std::array<T, P>& unaliased sign,
+		const T* unaliased coupling, const F* unaliased factor, const F* unaliased inversePivot, const size_t n) noexcept
+{
+	const size_t N = fixedN ? fixedN : n;
+
+	size_t i = Row<reversed>(0, N);
+	for (size_t k = 0; k < K; ++k)
+		x[k][i] *= inversePivot[i];
+
+	for (size_t s = 1; s < N; ++s)
+	{
+		const size_t previous = i;
+		i = Row<reversed>(s, N);
+		for (size_t k = 0; k < K; ++k)
+			x[k][i] = (x[k][i] - coupling[i] * x[k][previous]) * inversePivot[i];
+	}
+
+	ProjectedBackSubstitute<reversed>(x, intrinsic, sign, factor, N);
+}
+
+template<typename T, typename Pack, size_t fixedN>
+template<bool reversed, size_t K, size_t P, typename F>
+void CTridiagonalKernels<T, Pack, fixedN>::ProjectedBackSubstitute(const std::array<T*, K>& unaliased x, const T* unaliased intrinsic, const std::array<T, P>& unaliased sign,
+		const F* unaliased factor, const size_t n) noexcept
+{
+	static_assert(P <= K, "Only the solved vectors can be projected");
+
+	const size_t N = fixedN ? fixedN : n;
+
+	// the back substitution starts from the last eliminated row: the exercise condition is applied as soon as each point is final,
+	// so that the points substituted afterwards see the exercised values
+	size_t i = Row<reversed>(N - 1, N);
+	for (size_t k = 0; k < P; ++k)
+		x[k][i] = std::max(x[k][i], sign[k] * intrinsic[i]);
+
+	for (size_t s = N - 1; s --> 0 ;)
+	{
+		const size_t next = i;
+		i = Row<reversed>(s, N);
+		for (size_t k = 0; k < K; ++k)
+			x[k][i] -= factor[i] * x[k][next];
+		for (size_t k = 0; k < P; ++k)
+			x[k][i] = std::max(x[k][i], sign[k] * intrinsic[i]);
+	}
+}
+
+template<typename T, typename Pack, size_t fixedN>
+template<size_t S>
+void CTridiagonalKernels<T, Pack, fixedN>::FactorizeCyclicReduction(T* unaliased factors, const T* unaliased sub, const T* unaliased diag, const T* unaliased super, const size_t n) noexcept
+{
+	const size_t N = fixedN ? fixedN : n;
+	const size_t M = CyclicReductionRows(S, N);
+
+	// the reduced system is built in place of its Thomas factors: a as the sub diagonal, c as the upper factors and b as the inverse pivots
+	T* unaliased a = factors + 2 * CyclicReductionLevels(S) * M;
+	T* unaliased c = a + M;
+	T* unaliased b = c + M;
+	for (size_t i = 0; i < M; ++i)
+	{
+		a[i] = i > 0 && i < N ? sub[i] : T(0.0);
+		b[i] = i < N ? diag[i] : T(1.0);
+		c[i] = i + 1 < N ? super[i] : T(0.0);
+	}
+
+	T* unaliased alpha = factors;
+	for (size_t s = 1; s < S; s *= 2, alpha += 2 * M)
+	{
+		T* unaliased gamma = alpha + M;
+		for (size_t i = 0; i < M; ++i)
+		{
+			alpha[i] = i >= s ? -a[i] / b[i - s] : T(0.0);
+			gamma[i] = i + s < M ? -c[i] / b[i + s] : T(0.0);
+		}
+
+		// in place, each diagonal being swept in the direction that reads the rows not updated yet
+		for (size_t i = 0; i < M; ++i)
+			b[i] += (i >= s ? alpha[i] * c[i - s] : T(0.0)) + (i + s < M ? gamma[i] * a[i + s] : T(0.0));
+		for (size_t i = M; i --> 0 ;)
+			a[i] = i >= s ? alpha[i] * a[i - s] : T(0.0);
+		for (size_t i = 0; i < M; ++i)
+			c[i] = i + s < M ? gamma[i] * c[i + s] : T(0.0);
+	}
+
+	// see Factorize, row i being coupled to the rows i - S and i + S
+	for (size_t i = 0; i < M; ++i)
+	{
+		b[i] = T(1.0) / (i >= S ? b[i] - a[i] * c[i - S] : b[i]);
+		c[i] *= b[i];
+	}
+}
+
+template<typename T, typename Pack, size_t fixedN>
+template<size_t K, size_t S>
+void CTridiagonalKernels<T, Pack, fixedN>::CyclicReductionSolve(const std::array<T*, K>& unaliased x, const T* unaliased factors, T* unaliased buffer, const size_t n) noexcept
+{
+	constexpr size_t W = Pack::width;
+	static_assert(S % W == 0, "A step of the reduced system must be a whole number of packs");
+
+	const size_t N = fixedN ? fixedN : n;
+	const size_t M = CyclicReductionRows(S, N);
+	const size_t stride = M + 2 * S;
+
+	// each level reads a buffer and writes the other one: both have S zeros on each side, standing for the rows beyond the grid
+	std::array<T*, K> in;
+	std::array<T*, K> out;
+	for (size_t k = 0; k < K; ++k)
+	{
+		in[k] = buffer + 2 * k * stride + S;
+		out[k] = in[k] + stride;
+
+		std::fill(in[k] - S, in[k], T(0.0));
+		std::copy(x[k], x[k] + N, in[k]);
+		std::fill(in[k] + N, in[k] + M + S, T(0.0));
+		std::fill(out[k] - S, out[k], T(0.0));
+		std::fill(out[k] + M, out[k] + M + S, T(0.0));
+	}
+
+	const T* unaliased alpha = factors;
+	for (size_t s = 1; s < S; s *= 2, alpha += 2 * M)
+	{
+		const T* unaliased gamma = alpha + M;
+		for (size_t i = 0; i < M; i += W)
+		{
+			const Vector vAlpha = Pack::Load(alpha + i);
+			const Vector vGamma = Pack::Load(gamma + i);
+			for (size_t k = 0; k < K; ++k)
+				Pack::Store(out[k] + i, Pack::Load(in[k] + i) + vAlpha * Pack::Load(in[k] + i - s) + vGamma * Pack::Load(in[k] + i + s));
+		}
+		std::swap(in, out);
+	}
+
+	// Thomas algorithm on the reduced system, in place: a step reads the rows S before (after) it, already substituted
+	const T* unaliased sub = alpha;
+	const T* unaliased upper = sub + M;
+	const T* unaliased inversePivot = upper + M;
+	for (size_t i = 0; i < M; i += W)
+	{
+		const Vector vSub = Pack::Load(sub + i);
+		const Vector vInversePivot = Pack::Load(inversePivot + i);
+		for (size_t k = 0; k < K; ++k)
+			Pack::Store(in[k] + i, (Pack::Load(in[k] + i) - vSub * Pack::Load(in[k] + i - S)) * vInversePivot);
+	}
+
+	for (size_t i = M; i > 0; )
+	{
+		i -= W;
+		const Vector vUpper = Pack::Load(upper + i);
+		for (size_t k = 0; k < K; ++k)
+			Pack::Store(in[k] + i, Pack::Load(in[k] + i) - vUpper * Pack::Load(in[k] + i + S));
+	}
+
+	for (size_t k = 0; k < K; ++k)
+		std::copy(in[k], in[k] + N, x[k]);
+}
+
+template<typename T, typename Pack, size_t fixedN>
+template<bool reversed, size_t K, typename F>
+void CTridiagonalKernels<T, Pack, fixedN>::DotForwardSubstitute(const T* unaliased dotSub, const T* unaliased dotDiag, const T* unaliased dotSuper, const std::array<CSweepVector<T>, K>& unaliased x,
+		const T* unaliased coupling, const F* unaliased inversePivot, const size_t n) noexcept
+{
+	const size_t N = fixedN ? fixedN : n;
+	constexpr size_t noSource = CSweepVector<T>::noSource;
+
+	// coefficients of the neighbours eliminated before and after each row
+	const T* unaliased dotBefore = reversed ? dotSuper : dotSub;
+	const T* unaliased dotAfter = reversed ? dotSub : dotSuper;
+
+	// old values of the row eliminated before and of the current one
+	std::array<T, K> previous, current;
+
+	size_t i = Row<reversed>(0, N);
+	size_t next = Row<reversed>(1, N);
+	for (size_t k = 0; k < K; ++k)
+		current[k] = x[k].x[i];
+
+	for (size_t k = 0; k < K; ++k)
+	{
+		T rhs = dotDiag[i] * current[k] + dotAfter[i] * x[k].x[next];
+		if (x[k].source != noSource)
+		{
+			const T* unaliased jacobianAfter = reversed ? x[k].jacobianSub : x[k].jacobianSuper;
+			rhs += x[k].jacobianDiag[i] * current[x[k].source] + jacobianAfter[i] * x[x[k].source].x[next];
+		}
+
+		x[k].x[i] = rhs * inversePivot[i];
+	}
+
+	for (size_t s = 1; s < N - 1; ++s)
+	{
+		const size_t before = i;
+		i = next;
+		next = Row<reversed>(s + 1, N);
+
+		previous = current;
+		for (size_t k = 0; k < K; ++k)
+			current[k] = x[k].x[i];
+
+		for (size_t k = 0; k < K; ++k)
+		{
+			T rhs = dotBefore[i] * previous[k] + dotDiag[i] * current[k] + dotAfter[i] * x[k].x[next];
+			if (x[k].source != noSource)
+			{
+				const T* unaliased jacobianBefore = reversed ? x[k].jacobianSuper : x[k].jacobianSub;
+				const T* unaliased jacobianAfter = reversed ? x[k].jacobianSub : x[k].jacobianSuper;
+				rhs += jacobianBefore[i] * previous[x[k].source] + x[k].jacobianDiag[i] * current[x[k].source] + jacobianAfter[i] * x[x[k].source].x[next];
+			}
+
+			x[k].x[i] = (rhs - coupling[i] * x[k].x[before]) * inversePivot[i];
+		}
+	}
+
+	const size_t before = i;
+	i = next;
+
+	previous = current;
+	for (size_t k = 0; k < K; ++k)
+		current[k] = x[k].x[i];
+
+	for (size_t k = 0; k < K; ++k)
+	{
+		T rhs = dotBefore[i] * previous[k] + dotDiag[i] * current[k];
+		if (x[k].source != noSource)
+		{
+			const T* unaliased jacobianBefore = reversed ? x[k].jacobianSuper : x[k].jacobianSub;
+			rhs += jacobianBefore[i] * previous[x[k].source] + x[k].jacobianDiag[i] * current[x[k].source];
+		}
+
+		x[k].x[i] = (rhs - coupling[i] * x[k].x[before]) * inversePivot[i];
+	}
+}
+
+template<typename T, typename Pack, size_t fixedN>
+template<bool reversed, size_t K, typename F>
+void CTridiagonalKernels<T, Pack, fixedN>::AddForwardSubstitute(const T factor, const std::array<CJacobianTerm<T>, K>& unaliased terms, const T* unaliased coupling, const F* unaliased inversePivot, const size_t n) noexcept
+{
+	const size_t N = fixedN ? fixedN : n;
+
+	// forward substituted Jacobian product
+	std::array<T, K> f;
+
+	// the Jacobian product only reads x, so the boundary rows are the only ones that depend on the direction
+	const size_t first = Row<reversed>(0, N);
+	const size_t last = Row<reversed>(N - 1, N);
+	for (size_t k = 0; k < K; ++k)
+	{
+		const T* unaliased jacobianAfter = reversed ? terms[k].jacobianSub : terms[k].jacobianSuper;
+		f[k] = (terms[k].jacobianDiag[first] * terms[k].x[first] + jacobianAfter[first] * terms[k].x[Row<reversed>(1, N)]) * inversePivot[first];
+		terms[k].out[first] += factor * f[k];
+	}
+
+	for (size_t s = 1; s < N - 1; ++s)
+	{
+		const size_t i = Row<reversed>(s, N);
+		for (size_t k = 0; k < K; ++k)
+		{
+			const T jx = terms[k].jacobianSub[i] * terms[k].x[i - 1] + terms[k].jacobianDiag[i] * terms[k].x[i] + terms[k].jacobianSuper[i] * terms[k].x[i + 1];
+			f[k] = (jx - coupling[i] * f[k]) * inversePivot[i];
+			terms[k].out[i] += factor * f[k];
+		}
+	}
+
+	for (size_t k = 0; k < K; ++k)
+	{
+		const T* unaliased jacobianBefore = reversed ? terms[k].jacobianSuper : terms[k].jacobianSub;
+		const T jx = jacobianBefore[last] * terms[k].x[Row<reversed>(N - 2, N)] + terms[k].jacobianDiag[last] * terms[k].x[last];
+		f[k] = (jx - coupling[last] * f[k]) * inversePivot[last];
+		terms[k].out[last] += factor * f[k];
+	}
+}
+
+template<typename T, typename Pack, size_t fixedN>
+template<bool reversed, size_t K, typename F>
+void CTridiagonalKernels<T, Pack, fixedN>::BackSubstitute(const std::array<T*, K>& unaliased x, const F* unaliased factor, const size_t n) noexcept
+{
+	const size_t N = fixedN ? fixedN : n;
+	for (size_t s = N - 1; s --> 0 ;)
+	{
+		const size_t i = Row<reversed>(s, N);
+		const size_t next = Row<reversed>(s + 1, N);
+		for (size_t k = 0; k < K; ++k)
+			x[k][i] -= factor[i] * x[k][next];
+	}
+}
+
+}
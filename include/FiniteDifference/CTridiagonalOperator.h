@@ -10,12 +10,19 @@
 
 #include <vector>
 #include <array>
+#include <algorithm>
 #include <stddef.h>
 
 #include <FiniteDifference/CGrid.h>
+#include <FiniteDifference/CTridiagonalKernels.h>
+#include <Utilities/CAlignedAllocator.h>
+#include <Utilities/CFixedVector.h>
+#include <Utilities/CThreadTeam.h>
 #include <Data/CInputData.h>
 #include <Data/CPayoffData.h>
 #include <Data/EAdjointDifferentiation.h>
+#include <Data/ESolverType.h>
+#include <Data/EPrecision.h>
 #include <Flags.h>
 
 namespace details
@@ -29,29 +36,104 @@ enum ETridiagIndex
 };
 
 /**
- * This is just a wrapper of a triple of double's
+ * Structure-of-arrays tridiagonal matrix: each diagonal is stored in its own cache line aligned and padded array,
+ * so that the sweeps over the sub/main/super diagonals are unit-stride
  */
-class Triple
+template<size_t fixedN=0, typename T=double>
+class Matrix
 {
 public:
-	Triple(const double sub, const double diag, const double super) : data({ {sub, diag, super} }) {};
-	Triple() noexcept: Triple(0.0, 0.0, 0.0){};
-	Triple(const Triple& rhs) : data(rhs.data) {}
+	Matrix() noexcept : N(0) {};
+	explicit Matrix(const size_t N) noexcept : Matrix() { resize(N); };
+	Matrix(const Matrix& rhs) = default;
 
-	const double& Get(const ETridiagIndex idx) const noexcept
+	void resize(const size_t N) noexcept
 	{
-		return data[idx];
+		this->N = N;
+		for (auto& diagonal : data)
+			diagonal.resize(Padded<T>(N), T(0.0));
 	}
 
-	void Set(const ETridiagIndex idx, const double val) noexcept
+	size_t size() const noexcept
 	{
-		data[idx] = val;
+		return N;
+	}
+
+	const T* Get(const ETridiagIndex idx) const noexcept
+	{
+		return data[idx].data();
+	}
+
+	T* Get(const ETridiagIndex idx) noexcept
+	{
+		return data[idx].data();
 	}
 private:
-	std::array<double, 3> data;
+	size_t N;
+	std::array<Storage<T, fixedN>, 3> data;
 };
 
-typedef std::vector<Triple> Matrix;
+/**
+ * View of the vectors of a tile of the grid (see CTridiagonalOperator::Dot with temporal blocking): index 0 is the grid point begin.
+ * Only the points in [ownedBegin, ownedEnd) are written back, the others are just a halo. Vectors that are not computed are null
+ */
+template<typename T, size_t nRhs>
+struct CTile
+{
+	size_t begin = 0;
+	size_t size = 0;
+	size_t ownedBegin = 0;
+	size_t ownedEnd = 0;
+
+	std::array<T*, nRhs> payoff = { };
+	std::array<T*, nRhs> vega = { };
+	std::array<T*, nRhs> rho = { };
+	std::array<T*, nRhs> rhoBorrow = { };
+};
+
+/**
+ * Active window of the grid (see CFDPricer): only the points in [begin, end) are updated, the others are frozen and act as boundary values.
+ * The implicit solves need the Thomas factors of the window rows, see CTridiagonalOperator::Factorize
+ */
+template<typename F>
+struct CActiveWindow
+{
+	size_t begin = 0;
+	size_t end = 0;
+	const F* upperFactor = nullptr;
+	const F* inversePivot = nullptr;
+};
+
+/**
+ * Early exercise of each right-hand side, applied within the implicit solves (see CTridiagonalOperator::Solve): x_j >= sign_j * intrinsic.
+ * The exercise region of a positive sign (call) is attached to the upper grid boundary, the one of a negative sign (put) to the lower one.
+ * A zero sign leaves its right-hand side unconstrained
+ */
+template<typename T, size_t nRhs>
+struct CExerciseCondition
+{
+	const T* intrinsic = nullptr;
+	std::array<double, nRhs> sign = { };
+};
+
+/**
+ * The whole grid as a single tile, for the operators that are not blocked
+ */
+template<typename T, size_t nRhs, typename PayoffData>
+CTile<T, nRhs> WholeTile(const std::array<PayoffData*, nRhs>& unaliased x) noexcept
+{
+	CTile<T, nRhs> tile;
+	tile.size = tile.ownedEnd = x[0]->payoff_i.size();
+	for (size_t j = 0; j < nRhs; ++j)
+	{
+		tile.payoff[j] = x[j]->payoff_i.data();
+		tile.vega[j] = x[j]->vega_i.data();
+		tile.rho[j] = x[j]->rho_i.data();
+		tile.rhoBorrow[j] = x[j]->rhoBorrow_i.data();
+	}
+
+	return tile;
+}
 
 }
 
@@ -59,11 +141,24 @@ typedef std::vector<Triple> Matrix;
 namespace fdpricing
 {
 
+template<ESolverType solverType, EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t lanes>
+class CBatchEvolutionOperator;
+
+/**
+ * fixedN: if not 0, the size known at compile time, so that all the storage is in place and the sweeps have fixed trip counts
+ * precision: scalar types of the operator, of its factors and of the payoff data it is applied to
+ */
 template<EGridType gridType=EGridType::Adaptive,
-		EAdjointDifferentiation adjointDifferentiation=EAdjointDifferentiation::All>
+		EAdjointDifferentiation adjointDifferentiation=EAdjointDifferentiation::All,
+		size_t fixedN=0,
+		EPrecision precision=EPrecision::Double>
 class CTridiagonalOperator
 {
 public:
+	typedef typename details::CPrecisionTraits<precision>::Value Value;
+	typedef typename details::CPrecisionTraits<precision>::Factor Factor;
+	typedef typename CPayoffDataSelector<fixedN, Value>::Type PayoffData;
+
 	CTridiagonalOperator(const size_t N) noexcept;
 	CTridiagonalOperator(const CInputData& unaliased input, const CGrid<gridType>& unaliased grid) noexcept;
 	CTridiagonalOperator(const CTridiagonalOperator& __restrict rhs) noexcept;
@@ -77,36 +172,287 @@ public:
 	 */
 	void Add(const double alpha, const double beta) noexcept;
 
-	void Dot(CPayoffData& unaliased payoffData) const noexcept;
+	void Dot(PayoffData& unaliased payoffData) const noexcept;
+
+	/**
+	 * Multiple right-hand sides version: payoffs and tangents of all the inputs are updated in a single sweep
+	 */
+	template<size_t nRhs>
+	void Dot(const std::array<PayoffData*, nRhs>& unaliased payoffData) const noexcept;
+
+	/**
+	 * Temporal blocking: nSteps products at once, tile by tile, so that each tile stays in cache for all of them.
+	 * Tiles own about tileSize points, and they are extended by nSteps points on each side (overlapped tiling): the halo is recomputed
+	 * by the neighbouring tiles, but it makes each tile independent. The results are the same as nSteps calls to Dot.
+	 *
+	 * After each step postStep(tile, step) is called, where tile is a details::CTile of the (extended) tile vectors.
+	 * Tiles are processed from the upper boundary down, so that the one with the lower boundary is the last one.
+	 *
+	 * buffer: scratch memory of (at least) TileBufferSize<nRhs>(nSteps, tileSize) elements
+	 */
+	template<size_t nRhs, typename PostStep>
+	void Dot(const std::array<PayoffData*, nRhs>& unaliased payoffData, const size_t nSteps, const size_t tileSize, Value* unaliased buffer, PostStep&& postStep) const noexcept;
+
+	/**
+	 * Active window versions: the points out of the window are left untouched, and their values enter the rows at the edges of the window
+	 */
+	template<size_t nRhs>
+	void Dot(const std::array<PayoffData*, nRhs>& unaliased payoffData, const details::CActiveWindow<Factor>& unaliased window) const noexcept;
+	template<size_t nRhs>
+	void Solve(const std::array<PayoffData*, nRhs>& unaliased payoffData, const details::CActiveWindow<Factor>& unaliased window) const noexcept;
+
+	/**
+	 * Thomas Algorithm factors of the rows in [begin, end) only, for Solve over an active window: end - begin elements each
+	 */
+	void Factorize(const size_t begin, const size_t end, Factor* unaliased upperFactor, Factor* unaliased inversePivot) const noexcept;
+
+	template<size_t nRhs>
+	static size_t TileBufferSize(const size_t nSteps, const size_t tileSize) noexcept
+	{
+		return nRhs * (1 + nUncoupledTangents + nCoupledTangents) * (TileStride(nSteps, tileSize) + nSteps);
+	}
+
+	/**
+	 * Partition method, for splitting the solves across the nPartitions threads of a team (see Solve with a team): it has to be called after Factorize.
+	 * The grid is split into nPartitions contiguous partitions (see PartitionBegin), each one but the first starting with a separator point.
+	 * The interior of each partition is factorized on its own, and its spikes solve the interior system with the coupling to the separator
+	 * before (after) it as right hand side. Once the interiors are solved, the separators solve a tridiagonal system of nPartitions - 1 equations,
+	 * then the interiors are corrected by the spikes scaled by their separators
+	 */
+	void Partition(const size_t nPartitions) noexcept;
+
+	/**
+	 * First point of the p-th of nPartitions partitions, N for p = nPartitions: the partitions start on a cache line
+	 */
+	size_t PartitionBegin(const size_t p, const size_t nPartitions) const noexcept
+	{
+		constexpr size_t lineSize = details::Padded<Value>(1);
+		return p == 0 ? 0 : (p >= nPartitions ? N : (p * N / nPartitions) / lineSize * lineSize);
+	}
+
+	/**
+	 * Partitioned versions, called by the p-th thread of team on the p-th partition: each thread writes its own partition only,
+	 * so that the data stays in the cache of its core, and the team is synchronized only when a partition needs the others.
+	 * The results are the same as the whole grid versions, up to rounding.
+	 *
+	 * buffer: scratch memory shared by the team, of (at least) PartitionBufferSize<nRhs>(team.size()) elements
+	 */
+	template<size_t nRhs>
+	void Dot(const std::array<PayoffData*, nRhs>& unaliased payoffData, const size_t p, details::CThreadTeam& team, Value* unaliased buffer) const noexcept;
+	template<size_t nRhs>
+	void Solve(const std::array<PayoffData*, nRhs>& unaliased payoffData, const size_t p, details::CThreadTeam& team, Value* unaliased buffer) const noexcept;
+
+	template<size_t nRhs>
+	static size_t PartitionBufferSize(const size_t nPartitions) noexcept
+	{
+		return nRhs * (1 + nUncoupledTangents + nCoupledTangents) * PartitionStride(nPartitions);
+	}
+
+	/**
+	 * Precompute the Thomas Algorithm factors: it has to be called before Solve, once the operator is not going to change anymore
+	 */
+	void Factorize() noexcept;
 
 	/**
 	 * Thomas Algorithm: https://en.wikibooks.org/wiki/Algorithm_Implementation/Linear_Algebra/Tridiagonal_matrix_algorithm
 	 *
 	 * x: containts input/output
 	 */
-	void Solve(CPayoffData& unaliased payoffData) noexcept;
+	void Solve(PayoffData& unaliased payoffData) const noexcept;
+
+	/**
+	 * Multiple right-hand sides version: the factors are streamed once for payoffs and rho's of all the inputs,
+	 * and once for the tangents that need the Jacobian correction (as that depends on the updated payoff)
+	 */
+	template<size_t nRhs>
+	void Solve(const std::array<PayoffData*, nRhs>& unaliased payoffData) const noexcept;
+
+	/**
+	 * Brennan-Schwartz: the payoffs solve the linear complementarity problem A \cdot x >= b, x >= sign * intrinsic, with one of the two being an equality,
+	 * rather than being projected after an unconstrained solve. The exercise condition is applied within the back substitution, which runs towards
+	 * the exercise region: up the grid for calls (LU factors), down the grid for puts (UL factors). Hence payoff and rho of each input take a sweep
+	 * of their own. It's exact only if the exercise region is an interval attached to the grid boundary. The tangents are solved as usual.
+	 * Puts need FactorizeReversed
+	 */
+	template<size_t nRhs>
+	void Solve(const std::array<PayoffData*, nRhs>& unaliased payoffData, const details::CExerciseCondition<Value, nRhs>& unaliased exercise) const noexcept;
+
+	/**
+	 * UL factors (see details::CTridiagonalKernels::FactorizeReversed), which the puts solve with in Solve with the exercise condition and in DotSolve with it:
+	 * as the Thomas factors, it has to be called once the operator is not going to change anymore
+	 */
+	void FactorizeReversed() noexcept;
+
+	bool HasReversedFactors() const noexcept
+	{
+		return !lowerFactor.empty();
+	}
+
+	/**
+	 * Factors of the hybrid cyclic reduction (see details::CTridiagonalKernels::CyclicReductionSolve), for Solve with a buffer: as the Thomas factors,
+	 * it has to be called once the operator is not going to change anymore
+	 */
+	void FactorizeCyclicReduction() noexcept;
+
+	bool HasCyclicReduction() const noexcept
+	{
+		return !reductionFactors.empty();
+	}
+
+	/**
+	 * Same as Solve, with the hybrid cyclic reduction rather than the Thomas algorithm: it takes about log2(S) more operations per point,
+	 * S being the rows in a cache line, but its recurrences are S times shorter and vectorized. It pays off on small grids with few vectors
+	 * (e.g. a single option without greeks), where the Thomas algorithm is bound by the latency of its recurrences.
+	 *
+	 * buffer: scratch memory of (at least) ReductionBufferSize<nRhs>(N) elements
+	 */
+	template<size_t nRhs>
+	void Solve(const std::array<PayoffData*, nRhs>& unaliased payoffData, Value* unaliased buffer) const noexcept;
+
+	template<size_t nRhs>
+	static size_t ReductionBufferSize(const size_t N) noexcept
+	{
+		return details::CyclicReductionBufferSize(reductionRows, nRhs * (1 + nUncoupledTangents + nCoupledTangents), N);
+	}
+
+	/**
+	 * Fused explicit/implicit step, i.e. x = A^{-1} \cdot B \cdot x, where A is this operator: B \cdot x is computed during the forward substitution
+	 */
+	template<size_t nRhs>
+	void DotSolve(const CTridiagonalOperator& unaliased B, const std::array<PayoffData*, nRhs>& unaliased payoffData) const noexcept;
+
+	/**
+	 * Brennan-Schwartz version of DotSolve (see Solve with the exercise condition): B \cdot x is computed during the forward substitution
+	 * of the LU factors for calls, and of the UL ones for puts, then the payoffs are projected within the back substitution.
+	 * The tangents of each input are swept together with its payoff
+	 */
+	template<size_t nRhs>
+	void DotSolve(const CTridiagonalOperator& unaliased B, const std::array<PayoffData*, nRhs>& unaliased payoffData, const details::CExerciseCondition<Value, nRhs>& unaliased exercise) const noexcept;
 
 private:
+	/**
+	 * The batched operator interleaves the coefficients of several operators
+	 */
+	template<ESolverType, EGridType, EAdjointDifferentiation, size_t>
+	friend class CBatchEvolutionOperator;
+
+	/**
+	 * Tangents that do not need any Jacobian correction (rho) and tangents that do (vega and rho borrow)
+	 */
+	static constexpr size_t nUncoupledTangents = (adjointDifferentiation == EAdjointDifferentiation::Rho || adjointDifferentiation == EAdjointDifferentiation::All) ? 1 : 0;
+	static constexpr size_t nCoupledTangents = adjointDifferentiation == EAdjointDifferentiation::All ? 2 :
+			((adjointDifferentiation == EAdjointDifferentiation::Vega || adjointDifferentiation == EAdjointDifferentiation::Rho) ? 1 : 0);
+
+	typedef details::CDispatchedTridiagonalKernels<Value, fixedN> Kernels;
+
+	/**
+	 * Kernels over a part of the grid (tiles, active windows): they are not fixed size, whatever the operator is
+	 */
+	typedef details::CDispatchedTridiagonalKernels<Value> RangeKernels;
+
+	/**
+	 * Tiles are at least twice as wide as their halo, so that only the first one reaches the lower boundary
+	 */
+	static size_t MinTileSize(const size_t nSteps, const size_t tileSize) noexcept
+	{
+		return std::max(tileSize, 2 * nSteps);
+	}
+
+	static size_t TileStride(const size_t nSteps, const size_t tileSize) noexcept
+	{
+		return details::Padded<Value>(MinTileSize(nSteps, tileSize) + 2 * nSteps);
+	}
+
+	/**
+	 * Per vector in the partitioned buffer: the edges of each partition for Dot, then the separators for Solve
+	 */
+	static size_t PartitionStride(const size_t nPartitions) noexcept
+	{
+		return details::Padded<Value>(2 * nPartitions) + details::Padded<Value>(nPartitions);
+	}
+
+	/**
+	 * Rows advanced by a step of the reduced system of the cyclic reduction: a cache line
+	 */
+	static constexpr size_t reductionRows = details::Padded<Value>(1);
+
 	const size_t N;
-	details::Matrix matrix;
-	details::Matrix matrixVega;
-	details::Matrix matrixRhoBorrow;
+	details::Matrix<fixedN, Value> matrix;
+	details::Matrix<fixedN, Value> matrixVega;
+	details::Matrix<fixedN, Value> matrixRhoBorrow;
 
-	std::vector<double> solve_cache;
+	/**
+	 * Thomas Algorithm factors: c'_i and 1 / (b_i - a_i * c'_{i - 1})
+	 */
+	details::Storage<Factor, fixedN> upperFactor;
+	details::Storage<Factor, fixedN> inversePivot;
+
+	/**
+	 * Same going down the grid (UL factorization), for the Brennan-Schwartz solves of the puts: b'_i and 1 / (b_i - c_i * b'_{i + 1}).
+	 * Empty unless FactorizeReversed is called
+	 */
+	details::AlignedVector<Factor> lowerFactor;
+	details::AlignedVector<Factor> reversedInversePivot;
+
+	/**
+	 * Partition method (see Partition): Thomas factors of the partition interiors and their spikes, over the whole grid.
+	 * Then the sub diagonal of the separator system, with its Thomas factors
+	 */
+	details::AlignedVector<Factor> partitionUpperFactor;
+	details::AlignedVector<Factor> partitionInversePivot;
+	details::AlignedVector<Value> spikeLeft;
+	details::AlignedVector<Value> spikeRight;
+	details::AlignedVector<Value> separatorSub;
+	details::AlignedVector<Value> separatorUpperFactor;
+	details::AlignedVector<Value> separatorInversePivot;
+
+	/**
+	 * See FactorizeCyclicReduction
+	 */
+	details::AlignedVector<Value> reductionFactors;
 
 	/**
 	 * Set the operator according to the second order uneven mesh finite difference
 	 */
 	void Make(const CInputData& unaliased input, const CGrid<gridType>& unaliased grid) noexcept;
 
-	 /**
-	  * Compute out += alpha * A * x
-	  * */
-	void Add(std::vector<double>& unaliased out, const double alpha, const details::Matrix& unaliased A, const std::vector<double>& unaliased x) const noexcept;
+	/**
+	 * Set the tangents that need the Jacobian correction, together with their Jacobian
+	 */
+	void SetJacobians(details::CSweepVector<Value>* unaliased tangents, PayoffData& unaliased payoffData) const noexcept;
+	template<size_t nRhs>
+	void SetUncoupledVectors(std::array<Value*, nRhs * (1 + nUncoupledTangents)>& unaliased x, const std::array<PayoffData*, nRhs>& unaliased payoffData) const noexcept;
+	template<size_t nRhs>
+	void SetJacobianTerms(std::array<details::CJacobianTerm<Value>, nRhs * nCoupledTangents>& unaliased terms, std::array<Value*, nRhs * nCoupledTangents>& unaliased v,
+			const std::array<PayoffData*, nRhs>& unaliased payoffData) const noexcept;
+	template<size_t nRhs>
+	void SetSweepVectors(std::array<details::CSweepVector<Value>, nRhs * (1 + nUncoupledTangents + nCoupledTangents)>& unaliased x, const std::array<PayoffData*, nRhs>& unaliased payoffData) const noexcept;
+	void SetJacobian(details::CSweepVector<Value>& unaliased tangent, Value* unaliased x, const details::Matrix<fixedN, Value>& unaliased J) const noexcept;
+
+	/**
+	 * Solve the tangents that need the Jacobian correction, once the payoffs are updated
+	 */
+	template<size_t nRhs>
+	void SolveCoupled(const std::array<PayoffData*, nRhs>& unaliased payoffData) const noexcept;
 
-	void Dot(const details::Matrix& unaliased A, std::vector<double>& unaliased x) const noexcept;
+	/**
+	 * DotSolve with the exercise condition for a single input, with the LU factors (coupling = sub) or the UL ones if reversed (coupling = super)
+	 */
+	template<bool reversed>
+	void ProjectedDotSolve(const CTridiagonalOperator& unaliased B, PayoffData* unaliased payoffData, const Value* unaliased intrinsic, const Value sign,
+			const Value* unaliased coupling, const Factor* unaliased factor, const Factor* unaliased inversePivot) const noexcept;
 
-	void Solve(std::vector<double>& unaliased x, const details::Matrix& unaliased m) noexcept;
+	/**
+	 * Partition method on the p-th partition (see Partition): x are K of the vectors set up by SetSweepVectors
+	 */
+	template<size_t K>
+	void PartitionedSolve(const std::array<Value*, K>& unaliased x, const size_t p, details::CThreadTeam& team, Value* unaliased buffer) const noexcept;
+
+	/**
+	 * Compute A *= beta
+	 */
+	void Scale(details::Matrix<fixedN, Value>& unaliased A, const double beta) const noexcept;
+	void Scale(Value* unaliased x, const double beta) const noexcept;
 };
 
 } /* namespace fdpricing */
@@ -10,8 +10,8 @@
 namespace fdpricing
 {
 
-template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-CTridiagonalOperator<gridType, adjointDifferentiation>::CTridiagonalOperator(const size_t N) noexcept
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::CTridiagonalOperator(const size_t N) noexcept
 	: N(N), matrix(N)
 {
 	switch (adjointDifferentiation)
@@ -31,312 +31,936 @@ CTridiagonalOperator<gridType, adjointDifferentiation>::CTridiagonalOperator(con
 	}
 }
 
-template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-CTridiagonalOperator<gridType, adjointDifferentiation>::CTridiagonalOperator(const CInputData& unaliased input, const CGrid<gridType>& unaliased grid) noexcept
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::CTridiagonalOperator(const CInputData& unaliased input, const CGrid<gridType>& unaliased grid) noexcept
 	: CTridiagonalOperator(input.N)
 {
 	Make(input, grid);
 }
 
-template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-CTridiagonalOperator<gridType, adjointDifferentiation>::CTridiagonalOperator(const CTridiagonalOperator& unaliased rhs) noexcept
-	: N(rhs.N), matrix(rhs.matrix), matrixVega(rhs.matrixVega), matrixRhoBorrow(rhs.matrixRhoBorrow)
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::CTridiagonalOperator(const CTridiagonalOperator& unaliased rhs) noexcept
+	: N(rhs.N), matrix(rhs.matrix), matrixVega(rhs.matrixVega), matrixRhoBorrow(rhs.matrixRhoBorrow),
+	  upperFactor(rhs.upperFactor), inversePivot(rhs.inversePivot), lowerFactor(rhs.lowerFactor), reversedInversePivot(rhs.reversedInversePivot),
+	  partitionUpperFactor(rhs.partitionUpperFactor), partitionInversePivot(rhs.partitionInversePivot), spikeLeft(rhs.spikeLeft), spikeRight(rhs.spikeRight),
+	  separatorSub(rhs.separatorSub), separatorUpperFactor(rhs.separatorUpperFactor), separatorInversePivot(rhs.separatorInversePivot), reductionFactors(rhs.reductionFactors)
 {
 
 }
 
-template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-void CTridiagonalOperator<gridType, adjointDifferentiation>::Add(const double alpha, const double beta) noexcept
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Add(const double alpha, const double beta) noexcept
 {
+	Value* unaliased diag = matrix.Get(details::Zero);
 	for (size_t i = 0; i < N; ++i)
-	{
-		matrix[i].Set(details::Zero, alpha + beta * matrix[i].Get(details::Zero));
-		matrix[i].Set(details::Plus,         beta * matrix[i].Get(details::Plus));
-		matrix[i].Set(details::Minus,        beta * matrix[i].Get(details::Minus));
+		diag[i] = alpha + beta * diag[i];
+	Scale(matrix.Get(details::Minus), beta);
+	Scale(matrix.Get(details::Plus), beta);
 
-		switch (adjointDifferentiation)
-		{
-			case EAdjointDifferentiation::Vega:
-				matrixVega[i].Set(details::Zero,  beta * matrixVega[i].Get(details::Zero));
-				matrixVega[i].Set(details::Plus,  beta * matrixVega[i].Get(details::Plus));
-				matrixVega[i].Set(details::Minus, beta * matrixVega[i].Get(details::Minus));
-				break;
-			case EAdjointDifferentiation::Rho:
-				matrixRhoBorrow[i].Set(details::Zero,  beta * matrixRhoBorrow[i].Get(details::Zero));
-				matrixRhoBorrow[i].Set(details::Plus,  beta * matrixRhoBorrow[i].Get(details::Plus));
-				matrixRhoBorrow[i].Set(details::Minus, beta * matrixRhoBorrow[i].Get(details::Minus));
-				break;
-			case EAdjointDifferentiation::All:
-				matrixVega[i].Set(details::Zero,  beta * matrixVega[i].Get(details::Zero));
-				matrixVega[i].Set(details::Plus,  beta * matrixVega[i].Get(details::Plus));
-				matrixVega[i].Set(details::Minus, beta * matrixVega[i].Get(details::Minus));
-
-				matrixRhoBorrow[i].Set(details::Zero,  beta * matrixRhoBorrow[i].Get(details::Zero));
-				matrixRhoBorrow[i].Set(details::Plus,  beta * matrixRhoBorrow[i].Get(details::Plus));
-				matrixRhoBorrow[i].Set(details::Minus, beta * matrixRhoBorrow[i].Get(details::Minus));
-				break;
-			default:
-				break;
-		}
+	switch (adjointDifferentiation)
+	{
+		case EAdjointDifferentiation::Vega:
+			Scale(matrixVega, beta);
+			break;
+		case EAdjointDifferentiation::Rho:
+			Scale(matrixRhoBorrow, beta);
+			break;
+		case EAdjointDifferentiation::All:
+			Scale(matrixVega, beta);
+			Scale(matrixRhoBorrow, beta);
+			break;
+		default:
+			break;
 	}
 }
 
-template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-void CTridiagonalOperator<gridType, adjointDifferentiation>::Dot(CPayoffData& unaliased out) const noexcept
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Scale(details::Matrix<fixedN, Value>& unaliased A, const double beta) const noexcept
+{
+	Scale(A.Get(details::Minus), beta);
+	Scale(A.Get(details::Zero), beta);
+	Scale(A.Get(details::Plus), beta);
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Scale(Value* unaliased x, const double beta) const noexcept
+{
+	for (size_t i = 0; i < N; ++i)
+		x[i] *= beta;
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Dot(PayoffData& unaliased out) const noexcept
+{
+	Dot(std::array<PayoffData*, 1> { { &out } });
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Dot(const std::array<PayoffData*, nRhs>& unaliased out) const noexcept
 {
 #ifdef DEBUG
-	if (out.payoff_i.size() != N)
+	for (size_t j = 0; j < nRhs; ++j)
 	{
-		printf("*** WRONG PAYOFF SIZE ***\n");
-		return;
+		if (out[j]->payoff_i.size() != N)
+		{
+			printf("*** WRONG PAYOFF SIZE ***\n");
+			return;
+		}
 	}
 #endif
 
 	// x_{n} = A \cdot x_{n + 1}
 	// Therefore:
 	// v_{n} = J \cdot x_{n + 1} + A \cdot v_{n + 1}
-	switch (adjointDifferentiation)
+	// The old x_{n + 1} is used by the Jacobian terms, so all vectors are updated in the same sweep
+	std::array<details::CSweepVector<Value>, nRhs * (1 + nUncoupledTangents + nCoupledTangents)> x;
+	SetSweepVectors<nRhs>(x, out);
+
+	Kernels::Dot(matrix.Get(details::Minus), matrix.Get(details::Zero), matrix.Get(details::Plus), x, N);
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs, typename PostStep>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Dot(const std::array<PayoffData*, nRhs>& unaliased out, const size_t nSteps, const size_t tileSize,
+		Value* unaliased buffer, PostStep&& postStep) const noexcept
+{
+#ifdef DEBUG
+	for (size_t j = 0; j < nRhs; ++j)
 	{
-		case EAdjointDifferentiation::Vega:
-			Dot(matrix, out.vega_i);  // A \cdot v_{n + 1}
-			Add(out.vega_i, 1.0, matrixVega, out.payoff_i);  // J \cdot x_{n + 1}
-			break;
-		case EAdjointDifferentiation::Rho:
-			Dot(matrix, out.rho_i);
+		if (out[j]->payoff_i.size() != N)
+		{
+			printf("*** WRONG PAYOFF SIZE ***\n");
+			return;
+		}
+	}
+#endif
 
-			Dot(matrix, out.rhoBorrow_i);
-			Add(out.rhoBorrow_i, 1.0, matrixRhoBorrow, out.payoff_i);
-			break;
-		case EAdjointDifferentiation::All:
-			Dot(matrix, out.vega_i);
-			Add(out.vega_i, 1.0, matrixVega, out.payoff_i);
+	constexpr size_t nVectors = nRhs * (1 + nUncoupledTangents + nCoupledTangents);
 
-			Dot(matrix, out.rho_i);
+	// the tiles are split evenly: each one is at least half of MinTileSize wide, hence as wide as its halo
+	const size_t nTiles = (N + MinTileSize(nSteps, tileSize) - 1) / MinTileSize(nSteps, tileSize);
+	const size_t stride = TileStride(nSteps, tileSize);
 
-			Dot(matrix, out.rhoBorrow_i);
-			Add(out.rhoBorrow_i, 1.0, matrixRhoBorrow, out.payoff_i);
-			break;
-		default:
-			break;
+	// the sweep vectors point to the tile buffers, while the Jacobians are offset to the tile at each tile
+	std::array<details::CSweepVector<Value>, nVectors> x;
+	SetSweepVectors<nRhs>(x, out);
+
+	std::array<Value*, nVectors> vectors;
+	std::array<details::CSweepVector<Value>, nVectors> tileVectors = x;
+	for (size_t k = 0; k < nVectors; ++k)
+	{
+		vectors[k] = x[k].x;
+		tileVectors[k].x = buffer + k * stride;
+	}
+
+	// initial values of the lowest nSteps points of the previous tile, which are the upper halo of the current one
+	Value* unaliased carry = buffer + nVectors * stride;
+
+	details::CTile<Value, nRhs> tile;
+	auto tileVector = [&](const Value* unaliased v)
+	{
+		for (size_t k = 0; k < nVectors; ++k)
+		{
+			if (vectors[k] == v)
+				return tileVectors[k].x;
+		}
+		return static_cast<Value*>(nullptr);
+	};
+	for (size_t j = 0; j < nRhs; ++j)
+	{
+		tile.payoff[j] = tileVector(out[j]->payoff_i.data());
+		tile.vega[j] = tileVector(out[j]->vega_i.data());
+		tile.rho[j] = tileVector(out[j]->rho_i.data());
+		tile.rhoBorrow[j] = tileVector(out[j]->rhoBorrow_i.data());
 	}
 
-	// Only now we can update the payoff
-	Dot(matrix, out.payoff_i);
+	for (size_t t = nTiles; t --> 0 ;)
+	{
+		const size_t begin = t * N / nTiles;
+		const size_t end = (t + 1) * N / nTiles;
+
+		tile.begin = begin ? begin - nSteps : 0;
+		tile.size = std::min(N, end + nSteps) - tile.begin;
+		tile.ownedBegin = begin - tile.begin;
+		tile.ownedEnd = end - tile.begin;
+
+		// the points above end have been written back already
+		for (size_t k = 0; k < nVectors; ++k)
+		{
+			std::copy(vectors[k] + tile.begin, vectors[k] + end, tileVectors[k].x);
+			std::copy(carry + k * nSteps, carry + k * nSteps + (tile.begin + tile.size - end), tileVectors[k].x + tile.ownedEnd);
+			std::copy(vectors[k] + begin, vectors[k] + begin + nSteps, carry + k * nSteps);
+
+			if (tileVectors[k].source != details::CSweepVector<Value>::noSource)
+			{
+				tileVectors[k].jacobianSub   = x[k].jacobianSub + tile.begin;
+				tileVectors[k].jacobianDiag  = x[k].jacobianDiag + tile.begin;
+				tileVectors[k].jacobianSuper = x[k].jacobianSuper + tile.begin;
+			}
+		}
+
+		// the rows at the inner edges of the tile miss a neighbour: the error moves inwards by one point per step, never reaching the owned points
+		for (size_t step = 0; step < nSteps; ++step)
+		{
+			RangeKernels::Dot(matrix.Get(details::Minus) + tile.begin, matrix.Get(details::Zero) + tile.begin, matrix.Get(details::Plus) + tile.begin, tileVectors, tile.size);
+			postStep(static_cast<const details::CTile<Value, nRhs>&>(tile), step);
+		}
+
+		for (size_t k = 0; k < nVectors; ++k)
+			std::copy(tileVectors[k].x + tile.ownedBegin, tileVectors[k].x + tile.ownedEnd, vectors[k] + begin);
+	}
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Dot(const std::array<PayoffData*, nRhs>& unaliased out, const details::CActiveWindow<Factor>& unaliased window) const noexcept
+{
+	constexpr size_t nVectors = nRhs * (1 + nUncoupledTangents + nCoupledTangents);
+	constexpr size_t noSource = details::CSweepVector<Value>::noSource;
+	const size_t begin = window.begin;
+	const size_t end = window.end;
+
+	std::array<details::CSweepVector<Value>, nVectors> x;
+	SetSweepVectors<nRhs>(x, out);
+
+	std::array<details::CSweepVector<Value>, nVectors> windowVectors = x;
+	for (auto& v : windowVectors)
+	{
+		v.x += begin;
+		if (v.source != noSource)
+		{
+			v.jacobianSub   += begin;
+			v.jacobianDiag  += begin;
+			v.jacobianSuper += begin;
+		}
+	}
+
+	const Value* unaliased sub = matrix.Get(details::Minus);
+	const Value* unaliased super = matrix.Get(details::Plus);
+	RangeKernels::Dot(sub + begin, matrix.Get(details::Zero) + begin, super + begin, windowVectors, end - begin);
+
+	// the frozen neighbours have not changed, so they can be added afterwards
+	for (size_t k = 0; k < nVectors; ++k)
+	{
+		if (begin > 0)
+		{
+			x[k].x[begin] += sub[begin] * x[k].x[begin - 1];
+			if (x[k].source != noSource)
+				x[k].x[begin] += x[k].jacobianSub[begin] * x[x[k].source].x[begin - 1];
+		}
+		if (end < N)
+		{
+			x[k].x[end - 1] += super[end - 1] * x[k].x[end];
+			if (x[k].source != noSource)
+				x[k].x[end - 1] += x[k].jacobianSuper[end - 1] * x[x[k].source].x[end];
+		}
+	}
 }
 
-template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-void CTridiagonalOperator<gridType, adjointDifferentiation>::Add(std::vector<double>& unaliased out, const double factor, const details::Matrix& unaliased A, const std::vector<double>& unaliased x) const noexcept
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Solve(const std::array<PayoffData*, nRhs>& unaliased out, const details::CActiveWindow<Factor>& unaliased window) const noexcept
 {
-	out[0] += factor * (A[0].Get(details::Zero) * x[0] + A[0].Get(details::Plus) * x[1]);
+	const size_t begin = window.begin;
+	const size_t end = window.end;
+	const Value* unaliased sub = matrix.Get(details::Minus);
+	const Value* unaliased super = matrix.Get(details::Plus);
+
+	// the frozen neighbours are known: move them to the right hand side
+	auto solve = [&](const auto& unaliased x)
+	{
+		auto windowVectors = x;
+		for (size_t k = 0; k < x.size(); ++k)
+		{
+			if (begin > 0)
+				x[k][begin] -= sub[begin] * x[k][begin - 1];
+			if (end < N)
+				x[k][end - 1] -= super[end - 1] * x[k][end];
+			windowVectors[k] += begin;
+		}
 
-	for(size_t i = 1; i < N - 1; ++i)
-		out[i] += factor * (A[i].Get(details::Minus) * x[i - 1] + A[i].Get(details::Zero) * x[i] + A[i].Get(details::Plus) * x[i + 1]);
+		RangeKernels::Solve(windowVectors, sub + begin, window.upperFactor, window.inversePivot, end - begin);
+	};
+
+	std::array<Value*, nRhs * (1 + nUncoupledTangents)> x;
+	SetUncoupledVectors<nRhs>(x, out);
+	solve(x);
+
+	if (!nCoupledTangents)
+		return;
+
+	// see Solve
+	std::array<details::CJacobianTerm<Value>, nRhs * nCoupledTangents> terms;
+	std::array<Value*, nRhs * nCoupledTangents> v;
+	SetJacobianTerms<nRhs>(terms, v, out);
+
+	auto windowTerms = terms;
+	for (auto& term : windowTerms)
+	{
+		term.out += begin;
+		term.x += begin;
+		term.jacobianSub   += begin;
+		term.jacobianDiag  += begin;
+		term.jacobianSuper += begin;
+	}
+
+	RangeKernels::Add(-1.0, windowTerms, end - begin);
+	for (const auto& term : terms)
+	{
+		if (begin > 0)
+			term.out[begin] -= term.jacobianSub[begin] * term.x[begin - 1];
+		if (end < N)
+			term.out[end - 1] -= term.jacobianSuper[end - 1] * term.x[end];
+	}
 
-	out[N - 1] += factor * (A[N - 1].Get(details::Minus) * x[N - 2] + A[N - 1].Get(details::Zero) * x[N - 1]);
+	solve(v);
 }
 
-template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-void CTridiagonalOperator<gridType, adjointDifferentiation>::Dot(const details::Matrix& unaliased A, std::vector<double>& unaliased x) const noexcept
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Dot(const std::array<PayoffData*, nRhs>& unaliased out, const size_t p,
+		details::CThreadTeam& team, Value* unaliased buffer) const noexcept
 {
-	// TODO: make it a class member?
-	std::array<double, 2> cache = { { x[0], 0.0 } };
-	x[0] = A[0].Get(details::Zero) * x[0] + A[0].Get(details::Plus) * x[1];
+	constexpr size_t nVectors = nRhs * (1 + nUncoupledTangents + nCoupledTangents);
+	constexpr size_t noSource = details::CSweepVector<Value>::noSource;
+	const size_t nPartitions = team.size();
+	const size_t begin = PartitionBegin(p, nPartitions);
+	const size_t end = PartitionBegin(p + 1, nPartitions);
+	const size_t stride = PartitionStride(nPartitions);
+
+	std::array<details::CSweepVector<Value>, nVectors> x;
+	SetSweepVectors<nRhs>(x, out);
+
+	// the neighbours need the values at the edges of this partition before the update
+	auto edges = [buffer, stride](const size_t k, const size_t partition) { return buffer + k * stride + 2 * partition; };
+	for (size_t k = 0; k < nVectors; ++k)
+	{
+		edges(k, p)[0] = x[k].x[begin];
+		edges(k, p)[1] = x[k].x[end - 1];
+	}
+	team.Barrier();
 
-	for(size_t i = 1; i < N - 1; ++i)
+	std::array<details::CSweepVector<Value>, nVectors> partitionVectors = x;
+	for (auto& v : partitionVectors)
 	{
-		cache[i & 1] = x[i];
-		x[i] = A[i].Get(details::Minus) * cache[(i - 1) & 1] + A[i].Get(details::Zero) * x[i] + A[i].Get(details::Plus) * x[i + 1];
+		v.x += begin;
+		if (v.source != noSource)
+		{
+			v.jacobianSub   += begin;
+			v.jacobianDiag  += begin;
+			v.jacobianSuper += begin;
+		}
 	}
 
-	x[N - 1] = A[N - 1].Get(details::Minus) * cache[(N - 2) & 1] + A[N - 1].Get(details::Zero) * x[N - 1];
+	const Value* unaliased sub = matrix.Get(details::Minus);
+	const Value* unaliased super = matrix.Get(details::Plus);
+	RangeKernels::Dot(sub + begin, matrix.Get(details::Zero) + begin, super + begin, partitionVectors, end - begin);
+
+	// same as the active window, with the saved edges of the neighbours
+	for (size_t k = 0; k < nVectors; ++k)
+	{
+		if (p > 0)
+		{
+			x[k].x[begin] += sub[begin] * edges(k, p - 1)[1];
+			if (x[k].source != noSource)
+				x[k].x[begin] += x[k].jacobianSub[begin] * edges(x[k].source, p - 1)[1];
+		}
+		if (p + 1 < nPartitions)
+		{
+			x[k].x[end - 1] += super[end - 1] * edges(k, p + 1)[0];
+			if (x[k].source != noSource)
+				x[k].x[end - 1] += x[k].jacobianSuper[end - 1] * edges(x[k].source, p + 1)[0];
+		}
+	}
 }
 
-template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-void CTridiagonalOperator<gridType, adjointDifferentiation>::Solve(CPayoffData& unaliased out) noexcept
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Solve(const std::array<PayoffData*, nRhs>& unaliased out, const size_t p,
+		details::CThreadTeam& team, Value* unaliased buffer) const noexcept
 {
 #ifdef DEBUG
-	if (out.payoff_i.size() != N)
+	if (spikeLeft.size() < N || separatorSub.size() < team.size() - 1)
 	{
-		printf("*** WRONG PAYOFF SIZE ***\n");
+		printf("*** OPERATOR NOT PARTITIONED ***\n");
 		return;
 	}
 #endif
 
-	// First we update the payoff
-	Solve(out.payoff_i, matrix);
+	// see Solve
+	std::array<Value*, nRhs * (1 + nUncoupledTangents)> x;
+	SetUncoupledVectors<nRhs>(x, out);
+	PartitionedSolve(x, p, team, buffer);
 
-	// A \cdot x_{n} = x_{n + 1}
-	// Therefore:
-	// A \cdot v_{n} = v_{n + 1} - J \cdot x_{n}
-	switch (adjointDifferentiation)
+	if (!nCoupledTangents)
+		return;
+
+	// the Jacobian terms at the edges of the partition need the updated payoffs of the neighbours
+	team.Barrier();
+
+	const size_t nPartitions = team.size();
+	const size_t begin = PartitionBegin(p, nPartitions);
+	const size_t end = PartitionBegin(p + 1, nPartitions);
+
+	std::array<details::CJacobianTerm<Value>, nRhs * nCoupledTangents> terms;
+	std::array<Value*, nRhs * nCoupledTangents> v;
+	SetJacobianTerms<nRhs>(terms, v, out);
+
+	auto partitionTerms = terms;
+	for (auto& term : partitionTerms)
 	{
-		case EAdjointDifferentiation::Vega:
-			Add(out.vega_i, -1.0, matrixVega, out.payoff_i);
-			Solve(out.vega_i, matrix);
-			break;
-		case EAdjointDifferentiation::Rho:
-			Solve(out.rho_i, matrix);
+		term.out += begin;
+		term.x += begin;
+		term.jacobianSub   += begin;
+		term.jacobianDiag  += begin;
+		term.jacobianSuper += begin;
+	}
 
-			Add(out.rhoBorrow_i, -1.0, matrixRhoBorrow, out.payoff_i);
-			Solve(out.rhoBorrow_i, matrix);
-			break;
-		case EAdjointDifferentiation::All:
-			Add(out.vega_i, -1.0, matrixVega, out.payoff_i);
-			Solve(out.vega_i, matrix);
+	RangeKernels::Add(-1.0, partitionTerms, end - begin);
+	for (const auto& term : terms)
+	{
+		if (p > 0)
+			term.out[begin] -= term.jacobianSub[begin] * term.x[begin - 1];
+		if (p + 1 < nPartitions)
+			term.out[end - 1] -= term.jacobianSuper[end - 1] * term.x[end];
+	}
 
-			Solve(out.rho_i, matrix);
+	PartitionedSolve(v, p, team, buffer);
+}
 
-			Add(out.rhoBorrow_i, -1.0, matrixRhoBorrow, out.payoff_i);
-			Solve(out.rhoBorrow_i, matrix);
-			break;
-		default:
-			break;
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t K>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::PartitionedSolve(const std::array<Value*, K>& unaliased x, const size_t p,
+		details::CThreadTeam& team, Value* unaliased buffer) const noexcept
+{
+	const size_t nPartitions = team.size();
+	const size_t begin = PartitionBegin(p, nPartitions);
+	const size_t end = PartitionBegin(p + 1, nPartitions);
+	const size_t first = p ? begin + 1 : begin;
+	const size_t stride = PartitionStride(nPartitions);
+	const Value* unaliased sub = matrix.Get(details::Minus);
+	const Value* unaliased super = matrix.Get(details::Plus);
+
+	std::array<Value*, K> separators;
+	for (size_t k = 0; k < K; ++k)
+		separators[k] = buffer + k * stride + details::Padded<Value>(2 * nPartitions);
+
+	// y = interior^{-1} \cdot x
+	std::array<Value*, K> interior = x;
+	for (auto& v : interior)
+		v += first;
+	RangeKernels::Solve(interior, sub + first, partitionUpperFactor.data() + first, partitionInversePivot.data() + first, end - first);
+	team.Barrier();
+
+	// the separator system is tiny: one thread solves it for all the vectors
+	if (p == 0)
+	{
+		const size_t nSeparators = nPartitions - 1;
+		for (size_t q = 0; q < nSeparators; ++q)
+		{
+			const size_t s = PartitionBegin(q + 1, nPartitions);
+			for (size_t k = 0; k < K; ++k)
+				separators[k][q] = x[k][s] - sub[s] * x[k][s - 1] - super[s] * x[k][s + 1];
+		}
+
+		RangeKernels::Solve(separators, separatorSub.data(), separatorUpperFactor.data(), separatorInversePivot.data(), nSeparators);
+
+		for (size_t q = 0; q < nSeparators; ++q)
+		{
+			const size_t s = PartitionBegin(q + 1, nPartitions);
+			for (size_t k = 0; k < K; ++k)
+				x[k][s] = separators[k][q];
+		}
+	}
+	team.Barrier();
+
+	// the separators are read from the buffer, as the neighbours may be already done and updating them (e.g. early exercise)
+	std::array<Value, K> left;
+	std::array<Value, K> right;
+	for (size_t k = 0; k < K; ++k)
+	{
+		left[k] = p > 0 ? separators[k][p - 1] : Value(0.0);
+		right[k] = p + 1 < nPartitions ? separators[k][p] : Value(0.0);
+	}
+	RangeKernels::SubtractSpikes(interior, left, right, spikeLeft.data() + first, spikeRight.data() + first, end - first);
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Factorize(const size_t begin, const size_t end, Factor* unaliased upperFactor, Factor* unaliased inversePivot) const noexcept
+{
+	RangeKernels::Factorize(upperFactor, inversePivot, matrix.Get(details::Minus) + begin, matrix.Get(details::Zero) + begin, matrix.Get(details::Plus) + begin, end - begin);
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::SetSweepVectors(std::array<details::CSweepVector<Value>, nRhs * (1 + nUncoupledTangents + nCoupledTangents)>& unaliased x,
+		const std::array<PayoffData*, nRhs>& unaliased out) const noexcept
+{
+	// payoffs first, then the tangents of each input
+	constexpr size_t nTangents = nUncoupledTangents + nCoupledTangents;
+	for (size_t j = 0; j < nRhs; ++j)
+	{
+		details::CSweepVector<Value>* unaliased tangents = x.data() + nRhs + j * nTangents;
+
+		x[j].x = out[j]->payoff_i.data();
+		if (nUncoupledTangents)
+			tangents++->x = out[j]->rho_i.data();
+
+		SetJacobians(tangents, *out[j]);
+		for (size_t k = 0; k < nCoupledTangents; ++k)
+			tangents[k].source = j;
+	}
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Factorize() noexcept
+{
+	upperFactor.resize(details::Padded<Factor>(N));
+	inversePivot.resize(details::Padded<Factor>(N));
+
+	Kernels::Factorize(upperFactor.data(), inversePivot.data(),
+			matrix.Get(details::Minus), matrix.Get(details::Zero), matrix.Get(details::Plus), N);
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::FactorizeReversed() noexcept
+{
+	lowerFactor.resize(details::Padded<Factor>(N));
+	reversedInversePivot.resize(details::Padded<Factor>(N));
+	Kernels::FactorizeReversed(lowerFactor.data(), reversedInversePivot.data(),
+			matrix.Get(details::Minus), matrix.Get(details::Zero), matrix.Get(details::Plus), N);
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::FactorizeCyclicReduction() noexcept
+{
+	reductionFactors.resize(details::CyclicReductionFactorsSize(reductionRows, N));
+	Kernels::template FactorizeCyclicReduction<reductionRows>(reductionFactors.data(), matrix.Get(details::Minus), matrix.Get(details::Zero), matrix.Get(details::Plus), N);
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Partition(const size_t nPartitions) noexcept
+{
+	const Value* unaliased sub = matrix.Get(details::Minus);
+	const Value* unaliased diag = matrix.Get(details::Zero);
+	const Value* unaliased super = matrix.Get(details::Plus);
+
+	partitionUpperFactor.assign(details::Padded<Factor>(N), Factor(0.0));
+	partitionInversePivot.assign(details::Padded<Factor>(N), Factor(0.0));
+	spikeLeft.assign(details::Padded<Value>(N), Value(0.0));
+	spikeRight.assign(details::Padded<Value>(N), Value(0.0));
+
+	for (size_t p = 0; p < nPartitions; ++p)
+	{
+		// the interior is all but the separator the partition starts with
+		const size_t first = p ? PartitionBegin(p, nPartitions) + 1 : 0;
+		const size_t end = PartitionBegin(p + 1, nPartitions);
+		RangeKernels::Factorize(partitionUpperFactor.data() + first, partitionInversePivot.data() + first, sub + first, diag + first, super + first, end - first);
+
+		// the first (last) partition has no separator before (after) it: its spike is left 0
+		if (p > 0)
+		{
+			spikeLeft[first] = sub[first];
+			RangeKernels::Solve(std::array<Value*, 1> { { spikeLeft.data() + first } }, sub + first, partitionUpperFactor.data() + first, partitionInversePivot.data() + first, end - first);
+		}
+		if (p + 1 < nPartitions)
+		{
+			spikeRight[end - 1] = super[end - 1];
+			RangeKernels::Solve(std::array<Value*, 1> { { spikeRight.data() + first } }, sub + first, partitionUpperFactor.data() + first, partitionInversePivot.data() + first, end - first);
+		}
 	}
+
+	// The row of a separator s couples it to the interior points next to it, which depend on the separators around them:
+	// 	x_{s - 1} = y_{s - 1} - x_{previous separator} * spikeLeft_{s - 1} - x_{s} * spikeRight_{s - 1}
+	// 	x_{s + 1} = y_{s + 1} - x_{s} * spikeLeft_{s + 1} - x_{next separator} * spikeRight_{s + 1}
+	// where y is the solution of the interiors alone
+	const size_t nSeparators = nPartitions - 1;
+	details::AlignedVector<Value> separatorDiag(nSeparators);
+	details::AlignedVector<Value> separatorSuper(nSeparators);
+	separatorSub.assign(details::Padded<Value>(nSeparators), Value(0.0));
+	separatorUpperFactor.assign(details::Padded<Value>(nSeparators), Value(0.0));
+	separatorInversePivot.assign(details::Padded<Value>(nSeparators), Value(0.0));
+	for (size_t q = 0; q < nSeparators; ++q)
+	{
+		const size_t s = PartitionBegin(q + 1, nPartitions);
+		separatorSub[q] = -sub[s] * spikeLeft[s - 1];
+		separatorDiag[q] = diag[s] - sub[s] * spikeRight[s - 1] - super[s] * spikeLeft[s + 1];
+		separatorSuper[q] = -super[s] * spikeRight[s + 1];
+	}
+	RangeKernels::Factorize(separatorUpperFactor.data(), separatorInversePivot.data(), separatorSub.data(), separatorDiag.data(), separatorSuper.data(), nSeparators);
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Solve(PayoffData& unaliased out) const noexcept
+{
+	Solve(std::array<PayoffData*, 1> { { &out } });
 }
 
-template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-void CTridiagonalOperator<gridType, adjointDifferentiation>::Solve(std::vector<double>& unaliased x, const details::Matrix& unaliased mat) noexcept
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Solve(const std::array<PayoffData*, nRhs>& unaliased out) const noexcept
 {
 #ifdef DEBUG
-	if (x.size() != N)
+	for (size_t j = 0; j < nRhs; ++j)
+	{
+		if (out[j]->payoff_i.size() != N)
+		{
+			printf("*** WRONG PAYOFF SIZE ***\n");
+			return;
+		}
+	}
+	if (inversePivot.size() < N)
 	{
-		printf("*** WRONG VECTOR SIZE***\n");
+		printf("*** OPERATOR NOT FACTORIZED ***\n");
 		return;
 	}
 #endif
 
-    if (!solve_cache.size())
-    	solve_cache.resize(N);
+	// First we update the payoff (and rho, which is not coupled to it)
+	std::array<Value*, nRhs * (1 + nUncoupledTangents)> x;
+	SetUncoupledVectors<nRhs>(x, out);
+	Kernels::Solve(x, matrix.Get(details::Minus), upperFactor.data(), inversePivot.data(), N);
 
-    for (size_t i = 0; i < N - 1; ++i)
-    	solve_cache[i] = mat[i].Get(details::Plus);
+	SolveCoupled(out);
+}
 
-    solve_cache[0] = mat[0].Get(details::Plus) / mat[0].Get(details::Zero);
-    x[0] = x[0] / mat[0].Get(details::Zero);
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Solve(const std::array<PayoffData*, nRhs>& unaliased out, const details::CExerciseCondition<Value, nRhs>& unaliased exercise) const noexcept
+{
+#ifdef DEBUG
+	for (size_t j = 0; j < nRhs; ++j)
+	{
+		if (inversePivot.size() < N || (exercise.sign[j] < 0.0 && reversedInversePivot.size() < N))
+		{
+			printf("*** OPERATOR NOT FACTORIZED ***\n");
+			return;
+		}
+	}
+#endif
 
-    for (size_t i = 1; i < N; ++i)
-    {
-        const double m = 1.0 / (mat[i].Get(details::Zero) - mat[i].Get(details::Minus) * solve_cache[i - 1]);
-        solve_cache[i] = mat[i].Get(details::Plus) * m;
-        x[i] = (x[i] - mat[i].Get(details::Minus) * x[i - 1]) * m;
-    }
+	// payoff first, then rho: only the payoff is projected
+	for (size_t j = 0; j < nRhs; ++j)
+	{
+		std::array<Value*, 1 + nUncoupledTangents> x;
+		SetUncoupledVectors<1>(x, { { out[j] } });
+
+		const std::array<Value, 1> sign = { { Value(exercise.sign[j]) } };
+		if (exercise.sign[j] > 0.0)
+			Kernels::template ProjectedSolve<false>(x, exercise.intrinsic, sign, matrix.Get(details::Minus), upperFactor.data(), inversePivot.data(), N);
+		else if (exercise.sign[j] < 0.0)
+			Kernels::template ProjectedSolve<true>(x, exercise.intrinsic, sign, matrix.Get(details::Plus), lowerFactor.data(), reversedInversePivot.data(), N);
+		else
+			Kernels::Solve(x, matrix.Get(details::Minus), upperFactor.data(), inversePivot.data(), N);
+	}
 
-    for (size_t i = N - 1; i--> 0 ;)
-        x[i] -= solve_cache[i] * x[i + 1];
+	SolveCoupled(out);
 }
 
-template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation>
-void CTridiagonalOperator<gridType, adjointDifferentiation>::Make(const CInputData& unaliased input, const CGrid<gridType>& unaliased grid) noexcept
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Solve(const std::array<PayoffData*, nRhs>& unaliased out, Value* unaliased buffer) const noexcept
 {
 #ifdef DEBUG
-	if (matrix.size() != N)
+	if (reductionFactors.empty())
 	{
-		printf("WRONG MATRIX SIZE");
+		printf("*** OPERATOR NOT FACTORIZED ***\n");
 		return;
 	}
-	if (grid.size() != N)
+#endif
+
+	// see Solve
+	constexpr size_t nUncoupled = nRhs * (1 + nUncoupledTangents);
+	std::array<Value*, nUncoupled> x;
+	SetUncoupledVectors<nRhs>(x, out);
+	Kernels::template CyclicReductionSolve<nUncoupled, reductionRows>(x, reductionFactors.data(), buffer, N);
+
+	if (!nCoupledTangents)
+		return;
+
+	std::array<details::CJacobianTerm<Value>, nRhs * nCoupledTangents> terms;
+	std::array<Value*, nRhs * nCoupledTangents> v;
+	SetJacobianTerms<nRhs>(terms, v, out);
+
+	Kernels::Add(-1.0, terms, N);
+	Kernels::template CyclicReductionSolve<nRhs * nCoupledTangents, reductionRows>(v, reductionFactors.data(), buffer, N);
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::SolveCoupled(const std::array<PayoffData*, nRhs>& unaliased out) const noexcept
+{
+	if (!nCoupledTangents)
+		return;
+
+	// A \cdot x_{n} = x_{n + 1}
+	// Therefore:
+	// A \cdot v_{n} = v_{n + 1} - J \cdot x_{n}
+	std::array<details::CJacobianTerm<Value>, nRhs * nCoupledTangents> terms;
+	std::array<Value*, nRhs * nCoupledTangents> v;
+	SetJacobianTerms<nRhs>(terms, v, out);
+
+	Kernels::Add(-1.0, terms, N);
+	Kernels::Solve(v, matrix.Get(details::Minus), upperFactor.data(), inversePivot.data(), N);
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::DotSolve(const CTridiagonalOperator& unaliased B, const std::array<PayoffData*, nRhs>& unaliased out) const noexcept
+{
+#ifdef DEBUG
+	for (size_t j = 0; j < nRhs; ++j)
 	{
-		printf("WRONG GRID SIZE: N=%zu, gN=%zu", N, grid.size());
+		if (out[j]->payoff_i.size() != N)
+		{
+			printf("*** WRONG PAYOFF SIZE ***\n");
+			return;
+		}
+	}
+	if (inversePivot.size() < N)
+	{
+		printf("*** OPERATOR NOT FACTORIZED ***\n");
 		return;
 	}
 #endif
-	const double sigma2 = input.sigma * input.sigma;
 
-	// Left BC: zero drift
-	double dx = grid.Get(1) - grid.Get(0);
-	double volatility = sigma2 * grid.Get(0) * grid.Get(0);
-	matrix[0].Set(details::Zero, -volatility / (dx * dx));
-	matrix[0].Set(details::Plus, -matrix[0].Get(details::Zero));
+	// A \cdot x_{n} = B \cdot x_{n + 1}
+	// Therefore:
+	// A \cdot v_{n} = B \cdot v_{n + 1} + J_B \cdot x_{n + 1} - J_A \cdot x_{n}
+	// The first two terms are forward substituted together with the payoff
+	std::array<details::CSweepVector<Value>, nRhs * (1 + nUncoupledTangents + nCoupledTangents)> x;
+	B.template SetSweepVectors<nRhs>(x, out);
+
+	Kernels::DotForwardSubstitute(B.matrix.Get(details::Minus), B.matrix.Get(details::Zero), B.matrix.Get(details::Plus), x,
+			matrix.Get(details::Minus), inversePivot.data(), N);
+
+	std::array<Value*, nRhs * (1 + nUncoupledTangents)> uncoupled;
+	SetUncoupledVectors<nRhs>(uncoupled, out);
+	Kernels::BackSubstitute(uncoupled, upperFactor.data(), N);
+
+	if (!nCoupledTangents)
+		return;
+
+	// Now that x_{n} is known, forward substitute the last term as well
+	std::array<details::CJacobianTerm<Value>, nRhs * nCoupledTangents> terms;
+	std::array<Value*, nRhs * nCoupledTangents> v;
+	SetJacobianTerms<nRhs>(terms, v, out);
+
+	Kernels::AddForwardSubstitute(-1.0, terms, matrix.Get(details::Minus), inversePivot.data(), N);
+	Kernels::BackSubstitute(v, upperFactor.data(), N);
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::DotSolve(const CTridiagonalOperator& unaliased B, const std::array<PayoffData*, nRhs>& unaliased out,
+		const details::CExerciseCondition<Value, nRhs>& unaliased exercise) const noexcept
+{
+#ifdef DEBUG
+	for (size_t j = 0; j < nRhs; ++j)
+	{
+		if (inversePivot.size() < N || (exercise.sign[j] < 0.0 && reversedInversePivot.size() < N))
+		{
+			printf("*** OPERATOR NOT FACTORIZED ***\n");
+			return;
+		}
+	}
+#endif
+
+	for (size_t j = 0; j < nRhs; ++j)
+	{
+		if (exercise.sign[j] < 0.0)
+			ProjectedDotSolve<true>(B, out[j], exercise.intrinsic, Value(exercise.sign[j]), matrix.Get(details::Plus), lowerFactor.data(), reversedInversePivot.data());
+		else
+			ProjectedDotSolve<false>(B, out[j], exercise.intrinsic, Value(exercise.sign[j]), matrix.Get(details::Minus), upperFactor.data(), inversePivot.data());
+	}
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<bool reversed>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::ProjectedDotSolve(const CTridiagonalOperator& unaliased B, PayoffData* unaliased out,
+		const Value* unaliased intrinsic, const Value sign, const Value* unaliased coupling, const Factor* unaliased factor, const Factor* unaliased inversePivot) const noexcept
+{
+	// same as DotSolve, in the direction of the exercise region
+	std::array<details::CSweepVector<Value>, 1 + nUncoupledTangents + nCoupledTangents> x;
+	B.template SetSweepVectors<1>(x, { { out } });
+
+	Kernels::template DotForwardSubstitute<reversed>(B.matrix.Get(details::Minus), B.matrix.Get(details::Zero), B.matrix.Get(details::Plus), x, coupling, inversePivot, N);
+
+	// payoff first, then rho: only the payoff is projected
+	std::array<Value*, 1 + nUncoupledTangents> uncoupled;
+	SetUncoupledVectors<1>(uncoupled, { { out } });
+	if (sign != Value(0.0))
+		Kernels::template ProjectedBackSubstitute<reversed>(uncoupled, intrinsic, std::array<Value, 1> { { sign } }, factor, N);
+	else
+		Kernels::template BackSubstitute<reversed>(uncoupled, factor, N);
+
+	if (!nCoupledTangents)
+		return;
+
+	std::array<details::CJacobianTerm<Value>, nCoupledTangents> terms;
+	std::array<Value*, nCoupledTangents> v;
+	SetJacobianTerms<1>(terms, v, { { out } });
+
+	Kernels::template AddForwardSubstitute<reversed>(-1.0, terms, coupling, inversePivot, N);
+	Kernels::template BackSubstitute<reversed>(v, factor, N);
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::SetUncoupledVectors(std::array<Value*, nRhs * (1 + nUncoupledTangents)>& unaliased x,
+		const std::array<PayoffData*, nRhs>& unaliased out) const noexcept
+{
+	for (size_t j = 0; j < nRhs; ++j)
+	{
+		x[j] = out[j]->payoff_i.data();
+		if (nUncoupledTangents)
+			x[nRhs + j] = out[j]->rho_i.data();
+	}
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+template<size_t nRhs>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::SetJacobianTerms(std::array<details::CJacobianTerm<Value>, nRhs * nCoupledTangents>& unaliased terms,
+		std::array<Value*, nRhs * nCoupledTangents>& unaliased v, const std::array<PayoffData*, nRhs>& unaliased out) const noexcept
+{
+	std::array<details::CSweepVector<Value>, nRhs * nCoupledTangents> tangents;
+	for (size_t j = 0; j < nRhs; ++j)
+		SetJacobians(tangents.data() + j * nCoupledTangents, *out[j]);
+
+	// the Jacobian is applied to the updated payoff
+	for (size_t k = 0; k < tangents.size(); ++k)
+	{
+		terms[k].out = v[k] = tangents[k].x;
+		terms[k].x = out[k / nCoupledTangents]->payoff_i.data();
+		terms[k].jacobianSub   = tangents[k].jacobianSub;
+		terms[k].jacobianDiag  = tangents[k].jacobianDiag;
+		terms[k].jacobianSuper = tangents[k].jacobianSuper;
+	}
+}
 
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::SetJacobians(details::CSweepVector<Value>* unaliased tangents, PayoffData& unaliased out) const noexcept
+{
 	switch (adjointDifferentiation)
 	{
 		case EAdjointDifferentiation::Vega:
+			SetJacobian(tangents[0], out.vega_i.data(), matrixVega);
+			break;
+		case EAdjointDifferentiation::Rho:
+			SetJacobian(tangents[0], out.rhoBorrow_i.data(), matrixRhoBorrow);
+			break;
 		case EAdjointDifferentiation::All:
-			{
-				const double dVolDSigma = 2.0 * input.sigma * grid.Get(0) * grid.Get(0);
-				matrixVega[0].Set(details::Zero, -dVolDSigma / (dx * dx));
-				matrixVega[0].Set(details::Plus, -matrixVega[0].Get(details::Zero));
-			}
+			SetJacobian(tangents[0], out.vega_i.data(), matrixVega);
+			SetJacobian(tangents[1], out.rhoBorrow_i.data(), matrixRhoBorrow);
 			break;
 		default:
 			break;
 	}
+}
 
-	for (size_t i = 1; i < N - 1; ++i)
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::SetJacobian(details::CSweepVector<Value>& unaliased tangent, Value* unaliased x, const details::Matrix<fixedN, Value>& unaliased J) const noexcept
+{
+	tangent.x = x;
+	tangent.jacobianSub   = J.Get(details::Minus);
+	tangent.jacobianDiag  = J.Get(details::Zero);
+	tangent.jacobianSuper = J.Get(details::Plus);
+}
+
+template<EGridType gridType, EAdjointDifferentiation adjointDifferentiation, size_t fixedN, EPrecision precision>
+void CTridiagonalOperator<gridType, adjointDifferentiation, fixedN, precision>::Make(const CInputData& unaliased input, const CGrid<gridType>& unaliased grid) noexcept
+{
+#ifdef DEBUG
+	if (matrix.size() != N)
+	{
+		printf("WRONG MATRIX SIZE");
+		return;
+	}
+	if (grid.size() != N)
 	{
-		const double dxPlus  = grid.Get(i + 1) - grid.Get(i);
-		const double dxMinus = grid.Get(i)     - grid.Get(i - 1);
-		const double dx = dxPlus + dxMinus;
+		printf("WRONG GRID SIZE: N=%zu, gN=%zu", N, grid.size());
+		return;
+	}
+#endif
+	const double sigma2 = input.sigma * input.sigma;
+	const details::CStencilWeights<>& unaliased weights = grid.GetStencilWeights();
+	const double* unaliased volatilitySub   = weights.volatilitySub.data();
+	const double* unaliased volatilitySuper = weights.volatilitySuper.data();
+	const double* unaliased driftSub   = weights.driftSub.data();
+	const double* unaliased driftSuper = weights.driftSuper.data();
 
-		const double drift = input.b * grid.Get(i);
-		const double volatility = sigma2 * grid.Get(i) * grid.Get(i);
+	Value* unaliased sub   = matrix.Get(details::Minus);
+	Value* unaliased diag  = matrix.Get(details::Zero);
+	Value* unaliased super = matrix.Get(details::Plus);
 
-		matrix[i].Set(details::Minus, (-dxPlus * drift + volatility) / (dxMinus * dx));
-		matrix[i].Set(details::Plus,  (dxMinus * drift + volatility) / (dxPlus  * dx));
+	// the grid-only pieces are cached by the grid: boundary rows have zero drift weights
+	for (size_t i = 0; i < N; ++i)
+	{
+		sub[i]   = Value(sigma2 * volatilitySub[i]   - input.b * driftSub[i]);
+		super[i] = Value(sigma2 * volatilitySuper[i] + input.b * driftSuper[i]);
+		diag[i]  = -sub[i] - super[i];
+	}
 
-		#ifdef DEBUG
+	#ifdef DEBUG
 
-		if (matrix[i].Get(details::Minus) <= 0.0)
+	for (size_t i = 1; i < N - 1; ++i)
+	{
+		if (sub[i] <= 0.0)
 		{
-			printf("******* Up factor too big(%g): increase grid size, mu=%g sigma^2=%g *******\n", matrix[i].Get(details::Minus), drift, volatility);
+			printf("******* Up factor too big(%g): increase grid size, b=%g sigma^2=%g *******\n", sub[i], input.b, sigma2);
 			return;
 		}
-		if (matrix[i].Get(details::Plus) <= 0.0)
+		if (super[i] <= 0.0)
 		{
-			printf("******* Down factor too big(%g): increase grid size, mu=%g sigma^2=%g *******\n", matrix[i].Get(details::Plus), drift, volatility);
+			printf("******* Down factor too big(%g): increase grid size, b=%g sigma^2=%g *******\n", super[i], input.b, sigma2);
 			return;
 		}
+	}
 
-		#endif
+	#endif
 
-		matrix[i].Set(details::Zero, -matrix[i].Get(details::Minus) - matrix[i].Get(details::Plus));
+	switch (adjointDifferentiation)
+	{
+		case EAdjointDifferentiation::Vega:
+		case EAdjointDifferentiation::All:
+			{
+				Value* unaliased vegaSub   = matrixVega.Get(details::Minus);
+				Value* unaliased vegaDiag  = matrixVega.Get(details::Zero);
+				Value* unaliased vegaSuper = matrixVega.Get(details::Plus);
 
-		switch (adjointDifferentiation)
-		{
-			case EAdjointDifferentiation::Vega:
+				const double dVolDSigma = 2.0 * input.sigma;
+				for (size_t i = 0; i < N; ++i)
 				{
-					const double dVolDSigma = 2.0 * input.sigma * grid.Get(i) * grid.Get(i);
-					matrixVega[i].Set(details::Minus, dVolDSigma / (dxMinus * dx));
-					matrixVega[i].Set(details::Plus,  dVolDSigma / (dxPlus * dx));
-					matrixVega[i].Set(details::Zero, -matrixVega[i].Get(details::Minus) - matrixVega[i].Get(details::Plus));
+					vegaSub[i]   = Value(dVolDSigma * volatilitySub[i]);
+					vegaSuper[i] = Value(dVolDSigma * volatilitySuper[i]);
+					vegaDiag[i]  = -vegaSub[i] - vegaSuper[i];
 				}
-				break;
-			case EAdjointDifferentiation::Rho:
-					matrixRhoBorrow[i].Set(details::Minus, -dxPlus  * grid.Get(i) / (dxMinus * dx));
-					matrixRhoBorrow[i].Set(details::Plus,   dxMinus * grid.Get(i) / (dxPlus * dx));
-					matrixRhoBorrow[i].Set(details::Zero, -matrixRhoBorrow[i].Get(details::Minus) - matrixRhoBorrow[i].Get(details::Plus));
-				break;
-			case EAdjointDifferentiation::All:
-				{
-					const double dVolDSigma = 2.0 * input.sigma * grid.Get(i) * grid.Get(i);
-					matrixVega[i].Set(details::Minus, dVolDSigma / (dxMinus * dx));
-					matrixVega[i].Set(details::Plus,  dVolDSigma / (dxPlus * dx));
-					matrixVega[i].Set(details::Zero, -matrixVega[i].Get(details::Minus) - matrixVega[i].Get(details::Plus));
-
-					matrixRhoBorrow[i].Set(details::Minus, -dxPlus  * grid.Get(i) / (dxMinus * dx));
-					matrixRhoBorrow[i].Set(details::Plus,   dxMinus * grid.Get(i) / (dxPlus * dx));
-					matrixRhoBorrow[i].Set(details::Zero, -matrixRhoBorrow[i].Get(details::Minus) - matrixRhoBorrow[i].Get(details::Plus));
-				}
-				break;
-			default:
-				break;
-		}
-	}
 
-	// Right BC: zero drift
-	dx = grid.Get(N - 1) - grid.Get(N - 2);
-	volatility = sigma2 * grid.Get(N - 1) * grid.Get(N - 1);
-	matrix[N - 1].Set(details::Zero, -volatility / (dx * dx));
-	matrix[N - 1].Set(details::Minus, -matrix[N - 1].Get(details::Zero));
+				// Right BC: only the diagonal takes part in the products
+				vegaSuper[N - 1] = -vegaDiag[N - 1];
+				vegaSub[N - 1] = Value(0.0);
+			}
+			break;
+		default:
+			break;
+	}
 
 	switch (adjointDifferentiation)
 	{
-		case EAdjointDifferentiation::Vega:
+		case EAdjointDifferentiation::Rho:
 		case EAdjointDifferentiation::All:
 			{
-				const double dVolDSigma = 2.0 * input.sigma * grid.Get(N - 1) * grid.Get(N - 1);
-				matrixVega[N - 1].Set(details::Zero, -dVolDSigma / (dx * dx));
-				matrixVega[N - 1].Set(details::Plus, -matrixVega[N - 1].Get(details::Zero));
+				Value* unaliased rhoBorrowSub   = matrixRhoBorrow.Get(details::Minus);
+				Value* unaliased rhoBorrowDiag  = matrixRhoBorrow.Get(details::Zero);
+				Value* unaliased rhoBorrowSuper = matrixRhoBorrow.Get(details::Plus);
+
+				for (size_t i = 0; i < N; ++i)
+				{
+					rhoBorrowSub[i]   = Value(-driftSub[i]);
+					rhoBorrowSuper[i] = Value(driftSuper[i]);
+					rhoBorrowDiag[i]  = -rhoBorrowSub[i] - rhoBorrowSuper[i];
+				}
 			}
 			break;
 		default:
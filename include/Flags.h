@@ -13,6 +13,14 @@
  */
 //#define DEBUG
 
+/**
+ * Feed the allocation counter (see CAllocationCounter), and have the tests replace the global operator new for it.
+ * It's on in the unoptimized (debug) builds, and can be defined on the command line for the others
+ */
+#if !defined(COUNT_ALLOCATIONS) && !defined(__OPTIMIZE__)
+	#define COUNT_ALLOCATIONS
+#endif
+
 /**
  * Tells compilers that pointers are not aliased
  */
@@ -0,0 +1,127 @@
+/*
+ * CAlignedAllocator.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef UTILITIES_CALIGNEDALLOCATOR_H_
+#define UTILITIES_CALIGNEDALLOCATOR_H_
+
+#include <vector>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <stdlib.h>
+#include <stddef.h>
+
+#include <Utilities/CArena.h>
+#include <Utilities/CAllocationCounter.h>
+#include <Flags.h>
+
+namespace details
+{
+
+/**
+ * Cache line size: every aligned buffer starts at a multiple of this and is padded to a multiple of it
+ */
+static constexpr size_t cacheLineSize = 64;
+
+/**
+ * Number of elements needed for padding n elements to a whole number of cache lines
+ */
+template<typename T>
+constexpr size_t Padded(const size_t n) noexcept
+{
+	return ((n * sizeof(T) + cacheLineSize - 1) / cacheLineSize) * cacheLineSize / sizeof(T);
+}
+
+static_assert(CArena::alignment % cacheLineSize == 0, "Arena allocations must be cache line aligned");
+
+/**
+ * Minimal STL allocator returning cache line aligned memory.
+ * It draws from the arena of the thread that built it (see CArenaScope), or from the heap if there is none:
+ * a copied container takes the arena of the thread copying it, a moved one keeps its own.
+ */
+template<typename T>
+class CAlignedAllocator
+{
+public:
+	typedef T value_type;
+	typedef std::true_type propagate_on_container_move_assignment;
+	typedef std::true_type propagate_on_container_swap;
+
+	CAlignedAllocator() noexcept
+		: arena(CArena::Current())
+	{
+	}
+
+	template<typename U>
+	CAlignedAllocator(const CAlignedAllocator<U>& rhs) noexcept
+		: arena(rhs.arena)
+	{
+	}
+
+	CAlignedAllocator select_on_container_copy_construction() const noexcept
+	{
+		return CAlignedAllocator();
+	}
+
+	T* allocate(const size_t n)
+	{
+		if (arena)
+			return static_cast<T*>(arena->Allocate(Padded<T>(n) * sizeof(T)));
+
+		void* ptr = nullptr;
+		if (posix_memalign(&ptr, cacheLineSize, Padded<T>(n) * sizeof(T)))
+			throw std::bad_alloc();
+#ifdef COUNT_ALLOCATIONS
+		++CAllocationCounter::Count();
+#endif
+
+		return static_cast<T*>(ptr);
+	}
+
+	void deallocate(T* ptr, const size_t n) noexcept
+	{
+		if (arena)
+			arena->Deallocate(ptr, Padded<T>(n) * sizeof(T));
+		else
+			free(ptr);
+	}
+
+	template<typename U>
+	bool operator==(const CAlignedAllocator<U>& rhs) const noexcept
+	{
+		return arena == rhs.arena;
+	}
+
+	template<typename U>
+	bool operator!=(const CAlignedAllocator<U>& rhs) const noexcept
+	{
+		return arena != rhs.arena;
+	}
+
+private:
+	template<typename U>
+	friend class CAlignedAllocator;
+
+	CArena* arena;
+};
+
+template<typename T>
+using AlignedVector = std::vector<T, CAlignedAllocator<T>>;
+
+/**
+ * std::make_shared counterpart: object and reference count come from the arena of the current thread, if any
+ */
+template<typename T, typename... Args>
+std::shared_ptr<T> MakeShared(Args&&... args)
+{
+	return std::allocate_shared<T>(CAlignedAllocator<typename std::remove_const<T>::type>(), std::forward<Args>(args)...);
+}
+
+}
+
+#endif /* UTILITIES_CALIGNEDALLOCATOR_H_ */
@@ -0,0 +1,36 @@
+/*
+ * CAllocationCounter.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef UTILITIES_CALLOCATIONCOUNTER_H_
+#define UTILITIES_CALLOCATIONCOUNTER_H_
+
+#include <stddef.h>
+
+#include <Flags.h>
+
+namespace details
+{
+
+/**
+ * Debug counter of the heap allocations made by the current thread: it counts the aligned buffers not served by an arena
+ * and, where the global operator new is replaced (see TestFDPricer.cpp), any other heap allocation.
+ * It's fed only when COUNT_ALLOCATIONS is defined (see Flags.h), so that release builds do not pay for it on every allocation.
+ * Per thread, so that it does not become a contention point itself
+ */
+class CAllocationCounter
+{
+public:
+	static size_t& Count() noexcept
+	{
+		static thread_local size_t count = 0;
+		return count;
+	}
+};
+
+}
+
+#endif /* UTILITIES_CALLOCATIONCOUNTER_H_ */
@@ -0,0 +1,200 @@
+/*
+ * CArena.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef UTILITIES_CARENA_H_
+#define UTILITIES_CARENA_H_
+
+#include <vector>
+#include <new>
+#include <algorithm>
+#include <stdlib.h>
+#include <stddef.h>
+
+#include <Utilities/CAllocationCounter.h>
+#include <Flags.h>
+
+namespace details
+{
+
+/**
+ * Monotonic arena: allocating is a pointer bump, and the memory is given back all at once by Reset.
+ * Once it has seen the largest option, pricing does not touch the heap anymore: Reset merges the blocks allocated
+ * while warming up into a single one, that fits all the following options.
+ *
+ * It's meant to be used by a single thread, through CArenaScope
+ */
+class CArena
+{
+public:
+	/**
+	 * Every allocation is cache line aligned, see CAlignedAllocator
+	 */
+	static constexpr size_t alignment = 64;
+
+	/**
+	 * capacity: initial size in bytes, it grows on demand
+	 */
+	explicit CArena(const size_t capacity = 0)
+		: top(nullptr), end(nullptr), used(0), totalCapacity(0)
+	{
+		if (capacity)
+			AddBlock(capacity);
+	}
+
+	CArena(const CArena& rhs) = delete;
+	CArena& operator=(const CArena& rhs) = delete;
+
+	~CArena() noexcept
+	{
+		Release();
+	}
+
+	void* Allocate(const size_t bytes)
+	{
+		const size_t size = Align(bytes);
+		if (static_cast<size_t>(end - top) < size)
+			AddBlock(std::max(size, 2 * totalCapacity));
+
+		void* ptr = top;
+		top += size;
+		used += size;
+
+		return ptr;
+	}
+
+	/**
+	 * Only the last allocation is given back (e.g. scratch buffers): anything else waits for Reset
+	 */
+	void Deallocate(void* ptr, const size_t bytes) noexcept
+	{
+		const size_t size = Align(bytes);
+		if (static_cast<char*>(ptr) + size == top)
+		{
+			top -= size;
+			used -= size;
+		}
+	}
+
+	/**
+	 * Give back all the memory: whatever has been allocated from this arena must not be used anymore
+	 */
+	void Reset()
+	{
+		if (blocks.size() > 1)
+		{
+			const size_t capacity = totalCapacity;
+			Release();
+			AddBlock(capacity);
+		}
+		else if (!blocks.empty())
+			top = blocks.front().begin;
+
+		used = 0;
+	}
+
+	/**
+	 * Bytes currently allocated
+	 */
+	size_t size() const noexcept
+	{
+		return used;
+	}
+
+	size_t capacity() const noexcept
+	{
+		return totalCapacity;
+	}
+
+	/**
+	 * Arena used by the current thread, if any: see CArenaScope
+	 */
+	static CArena*& Current() noexcept
+	{
+		static thread_local CArena* current = nullptr;
+		return current;
+	}
+
+private:
+	struct CBlock
+	{
+		char* begin;
+		size_t size;
+	};
+
+	std::vector<CBlock> blocks;
+
+	char* top;
+	char* end;
+	size_t used;
+	size_t totalCapacity;
+
+	static size_t Align(const size_t bytes) noexcept
+	{
+		return ((std::max<size_t>(bytes, 1) + alignment - 1) / alignment) * alignment;
+	}
+
+	void AddBlock(const size_t bytes)
+	{
+		const size_t size = Align(bytes);
+
+		void* ptr = nullptr;
+		if (posix_memalign(&ptr, alignment, size))
+			throw std::bad_alloc();
+#ifdef COUNT_ALLOCATIONS
+		++CAllocationCounter::Count();
+#endif
+
+		blocks.push_back(CBlock { static_cast<char*>(ptr), size });
+		top = static_cast<char*>(ptr);
+		end = top + size;
+		totalCapacity += size;
+	}
+
+	void Release() noexcept
+	{
+		for (auto& block : blocks)
+			free(block.begin);
+		blocks.clear();
+
+		top = end = nullptr;
+		totalCapacity = 0;
+	}
+};
+
+/**
+ * Makes arena the current thread one until the end of the scope, then resets it: the containers built within the scope
+ * have to be destroyed by then. The same arena must not be used by nested scopes.
+ *
+ * A null arena makes the scope allocate from the heap, e.g. for building objects that outlive the current arena
+ */
+class CArenaScope
+{
+public:
+	explicit CArenaScope(CArena* arena) noexcept
+		: arena(arena), previous(CArena::Current())
+	{
+		CArena::Current() = arena;
+	}
+
+	CArenaScope(const CArenaScope& rhs) = delete;
+	CArenaScope& operator=(const CArenaScope& rhs) = delete;
+
+	~CArenaScope()
+	{
+		CArena::Current() = previous;
+		if (arena)
+			arena->Reset();
+	}
+
+private:
+	CArena* const arena;
+	CArena* const previous;
+};
+
+}
+
+#endif /* UTILITIES_CARENA_H_ */
@@ -0,0 +1,114 @@
+/*
+ * CFixedVector.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef UTILITIES_CFIXEDVECTOR_H_
+#define UTILITIES_CFIXEDVECTOR_H_
+
+#include <array>
+#include <stdio.h>
+#include <stddef.h>
+
+#include <Utilities/CAlignedAllocator.h>
+#include <Flags.h>
+
+namespace details
+{
+
+/**
+ * Cache line aligned std::array with the subset of the std::vector interface used by the pricer:
+ * the size is known at compile time and the storage lives wherever the owner does (e.g. on the stack).
+ * It is padded like the AlignedVector buffers, so that the SIMD kernels can be used unchanged
+ */
+template<typename T, size_t N>
+class CFixedVector
+{
+public:
+	CFixedVector() noexcept : data_() {};
+
+	/**
+	 * The size is fixed: this only checks that the requested one fits
+	 */
+	void resize(const size_t n, const T& = T()) noexcept
+	{
+#ifdef DEBUG
+		if (n > data_.size())
+			printf("*** WRONG FIXED VECTOR SIZE: %zu(%zu) ***\n", n, N);
+#else
+		(void)n;
+#endif
+	}
+
+	static constexpr size_t size() noexcept
+	{
+		return N;
+	}
+
+	T* data() noexcept
+	{
+		return data_.data();
+	}
+
+	const T* data() const noexcept
+	{
+		return data_.data();
+	}
+
+	T& operator[](const size_t i) noexcept
+	{
+		return data_[i];
+	}
+
+	const T& operator[](const size_t i) const noexcept
+	{
+		return data_[i];
+	}
+
+	T* begin() noexcept
+	{
+		return data();
+	}
+
+	T* end() noexcept
+	{
+		return data() + N;
+	}
+
+	const T* begin() const noexcept
+	{
+		return data();
+	}
+
+	const T* end() const noexcept
+	{
+		return data() + N;
+	}
+
+private:
+	alignas(cacheLineSize) std::array<T, Padded<T>(N)> data_;
+};
+
+/**
+ * Storage used by the fixed size specializations: fixedN = 0 means that the size is only known at run time
+ */
+template<typename T, size_t fixedN>
+struct CStorageSelector
+{
+	typedef CFixedVector<T, fixedN> Type;
+};
+
+template<typename T>
+struct CStorageSelector<T, 0>
+{
+	typedef AlignedVector<T> Type;
+};
+
+template<typename T, size_t fixedN>
+using Storage = typename CStorageSelector<T, fixedN>::Type;
+
+}
+
+#endif /* UTILITIES_CFIXEDVECTOR_H_ */
@@ -0,0 +1,182 @@
+/*
+ * CInstructionSet.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef UTILITIES_CINSTRUCTIONSET_H_
+#define UTILITIES_CINSTRUCTIONSET_H_
+
+#include <type_traits>
+#include <stddef.h>
+
+#include <Utilities/CSimd.h>
+#include <Flags.h>
+
+/**
+ * Run time dispatch needs the GCC/Clang target attributes and the CPUID builtins: elsewhere only the baseline variant is built
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define INSTRUCTION_SET_DISPATCH
+#endif
+
+/**
+ * All the variants give the same results as the baseline, so that prices do not depend on the machine:
+ * GCC would otherwise contract multiplications and additions into FMA's as soon as the instruction set has them
+ */
+#if defined(__clang__)
+	#define NO_FP_CONTRACTION
+#else
+	#define NO_FP_CONTRACTION optimize("fp-contract=off")
+#endif
+
+/**
+ * Instruction set the hot kernels are compiled for. Sse2 is the baseline, i.e. whatever the binary is compiled with
+ */
+enum class EInstructionSet
+{
+	Sse2,
+	Avx2,
+	Avx512
+};
+
+namespace details
+{
+
+template<EInstructionSet instructionSet>
+struct CInstructionSetTraits
+{
+};
+
+template<>
+struct CInstructionSetTraits<EInstructionSet::Sse2>
+{
+	static constexpr size_t registerSize = SIMD_REGISTER_SIZE;
+	static constexpr const char* name = "SSE2";
+};
+
+template<>
+struct CInstructionSetTraits<EInstructionSet::Avx2>
+{
+	static constexpr size_t registerSize = SIMD_REGISTER_SIZE > 32 ? SIMD_REGISTER_SIZE : 32;
+	static constexpr const char* name = "AVX2";
+};
+
+template<>
+struct CInstructionSetTraits<EInstructionSet::Avx512>
+{
+	static constexpr size_t registerSize = 64;
+	static constexpr const char* name = "AVX-512";
+};
+
+/**
+ * The variant of the kernels to run is picked once at startup from CPUID: Dispatch calls worker(instructionSet), where instructionSet
+ * is a std::integral_constant, from a function compiled for that instruction set with everything it calls inlined (flatten).
+ * Hence the worker has to be a header-only function of instructionSet: anything it calls out of line runs the baseline code.
+ */
+template<typename = void>
+class CInstructionSetDispatcher
+{
+public:
+	static EInstructionSet Get() noexcept
+	{
+		return selected;
+	}
+
+	/**
+	 * Force a variant (e.g. for testing or profiling), if the CPU supports it. Not thread safe: call it before pricing
+	 */
+	static bool Set(const EInstructionSet instructionSet) noexcept
+	{
+		if (!IsSupported(instructionSet))
+			return false;
+
+		selected = instructionSet;
+		return true;
+	}
+
+	/**
+	 * Best variant supported by this CPU
+	 */
+	static EInstructionSet Detect() noexcept
+	{
+		#ifdef INSTRUCTION_SET_DISPATCH
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx512f"))
+				return EInstructionSet::Avx512;
+			if (__builtin_cpu_supports("avx2"))
+				return EInstructionSet::Avx2;
+		#endif
+
+		return EInstructionSet::Sse2;
+	}
+
+	static bool IsSupported(const EInstructionSet instructionSet) noexcept
+	{
+		return static_cast<int>(instructionSet) <= static_cast<int>(Detect());
+	}
+
+	static const char* ToString(const EInstructionSet instructionSet) noexcept
+	{
+		switch (instructionSet)
+		{
+			case EInstructionSet::Sse2:
+				return CInstructionSetTraits<EInstructionSet::Sse2>::name;
+			case EInstructionSet::Avx2:
+				return CInstructionSetTraits<EInstructionSet::Avx2>::name;
+			case EInstructionSet::Avx512:
+				return CInstructionSetTraits<EInstructionSet::Avx512>::name;
+			default:
+				return "";
+		}
+	}
+
+	template<typename Worker>
+	static void Dispatch(Worker&& worker) noexcept
+	{
+		switch (selected)
+		{
+			#ifdef INSTRUCTION_SET_DISPATCH
+			case EInstructionSet::Avx512:
+				InvokeAvx512(worker);
+				break;
+			case EInstructionSet::Avx2:
+				InvokeAvx2(worker);
+				break;
+			#endif
+			default:
+				worker(std::integral_constant<EInstructionSet, EInstructionSet::Sse2>());
+				break;
+		}
+	}
+
+private:
+	/**
+	 * Initialized before main: until then (i.e. from other static initializers) it's the baseline, which is always safe
+	 */
+	static EInstructionSet selected;
+
+	#ifdef INSTRUCTION_SET_DISPATCH
+	template<typename Worker>
+	__attribute__((target("avx2"), NO_FP_CONTRACTION, flatten)) static void InvokeAvx2(Worker& unaliased worker) noexcept
+	{
+		worker(std::integral_constant<EInstructionSet, EInstructionSet::Avx2>());
+	}
+
+	template<typename Worker>
+	__attribute__((target("avx512f"), NO_FP_CONTRACTION, flatten)) static void InvokeAvx512(Worker& unaliased worker) noexcept
+	{
+		worker(std::integral_constant<EInstructionSet, EInstructionSet::Avx512>());
+	}
+	#endif
+};
+
+template<typename T>
+EInstructionSet CInstructionSetDispatcher<T>::selected = CInstructionSetDispatcher<T>::Detect();
+
+typedef CInstructionSetDispatcher<> CInstructionSet;
+
+}
+
+#endif /* UTILITIES_CINSTRUCTIONSET_H_ */
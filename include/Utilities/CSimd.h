@@ -0,0 +1,126 @@
+/*
+ * CSimd.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef UTILITIES_CSIMD_H_
+#define UTILITIES_CSIMD_H_
+
+#include <cstring>
+#include <array>
+#include <stddef.h>
+
+#include <Flags.h>
+
+/**
+ * Width (in bytes) of the widest vector register enabled at compile time
+ */
+#if defined(__AVX512F__)
+	#define SIMD_REGISTER_SIZE 64
+#elif defined(__AVX__)
+	#define SIMD_REGISTER_SIZE 32
+#else
+	#define SIMD_REGISTER_SIZE 16
+#endif
+
+namespace details
+{
+
+/**
+ * Packs wider than the baseline registers are only used by the kernels compiled for a wider instruction set (see CInstructionSet),
+ * where they are inlined: no function taking or returning them is ever exported, hence GCC's ABI warnings do not apply.
+ * It can't be a push/pop, as the kernels are instantiated (and warned about) at the end of the translation unit.
+ * Clang and Intel don't emit them
+ */
+#if defined(__GNUC__) && !defined(__clang__) && !defined(__INTEL_COMPILER)
+	#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+/**
+ * Thin wrapper around GCC/Clang vector extensions: arithmetic operators work lane-wise,
+ * loads and stores go through memcpy so that they compile to unaligned moves
+ */
+template<typename T, size_t registerSize=SIMD_REGISTER_SIZE>
+struct CPack
+{
+	static constexpr size_t width = registerSize / sizeof(T);
+
+	typedef T Type __attribute__((vector_size(registerSize)));
+
+	static inline Type Load(const T* unaliased ptr) noexcept
+	{
+		Type ret;
+		std::memcpy(&ret, ptr, sizeof(Type));
+		return ret;
+	}
+
+	static inline void Store(T* unaliased ptr, const Type& value) noexcept
+	{
+		std::memcpy(ptr, &value, sizeof(Type));
+	}
+
+	static inline Type Broadcast(const T value) noexcept
+	{
+		Type ret = { };
+		return ret + value;
+	}
+};
+
+/**
+ * Degenerate pack for element types which are vectors already, e.g. several options interleaved lane by lane:
+ * the kernels then advance all the lanes with each instruction
+ */
+template<typename T>
+struct CScalarPack
+{
+	static constexpr size_t width = 1;
+
+	typedef T Type;
+
+	static inline Type Load(const T* unaliased ptr) noexcept
+	{
+		return *ptr;
+	}
+
+	static inline void Store(T* unaliased ptr, const Type& value) noexcept
+	{
+		*ptr = value;
+	}
+
+	static inline Type Broadcast(const T value) noexcept
+	{
+		return value;
+	}
+};
+
+/**
+ * Lane by lane layout of Pack::width arrays of N elements: out[i][l] = in[l][i]
+ */
+template<typename Pack, typename T>
+inline void Interleave(typename Pack::Type* unaliased out, const std::array<const T*, Pack::width>& unaliased in, const size_t N) noexcept
+{
+	for (size_t i = 0; i < N; ++i)
+	{
+		for (size_t l = 0; l < Pack::width; ++l)
+			out[i][l] = in[l][i];
+	}
+}
+
+/**
+ * Inverse of Interleave: out[l][i] = in[i][l]
+ */
+template<typename Pack, typename T>
+inline void Deinterleave(const std::array<T*, Pack::width>& unaliased out, const typename Pack::Type* unaliased in, const size_t N) noexcept
+{
+	for (size_t i = 0; i < N; ++i)
+	{
+		for (size_t l = 0; l < Pack::width; ++l)
+			out[l][i] = in[i][l];
+	}
+}
+
+}
+
+#endif /* UTILITIES_CSIMD_H_ */
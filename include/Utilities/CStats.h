@@ -9,6 +9,12 @@
 #define UTILITIES_CSTATS_H_
 
 #include <cmath>
+#include <stddef.h>
+
+#include <Data/EAccuracy.h>
+#include <Utilities/CInstructionSet.h>
+#include <Utilities/CStatsKernels.h>
+#include <Flags.h>
 
 namespace fdpricing
 {
@@ -22,6 +28,52 @@ public:
 	 */
 	static double normCdf(double x);
 	static double normPdf(double x);
+
+	/**
+	 * Batch versions, y_i = f(x_i) for i < n: vectorized and branch-free, with the accuracy tier picked at compile time (see EAccuracy).
+	 * x and y must not overlap
+	 */
+	template<EAccuracy accuracy = EAccuracy::Standard>
+	static void normCdf(const double* unaliased x, double* unaliased y, const size_t n) noexcept
+	{
+		details::CInstructionSet::Dispatch([&](auto instructionSet)
+		{
+			Kernels<decltype(instructionSet)::value>::template NormCdf<accuracy>(x, y, n);
+		});
+	}
+
+	template<EAccuracy accuracy = EAccuracy::Standard>
+	static void normPdf(const double* unaliased x, double* unaliased y, const size_t n) noexcept
+	{
+		details::CInstructionSet::Dispatch([&](auto instructionSet)
+		{
+			Kernels<decltype(instructionSet)::value>::template NormPdf<accuracy>(x, y, n);
+		});
+	}
+
+	template<EAccuracy accuracy = EAccuracy::Standard>
+	static void log(const double* unaliased x, double* unaliased y, const size_t n) noexcept
+	{
+		details::CInstructionSet::Dispatch([&](auto instructionSet)
+		{
+			Kernels<decltype(instructionSet)::value>::template Log<accuracy>(x, y, n);
+		});
+	}
+
+	template<EAccuracy accuracy = EAccuracy::Standard>
+	static void exp(const double* unaliased x, double* unaliased y, const size_t n) noexcept
+	{
+		details::CInstructionSet::Dispatch([&](auto instructionSet)
+		{
+			Kernels<decltype(instructionSet)::value>::template Exp<accuracy>(x, y, n);
+		});
+	}
+
+	/**
+	 * Kernels of the batch versions for the given instruction set, for callers which are dispatched already
+	 */
+	template<EInstructionSet instructionSet>
+	using Kernels = details::CStatsKernels<details::CPack<double, details::CInstructionSetTraits<instructionSet>::registerSize>>;
 };
 }
 
@@ -0,0 +1,121 @@
+/*
+ * CStatsKernels.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef UTILITIES_CSTATSKERNELS_H_
+#define UTILITIES_CSTATSKERNELS_H_
+
+#include <array>
+#include <cmath>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Data/EAccuracy.h>
+#include <Utilities/CSimd.h>
+#include <Flags.h>
+
+namespace details
+{
+
+/**
+ * Explicitly vectorized special functions: exp, log, normal PDF and CDF of a whole pack at once.
+ * They are branch-free: every lane goes through the same instructions, special values and ranges are blended in with selects.
+ * As for the tridiagonal kernels, they're meant to be inlined into code which is dispatched already (see CInstructionSet)
+ */
+template<typename Pack=CPack<double>>
+class CStatsKernels
+{
+public:
+	typedef typename Pack::Type Vector;
+
+	/**
+	 * Same layout as Vector, with 64 bits integer lanes: the result type of the comparisons
+	 */
+	typedef int64_t Integer __attribute__((vector_size(sizeof(Vector))));
+
+	/**
+	 * Cody-Waite range reduction x = k * log(2) + r, |r| <= log(2) / 2, then a Taylor polynomial of exp(r).
+	 * Below -708 (i.e. where exp is subnormal) it flushes to 0
+	 */
+	template<fdpricing::EAccuracy accuracy>
+	static Vector Exp(const Vector& unaliased x) noexcept;
+
+	/**
+	 * log(x) = e * log(2) + log(m), with x = 2^e * m and sqrt(1/2) <= m < sqrt(2), where log(m) is expanded in s = (m - 1) / (m + 1)
+	 */
+	template<fdpricing::EAccuracy accuracy>
+	static Vector Log(const Vector& unaliased x) noexcept;
+
+	template<fdpricing::EAccuracy accuracy>
+	static Vector NormPdf(const Vector& unaliased x) noexcept;
+
+	template<fdpricing::EAccuracy accuracy>
+	static Vector NormCdf(const Vector& unaliased x) noexcept;
+
+	/**
+	 * y_i = f(x_i) for i < n, where f is one of the above. The tail is computed on a padded pack
+	 */
+	template<fdpricing::EAccuracy accuracy>
+	static void Exp(const double* unaliased x, double* unaliased y, const size_t n) noexcept;
+
+	template<fdpricing::EAccuracy accuracy>
+	static void Log(const double* unaliased x, double* unaliased y, const size_t n) noexcept;
+
+	template<fdpricing::EAccuracy accuracy>
+	static void NormPdf(const double* unaliased x, double* unaliased y, const size_t n) noexcept;
+
+	template<fdpricing::EAccuracy accuracy>
+	static void NormCdf(const double* unaliased x, double* unaliased y, const size_t n) noexcept;
+
+private:
+	/**
+	 * Adding and subtracting 1.5 * 2^52 rounds to the nearest integer, which can then be read in the low bits
+	 */
+	static constexpr double shifter = 6755399441055744.0;
+	static constexpr int64_t shifterBits = 0x4338000000000000;
+
+	/**
+	 * log(2) = ln2Hi + ln2Lo, where k * ln2Hi is exact for |k| < 2048
+	 */
+	static constexpr double ln2Hi = 6.93147180369123816490e-01;
+	static constexpr double ln2Lo = 1.90821492927058770002e-10;
+
+	static constexpr double sqrtOneOver2Pi = .5 * M_2_SQRTPIl * M_SQRT1_2l;
+
+	/**
+	 * c_0 + c_1 * x + ... + c_{K - 1} * x^{K - 1}
+	 */
+	template<size_t K>
+	static inline Vector Polynomial(const Vector& unaliased x, const std::array<double, K>& unaliased c) noexcept
+	{
+		Vector ret = Pack::Broadcast(c[K - 1]);
+		for (size_t k = K - 1; k --> 0 ;)
+			ret = ret * x + c[k];
+
+		return ret;
+	}
+
+	static inline Vector Abs(const Vector& unaliased x) noexcept
+	{
+		return (Vector)((Integer)x & 0x7fffffffffffffff);
+	}
+
+	/**
+	 * exp(-x^2 / 2). In the Exact tier it's computed as in Cody's erfc, exp(-x_0^2 / 2) * exp(-(x - x_0) * (x + x_0) / 2),
+	 * where x_0 is x rounded to 1/16: as x_0^2 is exact, the rounding error of x^2 isn't amplified in the tails
+	 */
+	template<fdpricing::EAccuracy accuracy>
+	static Vector Gaussian(const Vector& unaliased x) noexcept;
+
+	template<typename Function>
+	static inline void Apply(const Function& unaliased f, const double* unaliased x, double* unaliased y, const size_t n) noexcept;
+};
+
+}
+
+#include <Utilities/CStatsKernels.tpp>
+
+#endif /* UTILITIES_CSTATSKERNELS_H_ */
@@ -0,0 +1,228 @@
+/*
+ * CStatsKernels.tpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <limits>
+
+#include <Flags.h>
+
+namespace details
+{
+
+template<typename Pack>
+constexpr double CStatsKernels<Pack>::shifter;
+
+template<typename Pack>
+constexpr int64_t CStatsKernels<Pack>::shifterBits;
+
+template<typename Pack>
+constexpr double CStatsKernels<Pack>::ln2Hi;
+
+template<typename Pack>
+constexpr double CStatsKernels<Pack>::ln2Lo;
+
+template<typename Pack>
+constexpr double CStatsKernels<Pack>::sqrtOneOver2Pi;
+
+template<typename Pack>
+template<fdpricing::EAccuracy accuracy>
+typename CStatsKernels<Pack>::Vector CStatsKernels<Pack>::Exp(const Vector& unaliased x) noexcept
+{
+	// 1 / j!: the truncation error is below 1.2e-7 with 7 terms, and below 1e-17 with 14
+	static constexpr std::array<double, 7> fastCoefficients = {{ 1.0, 1.0, 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720 }};
+	static constexpr std::array<double, 14> coefficients = {{ 1.0, 1.0, 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720, 1.0 / 5040, 1.0 / 40320,
+			1.0 / 362880, 1.0 / 3628800, 1.0 / 39916800, 1.0 / 479001600, 1.0 / 6227020800 }};
+
+	static constexpr double minArgument = -708.0;
+	static constexpr double maxArgument = 709.782712893384;
+
+	const Vector shiftedK = x * M_LOG2E + shifter;
+	const Vector k = shiftedK - shifter;
+	const Vector r = (x - k * ln2Hi) - k * ln2Lo;
+
+	const Vector p = accuracy == fdpricing::EAccuracy::Fast ? Polynomial(r, fastCoefficients) : Polynomial(r, coefficients);
+
+	// 2^k as 2 * 2^(k - 1), as k is 1024 close to maxArgument
+	const Integer exponent = ((Integer)shiftedK - shifterBits + 1022) << 52;
+	Vector ret = (2.0 * p) * (Vector)exponent;
+
+	ret = x > maxArgument ? Pack::Broadcast(std::numeric_limits<double>::infinity()) : ret;
+	ret = x < minArgument ? Pack::Broadcast(0.0) : ret;
+
+	return ret;
+}
+
+template<typename Pack>
+template<fdpricing::EAccuracy accuracy>
+typename CStatsKernels<Pack>::Vector CStatsKernels<Pack>::Log(const Vector& unaliased x) noexcept
+{
+	// log(m) = f - s * (f - R(s^2)), where f = m - 1 and R(z) = 2 z / 3 + 2 z^2 / 5 + ...: with z <= 0.0295 the truncation error
+	// is below 1e-7 with 3 terms, and below 1e-17 with 10
+	static constexpr std::array<double, 3> fastCoefficients = {{ 2.0 / 3, 2.0 / 5, 2.0 / 7 }};
+	static constexpr std::array<double, 10> coefficients = {{ 2.0 / 3, 2.0 / 5, 2.0 / 7, 2.0 / 9, 2.0 / 11, 2.0 / 13, 2.0 / 15, 2.0 / 17, 2.0 / 19, 2.0 / 21 }};
+
+	// subnormals are scaled by 2^54 into the normal range first
+	const Integer subnormal = x < DBL_MIN;
+	const Vector y = subnormal ? x * 18014398509481984.0 : x;
+
+	const Integer bits = (Integer)y;
+	Integer e = ((bits >> 52) & 0x7ff) - 1023 + (subnormal & -54);
+	Vector m = (Vector)((bits & 0x000fffffffffffff) | 0x3ff0000000000000);
+
+	const Integer large = m > M_SQRT2;
+	m = large ? .5 * m : m;
+	e -= large;
+
+	const Vector f = m - 1.0;
+	const Vector s = f / (2.0 + f);
+	const Vector z = s * s;
+	const Vector R = z * (accuracy == fdpricing::EAccuracy::Fast ? Polynomial(z, fastCoefficients) : Polynomial(z, coefficients));
+
+	const Vector k = (Vector)(e + shifterBits) - shifter;
+	Vector ret = k * ln2Hi + (f - (s * (f - R) - k * ln2Lo));
+
+	ret = x > 0.0 ? ret : (x == 0.0 ? Pack::Broadcast(-std::numeric_limits<double>::infinity()) : Pack::Broadcast(std::numeric_limits<double>::quiet_NaN()));
+	ret = x == std::numeric_limits<double>::infinity() ? x : ret;
+
+	return ret;
+}
+
+template<typename Pack>
+template<fdpricing::EAccuracy accuracy>
+typename CStatsKernels<Pack>::Vector CStatsKernels<Pack>::Gaussian(const Vector& unaliased x) noexcept
+{
+	if (accuracy != fdpricing::EAccuracy::Exact)
+		return Exp<accuracy>(-.5 * x * x);
+
+	const Vector x0 = ((16.0 * x + shifter) - shifter) * .0625;
+	const Vector ret = Exp<accuracy>(-.5 * x0 * x0) * Exp<accuracy>(-.5 * (x - x0) * (x + x0));
+
+	// infinities would give 0 * NaN
+	return x0 * x0 > 1500.0 ? Pack::Broadcast(0.0) : ret;
+}
+
+template<typename Pack>
+template<fdpricing::EAccuracy accuracy>
+typename CStatsKernels<Pack>::Vector CStatsKernels<Pack>::NormPdf(const Vector& unaliased x) noexcept
+{
+	return sqrtOneOver2Pi * Gaussian<accuracy>(x);
+}
+
+template<typename Pack>
+template<fdpricing::EAccuracy accuracy>
+typename CStatsKernels<Pack>::Vector CStatsKernels<Pack>::NormCdf(const Vector& unaliased x) noexcept
+{
+	const Vector y = Abs(x) * M_SQRT1_2;
+
+	switch (accuracy)
+	{
+		case fdpricing::EAccuracy::Fast:
+		{
+			// Abramovitz-Stegun (7.1.25): erfc(y) = (a1 * t + a2 * t^2 + a3 * t^3) * exp(-y^2), t = 1 / (1 + p * y)
+			static constexpr std::array<double, 3> a = {{ 0.3480242, -0.0958798, 0.7478556 }};
+			static constexpr double p = 0.47047;
+
+			const Vector t = 1.0 / (1.0 + p * y);
+			const Vector tail = .5 * t * Polynomial(t, a) * Exp<accuracy>(-y * y);
+
+			return x < 0.0 ? tail : 1.0 - tail;
+		}
+		case fdpricing::EAccuracy::Standard:
+		{
+			// Abramovitz-Stegun (7.1.26): erfc(y) = (a1 * t + ... + a5 * t^5) * exp(-y^2), t = 1 / (1 + p * y)
+			static constexpr std::array<double, 5> a = {{ 0.254829592, -0.284496736, 1.421413741, -1.453152027, 1.061405429 }};
+			static constexpr double p = 0.3275911;
+
+			const Vector t = 1.0 / (1.0 + p * y);
+			const Vector tail = .5 * t * Polynomial(t, a) * Exp<accuracy>(-y * y);
+
+			return x < 0.0 ? tail : 1.0 - tail;
+		}
+		case fdpricing::EAccuracy::Exact:
+		default:
+		{
+			// W. J. Cody, Rational Chebyshev approximations for the error function (1969), as in CALERF:
+			// 	- y <= 0.46875: erf(y) = y * P(y^2) / Q(y^2)
+			// 	- 0.46875 < y <= 4: erfc(y) = exp(-y^2) * P(y) / Q(y)
+			// 	- y > 4: erfc(y) = exp(-y^2) * (1 / sqrt(pi) - P(1 / y^2) / (y^2 * Q(1 / y^2))) / y
+			// all of them are computed, and blended in
+			static constexpr std::array<double, 5> centralP = {{ 3.20937758913846947e03, 3.77485237685302021e02, 1.13864154151050156e02, 3.16112374387056560e00, 1.85777706184603153e-1 }};
+			static constexpr std::array<double, 5> centralQ = {{ 2.84423683343917062e03, 1.28261652607737228e03, 2.44024637934444173e02, 2.36012909523441209e01, 1.0 }};
+			static constexpr std::array<double, 9> middleP = {{ 1.23033935479799725e03, 2.05107837782607147e03, 1.71204761263407058e03, 8.81952221241769090e02,
+					2.98635138197400131e02, 6.61191906371416295e01, 8.88314979438837594e00, 5.64188496988670089e-1, 2.15311535474403846e-8 }};
+			static constexpr std::array<double, 9> middleQ = {{ 1.23033935480374942e03, 3.43936767414372164e03, 4.36261909014324716e03, 3.29079923573345963e03,
+					1.62138957456669019e03, 5.37181101862009858e02, 1.17693950891312499e02, 1.57449261107098347e01, 1.0 }};
+			static constexpr std::array<double, 6> tailP = {{ 6.58749161529837803e-4, 1.60837851487422766e-2, 1.25781726111229246e-1, 3.60344899949804439e-1, 3.05326634961232344e-1, 1.63153871373020978e-2 }};
+			static constexpr std::array<double, 6> tailQ = {{ 2.33520497626869185e-3, 6.05183413124413191e-2, 5.27905102951428412e-1, 1.87295284992346725e00, 2.56852019228982242e00, 1.0 }};
+			static constexpr double oneOverSqrtPi = 5.6418958354775628695e-1;
+
+			// the sign of x is carried by erf
+			const Vector y2 = y * y;
+			const Vector central = .5 + .5 * (x * M_SQRT1_2) * Polynomial(y2, centralP) / Polynomial(y2, centralQ);
+
+			const Vector middle = Polynomial(y, middleP) / Polynomial(y, middleQ);
+
+			const Vector z = 1.0 / y2;
+			const Vector tail = (oneOverSqrtPi - z * Polynomial(z, tailP) / Polynomial(z, tailQ)) / y;
+
+			// exp(-y^2) = exp(-x^2 / 2), computed from x, which is exact
+			const Vector halfErfc = .5 * Gaussian<accuracy>(x) * (y <= 4.0 ? middle : tail);
+
+			return y <= 0.46875 ? central : (x < 0.0 ? halfErfc : 1.0 - halfErfc);
+		}
+	}
+}
+
+template<typename Pack>
+template<typename Function>
+inline void CStatsKernels<Pack>::Apply(const Function& unaliased f, const double* unaliased x, double* unaliased y, const size_t n) noexcept
+{
+	constexpr size_t W = Pack::width;
+
+	size_t i = 0;
+	for (; i + W <= n; i += W)
+		Pack::Store(y + i, f(Pack::Load(x + i)));
+
+	if (i < n)
+	{
+		double buffer[W] = { };
+		std::copy(x + i, x + n, buffer);
+		Pack::Store(buffer, f(Pack::Load(buffer)));
+		std::copy(buffer, buffer + (n - i), y + i);
+	}
+}
+
+template<typename Pack>
+template<fdpricing::EAccuracy accuracy>
+void CStatsKernels<Pack>::Exp(const double* unaliased x, double* unaliased y, const size_t n) noexcept
+{
+	Apply([](const Vector& unaliased v) { return Exp<accuracy>(v); }, x, y, n);
+}
+
+template<typename Pack>
+template<fdpricing::EAccuracy accuracy>
+void CStatsKernels<Pack>::Log(const double* unaliased x, double* unaliased y, const size_t n) noexcept
+{
+	Apply([](const Vector& unaliased v) { return Log<accuracy>(v); }, x, y, n);
+}
+
+template<typename Pack>
+template<fdpricing::EAccuracy accuracy>
+void CStatsKernels<Pack>::NormPdf(const double* unaliased x, double* unaliased y, const size_t n) noexcept
+{
+	Apply([](const Vector& unaliased v) { return NormPdf<accuracy>(v); }, x, y, n);
+}
+
+template<typename Pack>
+template<fdpricing::EAccuracy accuracy>
+void CStatsKernels<Pack>::NormCdf(const double* unaliased x, double* unaliased y, const size_t n) noexcept
+{
+	Apply([](const Vector& unaliased v) { return NormCdf<accuracy>(v); }, x, y, n);
+}
+
+}
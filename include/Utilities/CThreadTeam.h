@@ -0,0 +1,190 @@
+/*
+ * CThreadTeam.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: raiden
+ */
+
+#ifndef UTILITIES_CTHREADTEAM_H_
+#define UTILITIES_CTHREADTEAM_H_
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <type_traits>
+#include <stddef.h>
+
+#include <Flags.h>
+
+namespace details
+{
+
+/**
+ * Fixed team of threads running the same worker, e.g. one thread per partition of the grid (see CFDPricer): the calling thread
+ * is the first one of the team, the others are started once and wait for work in between runs. Within a run, Barrier synchronizes
+ * the whole team.
+ *
+ * Runs and barriers are typically microseconds apart, so waiting spins for a while: idle threads block only after spinCount polls,
+ * and the threads waiting within a run eventually yield. With more threads than hardware threads, spinning would only delay the
+ * threads it waits for, so they yield straight away.
+ *
+ * It can't be copied nor moved, as its threads refer to it
+ */
+class CThreadTeam
+{
+public:
+	explicit CThreadTeam(const size_t nThreads) noexcept
+		: spinLimit(std::max<size_t>(nThreads, 1) <= Size(0) ? spinCount : 0)
+	{
+		for (size_t thread = 1; thread < std::max<size_t>(nThreads, 1); ++thread)
+			threads.emplace_back([this, thread]() { Loop(thread); });
+	}
+
+	~CThreadTeam()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+			generation.fetch_add(1, std::memory_order_release);
+		}
+		wakeUp.notify_all();
+
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+	CThreadTeam(const CThreadTeam& rhs) = delete;
+	CThreadTeam& operator=(const CThreadTeam& rhs) = delete;
+
+	/**
+	 * Threads of the team, the calling one included
+	 */
+	size_t size() const noexcept
+	{
+		return threads.size() + 1;
+	}
+
+	/**
+	 * Team size for requested threads, 0 meaning one per hardware thread
+	 */
+	static size_t Size(const size_t requested) noexcept
+	{
+		return requested ? requested : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	}
+
+	/**
+	 * Call worker(thread) on each thread of the team, thread being in [0, size()): it returns once all of them are done
+	 */
+	template<typename Worker>
+	void Run(Worker&& worker) noexcept
+	{
+		job = &Invoke<typename std::remove_reference<Worker>::type>;
+		context = &worker;
+		pending.store(threads.size(), std::memory_order_relaxed);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			generation.fetch_add(1, std::memory_order_release);
+		}
+		wakeUp.notify_all();
+
+		worker(0);
+		for (size_t spin = 0; pending.load(std::memory_order_acquire) != 0; ++spin)
+			Pause(spin);
+	}
+
+	/**
+	 * Wait until every thread of the team has reached this point: only within Run
+	 */
+	void Barrier() noexcept
+	{
+		const size_t currentPhase = phase.load(std::memory_order_acquire);
+		if (arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == size())
+		{
+			arrived.store(0, std::memory_order_relaxed);
+			phase.store(currentPhase + 1, std::memory_order_release);
+			return;
+		}
+
+		for (size_t spin = 0; phase.load(std::memory_order_acquire) == currentPhase; ++spin)
+			Pause(spin);
+	}
+
+private:
+	static constexpr size_t spinCount = 1 << 16;
+	const size_t spinLimit;
+
+	std::vector<std::thread> threads;
+
+	/**
+	 * Current run: its worker, type erased
+	 */
+	void (*job)(void*, const size_t) = nullptr;
+	void* context = nullptr;
+
+	/**
+	 * Bumped by each run, so that the waiting threads know there's a new one
+	 */
+	std::atomic<size_t> generation { 0 };
+	std::atomic<size_t> pending { 0 };
+	bool stop = false;
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+
+	/**
+	 * Threads that have reached the current barrier, and barriers passed so far
+	 */
+	std::atomic<size_t> arrived { 0 };
+	std::atomic<size_t> phase { 0 };
+
+	template<typename Worker>
+	static void Invoke(void* context, const size_t thread)
+	{
+		(*static_cast<Worker*>(context))(thread);
+	}
+
+	/**
+	 * Busy wait, giving the core away after spinLimit polls
+	 */
+	inline void Pause(const size_t spin) const noexcept
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		if (spin < spinLimit)
+		{
+			__builtin_ia32_pause();
+			return;
+		}
+#endif
+		(void)spin;
+		std::this_thread::yield();
+	}
+
+	void Loop(const size_t thread) noexcept
+	{
+		size_t seen = 0;
+		for (;;)
+		{
+			for (size_t spin = 0; generation.load(std::memory_order_acquire) == seen && spin < spinLimit; ++spin)
+				Pause(spin);
+
+			if (generation.load(std::memory_order_acquire) == seen)
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wakeUp.wait(lock, [&]() { return generation.load(std::memory_order_acquire) != seen; });
+			}
+
+			seen = generation.load(std::memory_order_acquire);
+			if (stop)
+				return;
+
+			job(context, thread);
+			pending.fetch_sub(1, std::memory_order_acq_rel);
+		}
+	}
+};
+
+}
+
+#endif /* UTILITIES_CTHREADTEAM_H_ */
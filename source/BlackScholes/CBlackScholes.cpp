@@ -19,6 +19,7 @@ CBlackScholes::CBlackScholes(const CInputData & unaliased input) noexcept
 
 	const double sqrtT = sqrt(cacheData.T);
 
+	cacheData.sqrtDt = sqrtT;
 	cacheData.sigmaSqrtDt = input.sigma * sqrtT;
 	oneOverSigmaSqrtT = 1.0 / cacheData.sigmaSqrtDt;
 
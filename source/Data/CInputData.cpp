@@ -5,6 +5,8 @@
  *      Author: raiden
  */
 
+#include <utility>
+
 #include <Data/CInputData.h>
 
 namespace fdpricing
@@ -19,6 +21,11 @@ CInputData::CInputData(const CInputData& unaliased rhs) noexcept
 	*this = rhs;
 }
 
+CInputData::CInputData(CInputData&& unaliased rhs) noexcept
+{
+	*this = std::move(rhs);
+}
+
 CInputData& CInputData::operator=(const CInputData& unaliased rhs) noexcept
 {
 	if (this != &rhs)
@@ -39,6 +46,26 @@ CInputData& CInputData::operator=(const CInputData& unaliased rhs) noexcept
 	return *this;
 }
 
+CInputData& CInputData::operator=(CInputData&& unaliased rhs) noexcept
+{
+	if (this != &rhs)
+	{
+		S = rhs.S;
+		K = rhs.K;
+		r = rhs.r;
+		b = rhs.b;
+		T = rhs.T;
+		sigma = rhs.sigma;
+		N = rhs.N;
+		M = rhs.M;
+		smoothing = rhs.smoothing;
+		acceleration = rhs.acceleration;
+		dividends = std::move(rhs.dividends);
+	}
+
+	return *this;
+}
+
 CInputData::CInputData(const double S, const double K, const double r, const double b, const double T, const double sigma, int N) noexcept
 		: S(S), K(K), r(r), b(b), T(T), sigma(sigma), N(N & 1 ? N : (N + 1)), M(N), smoothing(false), acceleration(false)
 {
@@ -8,6 +8,8 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <cmath>
 #include <algorithm>
 #include <chrono>
 #include <thread>
@@ -15,7 +17,13 @@
 #include <gtest/gtest.h>
 
 #include <FiniteDifference/CFDPricer.h>
+#include <FiniteDifference/CBatchPricer.h>
+#include <FiniteDifference/CFixedSizePricer.h>
+#include <FiniteDifference/COperatorRegistry.h>
 #include <Utilities/CPlotter.h>
+#include <Utilities/CArena.h>
+#include <Utilities/CInstructionSet.h>
+#include <Utilities/CStats.h>
 
 char* getCmdOption(char ** begin, char ** end, const std::string& option)
 {
@@ -101,8 +109,7 @@ void PlotResults()
 		x.push_back(K);
 
 		input.K = K;
-		CFDPricer<> pricer(input, settings);
-		pricer.Price(callOutput, putOutput);
+		pricer.Reprice(input, callOutput, putOutput);
 
 		callPrice.push_back(callOutput.price);
 		callDelta.push_back(callOutput.delta);
@@ -132,6 +139,13 @@ enum class EProfileMethod
 {
 	SingleThreaded,
 	MultiThreaded,
+	Batched,
+	FixedSize,
+	SinglePrecision,
+	MatrixFree,
+	Registry,
+	Arena,
+	Reprice,
 };
 
 template <EProfileMethod profileMethod>
@@ -203,6 +217,87 @@ void ProfileWorker(const size_t iterations, const size_t nDivs, const bool smoot
 				threads[i].join();
 		}
 		break;
+
+		case EProfileMethod::Batched:
+		{
+			std::vector<CInputData> inputs(iterations, input);
+			std::vector<COutputData> callOutputs, putOutputs;
+
+			CBatchPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> pricer(inputs, settings);
+			pricer.Price(callOutputs, putOutputs);
+		}
+		break;
+
+		case EProfileMethod::FixedSize:
+			for (size_t iter = 0; iter < iterations; ++iter)
+			{
+				CFixedSizePricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> pricer(input, settings);
+				pricer.Price(callOutput, putOutput);
+			}
+		break;
+
+		case EProfileMethod::SinglePrecision:
+			for (size_t iter = 0; iter < iterations; ++iter)
+			{
+				CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All, 0, EPrecision::Single> pricer(input, settings);
+				pricer.Price(callOutput, putOutput);
+			}
+		break;
+
+		case EProfileMethod::MatrixFree:
+			for (size_t iter = 0; iter < iterations; ++iter)
+			{
+				CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All, 0, EPrecision::Double, EOperatorStorage::MatrixFree> pricer(input, settings);
+				pricer.Price(callOutput, putOutput);
+			}
+		break;
+
+		case EProfileMethod::Registry:
+		{
+			// the operator is built once and shared by all the pricers
+			COperatorRegistry<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> registry(8);
+			registry.Prewarm(std::vector<CInputData>(1, input), settings.fdSettings);
+			for (size_t iter = 0; iter < iterations; ++iter)
+			{
+				CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> pricer(input, settings, registry.Get(input, settings.fdSettings));
+				pricer.Price(callOutput, putOutput);
+			}
+		}
+		break;
+
+		case EProfileMethod::Arena:
+		{
+			// as MultiThreaded, but each thread prices out of its own arena: no heap allocation after the first option
+			const size_t nThreads = std::thread::hardware_concurrency();
+			std::vector<std::thread> threads(nThreads);
+			for (size_t i = 0; i < nThreads; ++i)
+			{
+				threads[i] = std::thread([&, i]()
+						{
+							details::CArena arena;
+							COutputData threadCallOutput, threadPutOutput;
+							for (size_t iter = i; iter < iterations; iter += nThreads)
+							{
+								details::CArenaScope scope(&arena);
+								CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> pricer(input, settings);
+								pricer.Price(threadCallOutput, threadPutOutput);
+							}
+						});
+			}
+
+			for (size_t i = 0; i < nThreads; ++i)
+				threads[i].join();
+		}
+		break;
+
+		case EProfileMethod::Reprice:
+		{
+			// a single pricer whose buffers and operators are recycled
+			CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> pricer(input, settings);
+			for (size_t iter = 0; iter < iterations; ++iter)
+				pricer.Reprice(input, callOutput, putOutput);
+		}
+		break;
 	}
 
 	CALLGRIND_STOP_INSTRUMENTATION;
@@ -221,18 +316,396 @@ void Profile(const size_t iterations = 100,
 		ProfileWorker<EProfileMethod::SingleThreaded>(iterations, nDivs, smoothing, acceleration);
 	if (profileMethod == EProfileMethod::MultiThreaded)
 		ProfileWorker<EProfileMethod::MultiThreaded>(iterations, nDivs, smoothing, acceleration);
+	if (profileMethod == EProfileMethod::Batched)
+		ProfileWorker<EProfileMethod::Batched>(iterations, nDivs, smoothing, acceleration);
+	if (profileMethod == EProfileMethod::FixedSize)
+		ProfileWorker<EProfileMethod::FixedSize>(iterations, nDivs, smoothing, acceleration);
+	if (profileMethod == EProfileMethod::SinglePrecision)
+		ProfileWorker<EProfileMethod::SinglePrecision>(iterations, nDivs, smoothing, acceleration);
+	if (profileMethod == EProfileMethod::MatrixFree)
+		ProfileWorker<EProfileMethod::MatrixFree>(iterations, nDivs, smoothing, acceleration);
+	if (profileMethod == EProfileMethod::Registry)
+		ProfileWorker<EProfileMethod::Registry>(iterations, nDivs, smoothing, acceleration);
+	if (profileMethod == EProfileMethod::Arena)
+		ProfileWorker<EProfileMethod::Arena>(iterations, nDivs, smoothing, acceleration);
+	if (profileMethod == EProfileMethod::Reprice)
+		ProfileWorker<EProfileMethod::Reprice>(iterations, nDivs, smoothing, acceleration);
 
 	auto done = std::chrono::high_resolution_clock::now();
 	double avgTime = std::chrono::duration_cast<std::chrono::milliseconds>(done - started).count();
 	avgTime /= iterations;
 
 	printf("--------- SMOOTH=%d - ACCEL=%d - %zu DIVIDENDS (out of %zu iterations)  ---------\n", smoothing, acceleration, nDivs, iterations);
+	printf("\n\t* Instruction Set: %s\n", details::CInstructionSet::ToString(details::CInstructionSet::Get()));
 	printf("\n\t* Avg Time(ms) Per Option: %.5f\n", avgTime);
 	printf("\n\t* Opt/Sec: %.5f\n", 1.0 / (.001 * avgTime));
 	printf("\n----------------------------------------------------------\n");
 
 }
 
+template <fdpricing::EOperatorStorage operatorStorage>
+double CrossoverWorker(const fdpricing::CInputData& input, const size_t iterations) noexcept
+{
+	using namespace fdpricing;
+
+	CPricerSettings settings;
+	settings.calculationType = ECalculationType::All;
+	settings.exerciseType = EExerciseType::American;
+	COutputData callOutput, putOutput;
+
+	auto started = std::chrono::high_resolution_clock::now();
+	for (size_t iter = 0; iter < iterations; ++iter)
+	{
+		CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All, 0, EPrecision::Double, operatorStorage> pricer(input, settings);
+		pricer.Price(callOutput, putOutput);
+	}
+	auto done = std::chrono::high_resolution_clock::now();
+
+	return std::chrono::duration_cast<std::chrono::microseconds>(done - started).count() / (1e3 * iterations);
+}
+
+/**
+ * Assembled vs matrix-free operator as the grid grows: the matrix-free operator pays off once the assembled one falls out of cache
+ */
+void ProfileCrossover(const size_t nDivs) noexcept
+{
+	using namespace fdpricing;
+
+	CInputData input;
+	input.S = 100;
+	input.K = 100;
+	input.r = .05;
+	input.b = .02;
+	input.sigma = .3;
+	input.T = 7;
+	input.M = 80;
+	input.dividends.resize(nDivs);
+	for (size_t m = 0; m < nDivs; ++m)
+		input.dividends[m] = CDividend(0.001 + .25 * m, 1.0);
+
+	printf("--------- ASSEMBLED vs MATRIX-FREE - %zu DIVIDENDS - %s ---------\n", nDivs, details::CInstructionSet::ToString(details::CInstructionSet::Get()));
+	printf("\n\t%8s %16s %16s %10s\n", "N", "Assembled(ms)", "MatrixFree(ms)", "Speedup");
+	for (size_t N = 129; N <= 16385; N = 2 * N - 1)
+	{
+		input.N = N;
+
+		// about the same number of grid points per measure
+		const size_t iterations = std::max<size_t>(5, 12800 / N);
+		const double assembled = CrossoverWorker<EOperatorStorage::Assembled>(input, iterations);
+		const double matrixFree = CrossoverWorker<EOperatorStorage::MatrixFree>(input, iterations);
+		printf("\t%8zu %16.4f %16.4f %10.3f\n", N, assembled, matrixFree, assembled / matrixFree);
+	}
+	printf("\n----------------------------------------------------------\n");
+}
+
+/**
+ * Time per element (ns) of a batch special function against its scalar counterpart, and max absolute and relative error against a long double reference
+ */
+template <typename Batch, typename Scalar, typename Reference>
+void ProfileStatsWorker(const char* name, const char* tier, const std::vector<double>& x, Batch batch, Scalar scalar, Reference reference) noexcept
+{
+	const size_t n = 1024;
+	const size_t iterations = std::max<size_t>(1, 20000000 / x.size());
+	std::vector<double> y(x.size());
+
+	double bestBatch = 1e300, bestScalar = 1e300;
+	for (size_t run = 0; run < 5; ++run)
+	{
+		auto started = std::chrono::high_resolution_clock::now();
+		for (size_t iter = 0; iter < iterations; ++iter)
+		{
+			for (size_t i = 0; i < x.size(); i += n)
+				batch(x.data() + i, y.data() + i, std::min(n, x.size() - i));
+		}
+		auto done = std::chrono::high_resolution_clock::now();
+		bestBatch = std::min<double>(bestBatch, std::chrono::duration_cast<std::chrono::nanoseconds>(done - started).count());
+
+		started = std::chrono::high_resolution_clock::now();
+		for (size_t iter = 0; iter < iterations; ++iter)
+			scalar(x.data(), y.data(), x.size());
+		done = std::chrono::high_resolution_clock::now();
+		bestScalar = std::min<double>(bestScalar, std::chrono::duration_cast<std::chrono::nanoseconds>(done - started).count());
+	}
+	bestBatch /= iterations * x.size();
+	bestScalar /= iterations * x.size();
+
+	batch(x.data(), y.data(), x.size());
+	double maxAbsoluteError = 0.0, maxRelativeError = 0.0;
+	for (size_t i = 0; i < x.size(); ++i)
+	{
+		const long double expected = reference(x[i]);
+		const double error = static_cast<double>(fabsl(y[i] - expected));
+		maxAbsoluteError = std::max(maxAbsoluteError, error);
+		if (expected != 0.0L)
+			maxRelativeError = std::max(maxRelativeError, static_cast<double>(error / fabsl(expected)));
+	}
+
+	printf("\t%8s %9s %12.3f %12.3f %9.2f %14.3e %14.3e\n", name, tier, bestBatch, bestScalar, bestScalar / bestBatch, maxAbsoluteError, maxRelativeError);
+}
+
+template <fdpricing::EAccuracy accuracy>
+void ProfileStatsTier(const char* tier) noexcept
+{
+	using namespace fdpricing;
+
+	const size_t N = 1 << 16;
+	std::vector<double> normal(N), exponent(N), positive(N);
+	for (size_t i = 0; i < N; ++i)
+	{
+		normal[i] = -10.0 + 20.0 * i / (N - 1);
+		exponent[i] = -700.0 + 1400.0 * i / (N - 1);
+		positive[i] = std::pow(10.0, -300.0 + 600.0 * i / (N - 1));
+	}
+
+	ProfileStatsWorker("normCdf", tier, normal,
+			[](const double* x, double* y, const size_t n) { CStats::normCdf<accuracy>(x, y, n); },
+			[](const double* x, double* y, const size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+					y[i] = CStats::normCdf(x[i]);
+			},
+			[](const double x) { return .5L * erfcl(-x * static_cast<long double>(M_SQRT1_2l)); });
+
+	ProfileStatsWorker("normPdf", tier, normal,
+			[](const double* x, double* y, const size_t n) { CStats::normPdf<accuracy>(x, y, n); },
+			[](const double* x, double* y, const size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+					y[i] = CStats::normPdf(x[i]);
+			},
+			[](const double x) { return expl(-.5L * x * x) * .5L * M_2_SQRTPIl * M_SQRT1_2l; });
+
+	ProfileStatsWorker("exp", tier, exponent,
+			[](const double* x, double* y, const size_t n) { CStats::exp<accuracy>(x, y, n); },
+			[](const double* x, double* y, const size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+					y[i] = std::exp(x[i]);
+			},
+			[](const double x) { return expl(x); });
+
+	ProfileStatsWorker("log", tier, positive,
+			[](const double* x, double* y, const size_t n) { CStats::log<accuracy>(x, y, n); },
+			[](const double* x, double* y, const size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+					y[i] = std::log(x[i]);
+			},
+			[](const double x) { return logl(x); });
+}
+
+/**
+ * Batch special functions of CStats per accuracy tier, against the scalar CStats::normCdf/normPdf and libm's exp/log
+ */
+void ProfileStats() noexcept
+{
+	printf("--------- BATCH SPECIAL FUNCTIONS - %s ---------\n", details::CInstructionSet::ToString(details::CInstructionSet::Get()));
+	printf("\n\t%8s %9s %12s %12s %9s %14s %14s\n", "Function", "Tier", "Batch(ns)", "Scalar(ns)", "Speedup", "MaxAbsError", "MaxRelError");
+	ProfileStatsTier<fdpricing::EAccuracy::Fast>("Fast");
+	ProfileStatsTier<fdpricing::EAccuracy::Standard>("Standard");
+	ProfileStatsTier<fdpricing::EAccuracy::Exact>("Exact");
+	printf("\n----------------------------------------------------------\n");
+}
+
+template <fdpricing::ESolverType solverType>
+double ExerciseWorker(fdpricing::CInputData& input, const size_t M, const bool brennanSchwartz, const bool call) noexcept
+{
+	using namespace fdpricing;
+
+	CPricerSettings settings;
+	settings.calculationType = call ? ECalculationType::CallOnly : ECalculationType::PutOnly;
+	settings.exerciseType = EExerciseType::American;
+	settings.fdSettings.brennanSchwartz = brennanSchwartz;
+	COutputData callOutput, putOutput;
+
+	input.M = M;
+	CFDPricer<solverType, EGridType::Adaptive, EAdjointDifferentiation::None> pricer(input, settings);
+	pricer.Price(callOutput, putOutput);
+
+	return call ? callOutput.price : putOutput.price;
+}
+
+template <fdpricing::ESolverType solverType>
+void ProfileExerciseCase(const char* name, fdpricing::CInputData& input, const bool call, const double reference) noexcept
+{
+	printf("\n\t%s - reference %.5f\n", name, reference);
+	for (size_t M = 10; M <= 320; M *= 2)
+	{
+		const double projection = ExerciseWorker<solverType>(input, M, false, call);
+		const double brennanSchwartz = ExerciseWorker<solverType>(input, M, true, call);
+		printf("\t%8zu %12.5f %14.2e %12.5f %14.2e\n", M, projection, fabs(projection - reference), brennanSchwartz, fabs(brennanSchwartz - reference));
+	}
+}
+
+/**
+ * Error against M of the projection after the step against Brennan-Schwartz, on the cases of Vellekoop Table 1 and on an American put.
+ * The Vellekoop calls are only exercised at the dividend dates, where the projection is exact: the two methods agree on them
+ */
+void ProfileExercise() noexcept
+{
+	using namespace fdpricing;
+
+	CInputData input;
+	input.S = 100;
+	input.K = 100;
+	input.r = .05;
+	input.b = .05;
+	input.sigma = .3;
+	input.T = 1.0;
+	input.N = 81;
+	input.smoothing = true;
+	input.acceleration = false;
+
+	printf("--------- PROJECTION vs BRENNAN-SCHWARTZ - CRANK-NICOLSON ---------\n");
+	printf("\n\t%8s %12s %14s %12s %14s\n", "M", "Projection", "Error", "BS", "Error");
+
+	// http://doc.utwente.nl/58556/1/Vellekoop06efficient.pdf
+	input.dividends = std::vector<CDividend>({ CDividend(.1, 7.0) });
+	ProfileExerciseCase<ESolverType::CrankNicolson>("Vellekoop Table 1 - K=100, t_D=0.1", input, true, 10.29);
+	input.dividends = std::vector<CDividend>({ CDividend(.5, 7.0) });
+	ProfileExerciseCase<ESolverType::CrankNicolson>("Vellekoop Table 1 - K=100, t_D=0.5", input, true, 11.33);
+	input.dividends = std::vector<CDividend>({ CDividend(.9, 7.0) });
+	ProfileExerciseCase<ESolverType::CrankNicolson>("Vellekoop Table 1 - K=100, t_D=0.9", input, true, 13.49);
+
+	// no dividends: the reference is Brennan-Schwartz on a fine time grid
+	input.dividends.clear();
+	input.N = 201;
+	const double reference = ExerciseWorker<ESolverType::CrankNicolson>(input, 4000, true, false);
+	ProfileExerciseCase<ESolverType::CrankNicolson>("American put - K=100, N=201", input, false, reference);
+	printf("\n----------------------------------------------------------\n");
+}
+
+template <fdpricing::ESolverType solverType>
+double ParallelSolveWorker(const fdpricing::CInputData& input, const size_t nThreads, const size_t iterations, double& price) noexcept
+{
+	using namespace fdpricing;
+
+	CPricerSettings settings;
+	settings.calculationType = ECalculationType::All;
+	settings.exerciseType = EExerciseType::American;
+	settings.fdSettings.parallelSolveMinN = nThreads > 1 ? 1 : 0;
+	settings.fdSettings.parallelSolveThreads = nThreads;
+	COutputData callOutput, putOutput;
+
+	CFDPricer<solverType, EGridType::Adaptive, EAdjointDifferentiation::All> pricer(input, settings);
+	auto started = std::chrono::high_resolution_clock::now();
+	for (size_t iter = 0; iter < iterations; ++iter)
+		pricer.Price(callOutput, putOutput);
+	auto done = std::chrono::high_resolution_clock::now();
+
+	price = putOutput.price;
+	return std::chrono::duration_cast<std::chrono::microseconds>(done - started).count() / (1e3 * iterations);
+}
+
+/**
+ * Partitioned steps against the number of threads, on a single option with a very large grid
+ */
+template <fdpricing::ESolverType solverType>
+void ProfileParallelSolve(const char* name, const size_t N) noexcept
+{
+	using namespace fdpricing;
+
+	CInputData input;
+	input.S = 100;
+	input.K = 100;
+	input.r = .05;
+	input.b = .02;
+	input.sigma = .3;
+	input.T = 1;
+	input.N = N;
+	input.M = 100;
+
+	printf("\n\t%s - N=%zu\n", name, N);
+	double sequential = 0.0, sequentialPrice = 0.0;
+	for (size_t nThreads = 1; nThreads <= 2 * std::max<size_t>(std::thread::hardware_concurrency(), 1); nThreads *= 2)
+	{
+		double price = 0.0;
+		const double elapsed = ParallelSolveWorker<solverType>(input, nThreads, 3, price);
+		if (nThreads == 1)
+		{
+			sequential = elapsed;
+			sequentialPrice = price;
+		}
+		printf("\t%8zu %12.4f %10.3f %14.2e\n", nThreads, elapsed, sequential / elapsed, fabs(price - sequentialPrice));
+	}
+}
+
+void ProfileParallelSolve() noexcept
+{
+	using namespace fdpricing;
+
+	printf("--------- PARTITIONED STEPS - %u HARDWARE THREADS ---------\n", std::thread::hardware_concurrency());
+	printf("\n\t%8s %12s %10s %14s\n", "Threads", "Time(ms)", "Speedup", "Difference");
+	ProfileParallelSolve<ESolverType::CrankNicolson>("Crank-Nicolson", 262145);
+	ProfileParallelSolve<ESolverType::ImplicitEuler>("Implicit Euler", 262145);
+	ProfileParallelSolve<ESolverType::CrankNicolson>("Crank-Nicolson", 1048577);
+	printf("\n----------------------------------------------------------\n");
+}
+
+template <fdpricing::ESolverType solverType, EAdjointDifferentiation adjointDifferentiation>
+double CyclicReductionWorker(const fdpricing::CInputData& input, const bool cyclicReduction, const size_t iterations, double& price) noexcept
+{
+	using namespace fdpricing;
+
+	CPricerSettings settings;
+	settings.calculationType = ECalculationType::CallOnly;
+	settings.exerciseType = EExerciseType::European;
+	settings.fdSettings.cyclicReductionMaxN = cyclicReduction ? input.N : 0;
+	COutputData callOutput, putOutput;
+
+	CFDPricer<solverType, EGridType::Adaptive, adjointDifferentiation> pricer(input, settings);
+	pricer.Price(callOutput, putOutput); // warm up
+	auto started = std::chrono::high_resolution_clock::now();
+	for (size_t iter = 0; iter < iterations; ++iter)
+		pricer.Price(callOutput, putOutput);
+	auto done = std::chrono::high_resolution_clock::now();
+
+	price = callOutput.price;
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(done - started).count() / (1e3 * iterations);
+}
+
+/**
+ * Latency of a single option on small grids: Thomas algorithm against hybrid cyclic reduction
+ */
+template <fdpricing::ESolverType solverType, EAdjointDifferentiation adjointDifferentiation>
+void ProfileCyclicReduction(const char* name) noexcept
+{
+	using namespace fdpricing;
+
+	CInputData input;
+	input.S = 100;
+	input.K = 100;
+	input.r = .05;
+	input.b = .02;
+	input.sigma = .3;
+	input.T = 1;
+	input.M = 100;
+
+	printf("\n\t%s\n", name);
+	for (const size_t N : { 129, 257, 513, 1025 })
+	{
+		input.N = N;
+		const size_t iterations = std::max<size_t>(200000 / N, 10);
+
+		double thomasPrice = 0.0, reductionPrice = 0.0;
+		const double thomas = CyclicReductionWorker<solverType, adjointDifferentiation>(input, false, iterations, thomasPrice);
+		const double reduction = CyclicReductionWorker<solverType, adjointDifferentiation>(input, true, iterations, reductionPrice);
+		printf("\t%8zu %12.2f %12.2f %10.3f %14.2e\n", N, thomas, reduction, thomas / reduction, fabs(thomasPrice - reductionPrice));
+	}
+}
+
+void ProfileCyclicReduction() noexcept
+{
+	using namespace fdpricing;
+
+	printf("--------- CYCLIC REDUCTION - SINGLE OPTION LATENCY ---------\n");
+	printf("\n\t%8s %12s %12s %10s %14s\n", "N", "Thomas(us)", "CR(us)", "Speedup", "Difference");
+	ProfileCyclicReduction<ESolverType::CrankNicolson, EAdjointDifferentiation::None>("Crank-Nicolson - no greeks");
+	ProfileCyclicReduction<ESolverType::CrankNicolson, EAdjointDifferentiation::All>("Crank-Nicolson - all greeks");
+	ProfileCyclicReduction<ESolverType::ImplicitEuler, EAdjointDifferentiation::None>("Implicit Euler - no greeks");
+	printf("\n----------------------------------------------------------\n");
+}
+
 int main(int argc, char * argv[])
 {
 	if(cmdOptionExists(argv, argv+argc, "-test"))
@@ -240,10 +713,37 @@ int main(int argc, char * argv[])
 		::testing::InitGoogleTest(&argc, argv);
 		return RUN_ALL_TESTS();
 	}
+	if (cmdOptionExists(argv, argv+argc, "-isa"))
+	{
+		// force a variant of the kernels, rather than the best one this CPU supports
+		const auto isa = std::string(getCmdOption(argv, argv + argc, "-isa"));
+		EInstructionSet instructionSet = EInstructionSet::Sse2;
+		if (isa == "avx2")
+			instructionSet = EInstructionSet::Avx2;
+		if (isa == "avx512")
+			instructionSet = EInstructionSet::Avx512;
+		if (!details::CInstructionSet::Set(instructionSet))
+			printf("*** %s NOT SUPPORTED ***\n", details::CInstructionSet::ToString(instructionSet));
+	}
 	if(cmdOptionExists(argv, argv+argc, "-conv"))
 		PlotConvergence();
 	if(cmdOptionExists(argv, argv+argc, "-res"))
 		PlotResults();
+	if(cmdOptionExists(argv, argv+argc, "-crossover"))
+	{
+		size_t nDivs = 8;
+		if (cmdOptionExists(argv, argv+argc, "-divs"))
+			nDivs = std::atoi(getCmdOption(argv, argv + argc, "-divs"));
+		ProfileCrossover(nDivs);
+	}
+	if(cmdOptionExists(argv, argv+argc, "-stats"))
+		ProfileStats();
+	if(cmdOptionExists(argv, argv+argc, "-exercise"))
+		ProfileExercise();
+	if(cmdOptionExists(argv, argv+argc, "-parallel"))
+		ProfileParallelSolve();
+	if(cmdOptionExists(argv, argv+argc, "-latency"))
+		ProfileCyclicReduction();
 	if(cmdOptionExists(argv, argv+argc, "-profile"))
 	{
 		size_t nIterations = 100;
@@ -273,6 +773,41 @@ int main(int argc, char * argv[])
 				printf("============== MULTI-THREADED ==============\n");
 				profileMethod = EProfileMethod::MultiThreaded;
 			}
+			if (method == "batch")
+			{
+				printf("============== BATCHED ==============\n");
+				profileMethod = EProfileMethod::Batched;
+			}
+			if (method == "fixed")
+			{
+				printf("============== FIXED SIZE ==============\n");
+				profileMethod = EProfileMethod::FixedSize;
+			}
+			if (method == "float")
+			{
+				printf("============== SINGLE PRECISION ==============\n");
+				profileMethod = EProfileMethod::SinglePrecision;
+			}
+			if (method == "matrixfree")
+			{
+				printf("============== MATRIX-FREE ==============\n");
+				profileMethod = EProfileMethod::MatrixFree;
+			}
+			if (method == "registry")
+			{
+				printf("============== OPERATOR REGISTRY ==============\n");
+				profileMethod = EProfileMethod::Registry;
+			}
+			if (method == "arena")
+			{
+				printf("============== MULTI-THREADED ARENA ==============\n");
+				profileMethod = EProfileMethod::Arena;
+			}
+			if (method == "reprice")
+			{
+				printf("============== REPRICE ==============\n");
+				profileMethod = EProfileMethod::Reprice;
+			}
 		}
 		Profile(nIterations, nDivs, smoothing, acceleration, profileMethod);
 	}
@@ -29,14 +29,14 @@ double CStats::normCdf(double x)
 		x *= M_SQRT1_2l;
 
 	const double t(1.0 / (1.0 + p * x));
-	const double y(1.0 - (((((a5 * t + a4) * t) + a3) * t + a2) * t + a1) * t * exp(-x * x));
+	const double y(1.0 - (((((a5 * t + a4) * t) + a3) * t + a2) * t + a1) * t * std::exp(-x * x));
 
 	return 0.5 * (1.0 + sign * y);
 }
 
 double CStats::normPdf(double x)
 {
-	return sqrtOneOver2Pi * exp(-0.5 * x * x);
+	return sqrtOneOver2Pi * std::exp(-0.5 * x * x);
 }
 }
 
@@ -6,8 +6,10 @@
  */
 
 #include <cmath>
+#include <vector>
 #include <gtest/gtest.h>
 #include <BlackScholes/CBlackScholes.h>
+#include <Utilities/CStats.h>
 
 using namespace fdpricing;
 
@@ -95,4 +97,165 @@ TEST (BlackScholesTest, Vega)
 	ASSERT_FLOAT_EQ(expected, V);
 }
 
+TEST (BlackScholesTest, GridSmoothing)
+{
+	CInputData input;
+	input.S = 100;
+	input.K = 100;
+	input.r = .05;
+	input.b = .02;
+	input.sigma = .3;
+	input.T = 2;
+
+	details::CCacheData cache;
+	cache.T = .01;
+	cache.sqrtDt = sqrt(cache.T);
+	cache.sigmaSqrtDt = input.sigma * cache.sqrtDt;
+	cache.discountFactor = exp(-input.r * cache.T);
+	cache.growthFactor = exp(input.b * cache.T);
+	cache.growthFactorTimesDiscountFactor = cache.discountFactor * cache.growthFactor;
+
+	// odd size, so that the padded tail is exercised too, and spots below the dividend
+	const size_t N = 101;
+	const double dividend = 5.0;
+	std::vector<double> S(N);
+	for (size_t i = 0; i < N; ++i)
+		S[i] = 2.0 * i;
+
+	std::vector<double> callPrice(N), callVega(N), callRho(N), callRhoBorrow(N), putPrice(N), putVega(N), putRho(N), putRhoBorrow(N);
+	CBlackScholes::Smooth<ECalculationType::All, EAdjointDifferentiation::All>(input, cache, S.data(), N, dividend,
+			details::CSmoothingOutput<double> { callPrice.data(), callVega.data(), callRho.data(), callRhoBorrow.data() },
+			details::CSmoothingOutput<double> { putPrice.data(), putVega.data(), putRho.data(), putRhoBorrow.data() });
+
+	CBlackScholes bs(input, cache);
+	for (size_t i = 0; i < N; ++i)
+	{
+		bs.Update(std::max(S[i] - dividend, 1e-7));
+
+		ASSERT_NEAR(bs.Value<EOptionType::Call>(), callPrice[i], 1e-12);
+		ASSERT_NEAR(bs.Value<EOptionType::Put>(), putPrice[i], 1e-12);
+		ASSERT_NEAR(bs.Vega(), callVega[i], 1e-12);
+		ASSERT_NEAR(bs.Vega(), putVega[i], 1e-12);
+		ASSERT_NEAR(-cache.T * bs.Value<EOptionType::Call>(), callRho[i], 1e-12);
+		ASSERT_NEAR(-cache.T * bs.Value<EOptionType::Put>(), putRho[i], 1e-12);
+		ASSERT_NEAR(bs.RhoBorrow<EOptionType::Call>(), callRhoBorrow[i], 1e-12);
+		ASSERT_NEAR(bs.RhoBorrow<EOptionType::Put>(), putRhoBorrow[i], 1e-12);
+	}
+}
+
+template<EAccuracy accuracy>
+void NormCdfAccuracyWorker(const double maxAbsoluteError, const double maxRelativeError, const double maxPdfRelativeError)
+{
+	// odd size, so that the padded tail is exercised too
+	const size_t N = 40001;
+	std::vector<double> x(N), cdf(N), pdf(N);
+	for (size_t i = 0; i < N; ++i)
+		x[i] = -37.0 + 74.0 * i / (N - 1);
+
+	CStats::normCdf<accuracy>(x.data(), cdf.data(), N);
+	CStats::normPdf<accuracy>(x.data(), pdf.data(), N);
+	for (size_t i = 0; i < N; ++i)
+	{
+		const long double expectedCdf = .5L * erfcl(-x[i] * static_cast<long double>(M_SQRT1_2l));
+		ASSERT_LE(fabsl(cdf[i] - expectedCdf), maxAbsoluteError);
+
+		// left tail: relative error
+		ASSERT_TRUE(x[i] >= 0.0 || fabsl(cdf[i] - expectedCdf) <= maxRelativeError * expectedCdf);
+
+		const long double expectedPdf = expl(-.5L * x[i] * x[i]) * .5L * M_2_SQRTPIl * M_SQRT1_2l;
+		ASSERT_LE(fabsl(pdf[i] - expectedPdf), maxPdfRelativeError * expectedPdf);
+	}
+}
+
+TEST (StatsTest, NormCdfAccuracy)
+{
+	NormCdfAccuracyWorker<EAccuracy::Fast>(1.5e-5, 1.0, 2e-7);
+	NormCdfAccuracyWorker<EAccuracy::Standard>(1e-7, 1.0, 1e-13);
+	NormCdfAccuracyWorker<EAccuracy::Exact>(5e-16, 5e-15, 1e-15);
 
+	// same approximation as the scalar version
+	for (int i = -400; i <= 400; ++i)
+	{
+		const double x = .025 * i;
+		double y;
+		CStats::normCdf(&x, &y, 1);
+		ASSERT_NEAR(CStats::normCdf(x), y, 1e-15);
+	}
+}
+
+template<EAccuracy accuracy>
+void ExpLogWorker(const double maxRelativeError)
+{
+	const size_t N = 40001;
+	std::vector<double> x(N), y(N);
+
+	for (size_t i = 0; i < N; ++i)
+		x[i] = -708.0 + 1417.0 * i / (N - 1);
+	CStats::exp<accuracy>(x.data(), y.data(), N);
+	for (size_t i = 0; i < N; ++i)
+		ASSERT_LE(fabsl(y[i] - expl(x[i])), maxRelativeError * expl(x[i]));
+
+	// subnormals included
+	for (size_t i = 0; i < N; ++i)
+		x[i] = std::pow(10.0, -320.0 + 628.0 * i / (N - 1));
+	CStats::log<accuracy>(x.data(), y.data(), N);
+	for (size_t i = 0; i < N; ++i)
+		ASSERT_LE(fabsl(y[i] - logl(x[i])), maxRelativeError * std::max(1.0L, fabsl(logl(x[i]))));
+
+	const std::vector<double> special = { 0.0, -1.0, INFINITY, -INFINITY, NAN, -750.0, 750.0 };
+	std::vector<double> out(special.size());
+
+	CStats::exp<accuracy>(special.data(), out.data(), special.size());
+	ASSERT_EQ(1.0, out[0]);
+	ASSERT_EQ(INFINITY, out[2]);
+	ASSERT_EQ(0.0, out[3]);
+	ASSERT_TRUE(std::isnan(out[4]));
+	ASSERT_EQ(0.0, out[5]);
+	ASSERT_EQ(INFINITY, out[6]);
+
+	CStats::log<accuracy>(special.data(), out.data(), special.size());
+	ASSERT_EQ(-INFINITY, out[0]);
+	ASSERT_TRUE(std::isnan(out[1]));
+	ASSERT_EQ(INFINITY, out[2]);
+	ASSERT_TRUE(std::isnan(out[3]));
+	ASSERT_TRUE(std::isnan(out[4]));
+
+	CStats::normCdf<accuracy>(special.data(), out.data(), special.size());
+	ASSERT_NEAR(.5, out[0], 1e-7);
+	ASSERT_EQ(1.0, out[2]);
+	ASSERT_EQ(0.0, out[3]);
+	ASSERT_TRUE(std::isnan(out[4]));
+}
+
+TEST (StatsTest, ExpLog)
+{
+	ExpLogWorker<EAccuracy::Fast>(2e-7);
+	ExpLogWorker<EAccuracy::Standard>(5e-16);
+	ExpLogWorker<EAccuracy::Exact>(5e-16);
+}
+
+TEST (StatsTest, InstructionSetConsistency)
+{
+	const EInstructionSet best = details::CInstructionSet::Detect();
+
+	const size_t N = 1001;
+	std::vector<double> x(N), expected(N), y(N);
+	for (size_t i = 0; i < N; ++i)
+		x[i] = -8.0 + 16.0 * i / (N - 1);
+
+	ASSERT_TRUE(details::CInstructionSet::Set(EInstructionSet::Sse2));
+	CStats::normCdf<EAccuracy::Exact>(x.data(), expected.data(), N);
+
+	for (const auto instructionSet : { EInstructionSet::Avx2, EInstructionSet::Avx512 })
+	{
+		if (!details::CInstructionSet::Set(instructionSet))
+			continue;
+
+		// the variants do not contract into FMA's: same results as the baseline
+		CStats::normCdf<EAccuracy::Exact>(x.data(), y.data(), N);
+		for (size_t i = 0; i < N; ++i)
+			ASSERT_EQ(expected[i], y[i]);
+	}
+
+	ASSERT_TRUE(details::CInstructionSet::Set(best));
+}
@@ -8,6 +8,7 @@
 
 #include <gtest/gtest.h>
 #include <FiniteDifference/CEvolutionOperator.h>
+#include <FiniteDifference/CEvolutionOperatorCache.h>
 
 using namespace fdpricing;
 
@@ -31,7 +32,7 @@ TEST (TridiagonalOperator, ExplicitEulerBase)
 	for (size_t i = 0; i < payoffData.payoff_i.size(); ++i)
 		payoffData.payoff_i[i] = 5.0 + i;
 	payoffData.payoff_i[inputData.N / 2] = 2.0;
-	std::vector<double> xCopy(payoffData.payoff_i);
+	std::vector<double> xCopy(payoffData.payoff_i.begin(), payoffData.payoff_i.end());
 
 	u.Apply(payoffData);
 
@@ -227,7 +228,7 @@ TEST (TridiagonalOperator, ImplicitEulerBase)
 	for (size_t i = 0; i < payoffData.payoff_i.size(); ++i)
 		payoffData.payoff_i[i] = 5.0 + i;
 	payoffData.payoff_i[inputData.N / 2] = 2.0;
-	std::vector<double> x(payoffData.payoff_i);
+	std::vector<double> x(payoffData.payoff_i.begin(), payoffData.payoff_i.end());
 
 	u.Apply(payoffData);
 
@@ -460,7 +461,7 @@ TEST (TridiagonalOperator, CrankNicolsonBase)
 	for (size_t i = 0; i < payoffData.payoff_i.size(); ++i)
 		payoffData.payoff_i[i] = 5.0 + i;
 	payoffData.payoff_i[inputData.N / 2] = 2.0;
-	std::vector<double> x(payoffData.payoff_i);
+	std::vector<double> x(payoffData.payoff_i.begin(), payoffData.payoff_i.end());
 
 	u.Apply(payoffData);
 
@@ -702,3 +703,462 @@ TEST (TridiagonalOperator, CrankNicolsonAll)
 
 
 
+
+template<ESolverType solverType>
+void DiscountFactorWorker()
+{
+	CInputData inputData;
+	inputData.S = 100.0;
+	inputData.b = .002;
+	inputData.r = .05;
+	inputData.sigma = .03;
+	inputData.N = 129;
+	inputData.T = 1.0;
+	inputData.M = 10;
+
+	CInputData inputDataNoRate(inputData);
+	inputDataNoRate.r = 0.0;
+
+	CFiniteDifferenceSettings settings;
+	CEvolutionOperator<solverType, EGridType::Adaptive, EAdjointDifferentiation::All> u(inputData, settings);
+	CEvolutionOperator<solverType, EGridType::Adaptive, EAdjointDifferentiation::All> uNoRate(inputDataNoRate, settings);
+
+	CPayoffData payoffData;
+	payoffData.Init<EAdjointDifferentiation::All>(inputData.N);
+	for (size_t i = 0; i < inputData.N; ++i)
+	{
+		payoffData.payoff_i[i] = std::max(u.GetGrid().Get(i) - inputData.S, 0.0);
+		payoffData.vega_i[i] = .1 * i;
+		payoffData.rho_i[i] = -.2 * i;
+		payoffData.rhoBorrow_i[i] = .3 * i;
+	}
+	CPayoffData payoffDataNoRate(payoffData);
+
+	u.Apply(payoffData);
+	uNoRate.Apply(payoffDataNoRate);
+
+	// the discount factor is folded into the operator, Jacobians included
+	const double df = exp(-inputData.r * inputData.T / inputData.M);
+	ASSERT_DOUBLE_EQ(df, u.GetDiscountFactor());
+	for (size_t i = 0; i < inputData.N; ++i)
+	{
+		ASSERT_NEAR(df * payoffDataNoRate.payoff_i[i], payoffData.payoff_i[i], 1e-12 * std::max(1.0, fabs(payoffData.payoff_i[i])));
+		ASSERT_NEAR(df * payoffDataNoRate.vega_i[i], payoffData.vega_i[i], 1e-12 * std::max(1.0, fabs(payoffData.vega_i[i])));
+		ASSERT_NEAR(df * payoffDataNoRate.rho_i[i], payoffData.rho_i[i], 1e-12 * std::max(1.0, fabs(payoffData.rho_i[i])));
+		ASSERT_NEAR(df * payoffDataNoRate.rhoBorrow_i[i], payoffData.rhoBorrow_i[i], 1e-12 * std::max(1.0, fabs(payoffData.rhoBorrow_i[i])));
+	}
+}
+
+TEST (TridiagonalOperator, DiscountFactor)
+{
+	DiscountFactorWorker<ESolverType::ExplicitEuler>();
+	DiscountFactorWorker<ESolverType::ImplicitEuler>();
+	DiscountFactorWorker<ESolverType::CrankNicolson>();
+}
+
+template<ESolverType solverType>
+void PartitionedWorker()
+{
+	CInputData inputData;
+	inputData.S = 100.0;
+	inputData.b = .02;
+	inputData.r = .05;
+	inputData.sigma = .3;
+	inputData.N = 2049;
+	inputData.T = 1.0;
+	inputData.M = 10;
+
+	CFiniteDifferenceSettings settings;
+	settings.parallelSolveMinN = 0;
+	CEvolutionOperator<solverType, EGridType::Adaptive, EAdjointDifferentiation::All> u(inputData, settings);
+	ASSERT_EQ(1, u.GetPartitions());
+
+	CPayoffData payoffData;
+	payoffData.Init<EAdjointDifferentiation::All>(inputData.N);
+	for (size_t i = 0; i < inputData.N; ++i)
+	{
+		payoffData.payoff_i[i] = std::max(u.GetGrid().Get(i) - inputData.S, 0.0);
+		payoffData.vega_i[i] = .1 * i;
+		payoffData.rho_i[i] = -.2 * i;
+		payoffData.rhoBorrow_i[i] = .3 * i;
+	}
+	CPayoffData payoffDataPut(payoffData);
+	for (size_t i = 0; i < inputData.N; ++i)
+		payoffDataPut.payoff_i[i] = std::max(inputData.S - u.GetGrid().Get(i), 0.0);
+
+	CPayoffData expected(payoffData), expectedPut(payoffDataPut);
+	u.template Apply<2>({ { &expected, &expectedPut } });
+
+	// partitions that do not divide the grid, down to the smallest ones
+	settings.parallelSolveMinN = 1;
+	settings.minPartitionSize = 64;
+	for (const size_t nThreads : { 2, 3, 4, 7 })
+	{
+		settings.parallelSolveThreads = nThreads;
+		CEvolutionOperator<solverType, EGridType::Adaptive, EAdjointDifferentiation::All> uPartitioned(inputData, settings);
+		ASSERT_EQ(nThreads, uPartitioned.GetPartitions());
+
+		CPayoffData x(payoffData), xPut(payoffDataPut);
+		details::CThreadTeam team(nThreads);
+		std::vector<double> buffer(CTridiagonalOperator<EGridType::Adaptive, EAdjointDifferentiation::All>::template PartitionBufferSize<2>(nThreads));
+		team.Run([&](const size_t p) { uPartitioned.template Apply<2>({ { &x, &xPut } }, p, team, buffer.data()); });
+
+		// the same up to rounding
+		auto check = [](const auto& unaliased a, const auto& unaliased b)
+		{
+			for (size_t i = 0; i < a.size(); ++i)
+				ASSERT_NEAR(a[i], b[i], 1e-10 * std::max(1.0, fabs(a[i])));
+		};
+		check(expected.payoff_i, x.payoff_i);
+		check(expected.vega_i, x.vega_i);
+		check(expected.rho_i, x.rho_i);
+		check(expected.rhoBorrow_i, x.rhoBorrow_i);
+		check(expectedPut.payoff_i, xPut.payoff_i);
+		check(expectedPut.vega_i, xPut.vega_i);
+		check(expectedPut.rho_i, xPut.rho_i);
+		check(expectedPut.rhoBorrow_i, xPut.rhoBorrow_i);
+	}
+}
+
+/**
+ * Each thread updates its partition of the grid, the implicit solves being coupled through the separators
+ */
+TEST (TridiagonalOperator, Partitioned)
+{
+	PartitionedWorker<ESolverType::ExplicitEuler>();
+	PartitionedWorker<ESolverType::ImplicitEuler>();
+	PartitionedWorker<ESolverType::CrankNicolson>();
+}
+
+TEST (TridiagonalOperator, SharedGrid)
+{
+	CInputData inputData;
+	inputData.S = 100.0;
+	inputData.r = .05;
+	inputData.b = .002;
+	inputData.N = 129;
+	inputData.T = 1.0;
+	inputData.M = 100;
+
+	CFiniteDifferenceSettings settings;
+	CGrid<EGridType::Adaptive> grid(inputData.S, settings.lowerFactor * inputData.S, settings.upperFactor * inputData.S, inputData.N);
+
+	// vol scenarios: the grid is built once
+	for (const double sigma : { .1, .2, .3 })
+	{
+		inputData.sigma = sigma;
+		CEvolutionOperator<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> u(inputData, settings);
+		CEvolutionOperator<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> uShared(inputData, grid, settings);
+
+		CPayoffData payoffData;
+		payoffData.Init<EAdjointDifferentiation::All>(inputData.N);
+		for (size_t i = 0; i < inputData.N; ++i)
+			payoffData.payoff_i[i] = std::max(grid.Get(i) - 100.0, 0.0);
+		CPayoffData payoffDataShared(payoffData);
+
+		u.Apply(payoffData);
+		uShared.Apply(payoffDataShared);
+		for (size_t i = 0; i < inputData.N; ++i)
+		{
+			ASSERT_EQ(payoffData.payoff_i[i], payoffDataShared.payoff_i[i]);
+			ASSERT_EQ(payoffData.vega_i[i], payoffDataShared.vega_i[i]);
+			ASSERT_EQ(payoffData.rho_i[i], payoffDataShared.rho_i[i]);
+			ASSERT_EQ(payoffData.rhoBorrow_i[i], payoffDataShared.rhoBorrow_i[i]);
+		}
+	}
+}
+
+TEST (TridiagonalOperator, OperatorCache)
+{
+	CInputData inputData;
+	inputData.S = 100.0;
+	inputData.r = .05;
+	inputData.b = .002;
+	inputData.sigma = .2;
+	inputData.N = 129;
+	inputData.T = 1.0;
+	inputData.M = 100;
+
+	typedef CEvolutionOperator<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> Operator;
+	CFiniteDifferenceSettings settings;
+	Operator u(inputData, settings);
+
+	CEvolutionOperatorCache<Operator> cache(2);
+	Operator& u1 = cache.Get(u, .003);
+	ASSERT_EQ(&u1, &cache.Get(u, .003 + 1e-16));
+	ASSERT_EQ(1, cache.size());
+
+	// grid is shared, not copied
+	ASSERT_EQ(&u.GetGrid(), &u1.GetGrid());
+
+	// the oldest operator is evicted
+	cache.Get(u, .004);
+	cache.Get(u, .005);
+	ASSERT_EQ(2, cache.size());
+	ASSERT_NEAR(.005, cache.Get(u, .005).GetDt(), 1e-12);
+
+	// same as a stand alone operator, dt being rounded
+	Operator& u2Cached = cache.Get(u, .002);
+	ASSERT_NEAR(.002, u2Cached.GetDt(), 1e-12);
+	Operator u2(u, u2Cached.GetDt());
+	CPayoffData payoffData;
+	payoffData.Init<EAdjointDifferentiation::All>(inputData.N);
+	for (size_t i = 0; i < inputData.N; ++i)
+		payoffData.payoff_i[i] = std::max(u.GetGrid().Get(i) - 100.0, 0.0);
+	CPayoffData payoffDataCached(payoffData);
+
+	u2.Apply(payoffData);
+	u2Cached.Apply(payoffDataCached);
+	for (size_t i = 0; i < inputData.N; ++i)
+	{
+		ASSERT_NEAR(payoffData.payoff_i[i], payoffDataCached.payoff_i[i], 1e-12);
+		ASSERT_NEAR(payoffData.vega_i[i], payoffDataCached.vega_i[i], 1e-12);
+		ASSERT_NEAR(payoffData.rhoBorrow_i[i], payoffDataCached.rhoBorrow_i[i], 1e-12);
+	}
+}
+
+/**
+ * Brennan-Schwartz solves the linear complementarity problem x >= g, A \cdot x >= b, (x - g) \cdot (A \cdot x - b) = 0,
+ * for calls going up the grid and for puts going down. The vector which is not projected is solved as usual
+ */
+TEST (TridiagonalOperator, BrennanSchwartz)
+{
+	typedef details::CDispatchedTridiagonalKernels<double> Kernels;
+
+	const size_t N = 101;
+	std::vector<double> sub(N, -.4), diag(N, 1.8), super(N, -.4), intrinsic(N);
+	sub[0] = super[N - 1] = 0.0;
+	for (size_t i = 0; i < N; ++i)
+		intrinsic[i] = i - 50.0;
+
+	std::vector<double> upper(N), inversePivot(N), lower(N), reversedInversePivot(N);
+	Kernels::Factorize(upper.data(), inversePivot.data(), sub.data(), diag.data(), super.data(), N);
+	Kernels::FactorizeReversed(lower.data(), reversedInversePivot.data(), sub.data(), diag.data(), super.data(), N);
+
+	for (const double sign : { 1.0, -1.0 })
+	{
+		// a continuation value below the intrinsic deep in the money, so that the exercise region is attached to the boundary
+		std::vector<double> b(N);
+		for (size_t i = 0; i < N; ++i)
+			b[i] = .9 * std::max(sign * intrinsic[i], 0.0);
+
+		std::vector<double> x(b), y(b), expected(b);
+		const std::array<double, 1> signs = { { sign } };
+		if (sign > 0.0)
+			Kernels::ProjectedSolve<false, 2, 1>({ { x.data(), y.data() } }, intrinsic.data(), signs, sub.data(), upper.data(), inversePivot.data(), N);
+		else
+			Kernels::ProjectedSolve<true, 2, 1>({ { x.data(), y.data() } }, intrinsic.data(), signs, super.data(), lower.data(), reversedInversePivot.data(), N);
+		Kernels::Solve<1>({ { expected.data() } }, sub.data(), upper.data(), inversePivot.data(), N);
+
+		size_t nExercised = 0;
+		for (size_t i = 0; i < N; ++i)
+		{
+			double Ax = diag[i] * x[i];
+			if (i > 0)
+				Ax += sub[i] * x[i - 1];
+			if (i < N - 1)
+				Ax += super[i] * x[i + 1];
+
+			const double g = sign * intrinsic[i];
+			ASSERT_GE(x[i] - g, -1e-12);
+			ASSERT_GE(Ax - b[i], -1e-12);
+			ASSERT_NEAR(std::min(x[i] - g, Ax - b[i]), 0.0, 1e-12);
+			nExercised += x[i] == g;
+
+			ASSERT_NEAR(y[i], expected[i], 1e-12);
+		}
+		EXPECT_GT(nExercised, 0);
+		EXPECT_LT(nExercised, N);
+	}
+}
+
+/**
+ * The fused Brennan-Schwartz Crank-Nicolson step, where B \cdot x and the Jacobian products are computed during the elimination (up the grid for calls,
+ * down the grid for puts), is the same as the explicit product followed by the projected solve
+ */
+TEST (TridiagonalOperator, FusedBrennanSchwartz)
+{
+	typedef details::CDispatchedTridiagonalKernels<double> Kernels;
+
+	const size_t N = 101;
+	std::vector<double> sub(N), diag(N), super(N), dotSub(N), dotDiag(N), dotSuper(N), jacobianSub(N), jacobianDiag(N), jacobianSuper(N), intrinsic(N);
+	for (size_t i = 0; i < N; ++i)
+	{
+		sub[i] = i > 0 ? -.4 - .001 * i : 0.0;
+		super[i] = i + 1 < N ? -.3 - .002 * i : 0.0;
+		diag[i] = 1.0 - sub[i] - super[i];
+		dotSub[i] = -sub[i];
+		dotSuper[i] = -super[i];
+		dotDiag[i] = 2.0 - diag[i];
+		jacobianSub[i] = .01 * std::sin(.1 * i);
+		jacobianDiag[i] = .02 * std::cos(.1 * i);
+		jacobianSuper[i] = .03 * std::sin(.2 * i);
+		intrinsic[i] = i - 50.0;
+	}
+
+	std::vector<double> upper(N), inversePivot(N), lower(N), reversedInversePivot(N);
+	Kernels::Factorize(upper.data(), inversePivot.data(), sub.data(), diag.data(), super.data(), N);
+	Kernels::FactorizeReversed(lower.data(), reversedInversePivot.data(), sub.data(), diag.data(), super.data(), N);
+
+	for (const double sign : { 1.0, -1.0 })
+	{
+		std::vector<double> x(N), v(N);
+		for (size_t i = 0; i < N; ++i)
+		{
+			x[i] = .9 * std::max(sign * intrinsic[i], 0.0);
+			v[i] = std::sin(.05 * i);
+		}
+		std::vector<double> expectedX(x), expectedV(v), expectedW(N, 0.0), w(N, 0.0);
+
+		// the tangent v is coupled to x through J, in the explicit product and in the correction of the implicit one
+		std::array<details::CSweepVector<double>, 2> expected;
+		expected[0].x = expectedX.data();
+		expected[1].x = expectedV.data();
+		expected[1].source = 0;
+		expected[1].jacobianSub = jacobianSub.data();
+		expected[1].jacobianDiag = jacobianDiag.data();
+		expected[1].jacobianSuper = jacobianSuper.data();
+		std::array<details::CSweepVector<double>, 2> fused(expected);
+		fused[0].x = x.data();
+		fused[1].x = v.data();
+
+		const std::array<double, 1> signs = { { sign } };
+		Kernels::Dot<2>(dotSub.data(), dotDiag.data(), dotSuper.data(), expected, N);
+		if (sign > 0.0)
+		{
+			Kernels::ProjectedSolve<false, 2, 1>({ { expectedX.data(), expectedV.data() } }, intrinsic.data(), signs, sub.data(), upper.data(), inversePivot.data(), N);
+			Kernels::DotForwardSubstitute<false>(dotSub.data(), dotDiag.data(), dotSuper.data(), fused, sub.data(), inversePivot.data(), N);
+			Kernels::ProjectedBackSubstitute<false, 2, 1>({ { x.data(), v.data() } }, intrinsic.data(), signs, upper.data(), N);
+		}
+		else
+		{
+			Kernels::ProjectedSolve<true, 2, 1>({ { expectedX.data(), expectedV.data() } }, intrinsic.data(), signs, super.data(), lower.data(), reversedInversePivot.data(), N);
+			Kernels::DotForwardSubstitute<true>(dotSub.data(), dotDiag.data(), dotSuper.data(), fused, super.data(), reversedInversePivot.data(), N);
+			Kernels::ProjectedBackSubstitute<true, 2, 1>({ { x.data(), v.data() } }, intrinsic.data(), signs, lower.data(), N);
+		}
+
+		// w = -A^{-1} \cdot J \cdot x
+		std::array<details::CJacobianTerm<double>, 1> expectedTerm;
+		expectedTerm[0].out = expectedW.data();
+		expectedTerm[0].x = expectedX.data();
+		expectedTerm[0].jacobianSub = jacobianSub.data();
+		expectedTerm[0].jacobianDiag = jacobianDiag.data();
+		expectedTerm[0].jacobianSuper = jacobianSuper.data();
+		std::array<details::CJacobianTerm<double>, 1> term(expectedTerm);
+		term[0].out = w.data();
+		term[0].x = x.data();
+
+		Kernels::Add<1>(-1.0, expectedTerm, N);
+		Kernels::Solve<1>({ { expectedW.data() } }, sub.data(), upper.data(), inversePivot.data(), N);
+		if (sign > 0.0)
+		{
+			Kernels::AddForwardSubstitute<false>(-1.0, term, sub.data(), inversePivot.data(), N);
+			Kernels::BackSubstitute<false, 1>({ { w.data() } }, upper.data(), N);
+		}
+		else
+		{
+			Kernels::AddForwardSubstitute<true>(-1.0, term, super.data(), reversedInversePivot.data(), N);
+			Kernels::BackSubstitute<true, 1>({ { w.data() } }, lower.data(), N);
+		}
+
+		for (size_t i = 0; i < N; ++i)
+		{
+			ASSERT_NEAR(expectedX[i], x[i], 1e-12 * std::max(1.0, fabs(expectedX[i])));
+			ASSERT_NEAR(expectedV[i], v[i], 1e-12);
+			ASSERT_NEAR(expectedW[i], w[i], 1e-12);
+		}
+	}
+}
+
+/**
+ * The hybrid cyclic reduction solves the same systems as the Thomas algorithm, whatever the size (shorter than a step of the reduced system
+ * or not a multiple of it) and the number of vectors
+ */
+TEST (TridiagonalOperator, CyclicReduction)
+{
+	typedef details::CDispatchedTridiagonalKernels<double> Kernels;
+	constexpr size_t S = details::Padded<double>(1);
+
+	for (const size_t N : { 1, 2, 5, 8, 9, 31, 129, 513 })
+	{
+		std::vector<double> sub(N), diag(N), super(N);
+		for (size_t i = 0; i < N; ++i)
+		{
+			sub[i] = i > 0 ? -.4 - .001 * i : 0.0;
+			super[i] = i + 1 < N ? -.3 - .002 * i : 0.0;
+			diag[i] = 1.0 - sub[i] - super[i] + .01 * (i % 3);
+		}
+
+		std::vector<double> upper(N), inversePivot(N);
+		Kernels::Factorize(upper.data(), inversePivot.data(), sub.data(), diag.data(), super.data(), N);
+		std::vector<double> factors(details::CyclicReductionFactorsSize(S, N));
+		Kernels::FactorizeCyclicReduction<S>(factors.data(), sub.data(), diag.data(), super.data(), N);
+
+		std::vector<double> x(N), y(N);
+		for (size_t i = 0; i < N; ++i)
+		{
+			x[i] = std::sin(.1 * i) + 1.0;
+			y[i] = i * .5;
+		}
+		std::vector<double> expectedX(x), expectedY(y);
+		Kernels::Solve<2>({ { expectedX.data(), expectedY.data() } }, sub.data(), upper.data(), inversePivot.data(), N);
+
+		std::vector<double> buffer(details::CyclicReductionBufferSize(S, 2, N));
+		Kernels::CyclicReductionSolve<2, S>({ { x.data(), y.data() } }, factors.data(), buffer.data(), N);
+		for (size_t i = 0; i < N; ++i)
+		{
+			ASSERT_NEAR(expectedX[i], x[i], 1e-13 * std::max(1.0, fabs(expectedX[i])));
+			ASSERT_NEAR(expectedY[i], y[i], 1e-13 * std::max(1.0, fabs(expectedY[i])));
+		}
+	}
+}
+
+template<ESolverType solverType>
+void CyclicReductionWorker()
+{
+	CInputData inputData;
+	inputData.S = 100.0;
+	inputData.b = .02;
+	inputData.r = .05;
+	inputData.sigma = .3;
+	inputData.N = 257;
+	inputData.T = 1.0;
+	inputData.M = 10;
+
+	CFiniteDifferenceSettings settings;
+	CEvolutionOperator<solverType, EGridType::Adaptive, EAdjointDifferentiation::All> u(inputData, settings);
+	ASSERT_FALSE(u.HasCyclicReduction());
+
+	settings.cyclicReductionMaxN = inputData.N;
+	CEvolutionOperator<solverType, EGridType::Adaptive, EAdjointDifferentiation::All> uReduction(inputData, settings);
+	ASSERT_TRUE(uReduction.HasCyclicReduction());
+
+	CPayoffData payoffData;
+	payoffData.Init<EAdjointDifferentiation::All>(inputData.N);
+	for (size_t i = 0; i < inputData.N; ++i)
+	{
+		payoffData.payoff_i[i] = std::max(u.GetGrid().Get(i) - inputData.S, 0.0);
+		payoffData.vega_i[i] = .1 * i;
+		payoffData.rho_i[i] = -.2 * i;
+		payoffData.rhoBorrow_i[i] = .3 * i;
+	}
+	CPayoffData expected(payoffData);
+	u.Apply(expected);
+
+	std::vector<double> buffer(CTridiagonalOperator<EGridType::Adaptive, EAdjointDifferentiation::All>::template ReductionBufferSize<1>(inputData.N));
+	uReduction.template Apply<1>({ { &payoffData } }, buffer.data());
+
+	for (size_t i = 0; i < inputData.N; ++i)
+	{
+		ASSERT_NEAR(expected.payoff_i[i], payoffData.payoff_i[i], 1e-12 * std::max(1.0, fabs(expected.payoff_i[i])));
+		ASSERT_NEAR(expected.vega_i[i], payoffData.vega_i[i], 1e-12 * std::max(1.0, fabs(expected.vega_i[i])));
+		ASSERT_NEAR(expected.rho_i[i], payoffData.rho_i[i], 1e-12 * std::max(1.0, fabs(expected.rho_i[i])));
+		ASSERT_NEAR(expected.rhoBorrow_i[i], payoffData.rhoBorrow_i[i], 1e-12 * std::max(1.0, fabs(expected.rhoBorrow_i[i])));
+	}
+}
+
+TEST (TridiagonalOperator, CyclicReductionOperator)
+{
+	CyclicReductionWorker<ESolverType::ImplicitEuler>();
+	CyclicReductionWorker<ESolverType::CrankNicolson>();
+}
@@ -6,14 +6,67 @@
  */
 
 #include <cmath>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <limits>
 #include <gtest/gtest.h>
 #include <BlackScholes/CBlackScholes.h>
 #include <FiniteDifference/CFDPricer.h>
+#include <FiniteDifference/CBatchPricer.h>
+#include <FiniteDifference/CFixedSizePricer.h>
+#include <FiniteDifference/COperatorRegistry.h>
+#include <Utilities/CArena.h>
+#include <Utilities/CAllocationCounter.h>
+#include <Utilities/CInstructionSet.h>
+
+#ifdef COUNT_ALLOCATIONS
+/**
+ * Global operator new is replaced only when counting allocations (see Flags.h), for feeding the allocation counter: see FDTest.ZeroAllocationSteadyState.
+ * Not inlined, otherwise the compiler sees free called on memory from operator new
+ */
+__attribute__((noinline)) void* operator new(size_t size)
+{
+	++details::CAllocationCounter::Count();
+
+	void* ptr = malloc(size ? size : 1);
+	if (!ptr)
+		throw std::bad_alloc();
+
+	return ptr;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	operator delete(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+	operator delete(ptr);
+}
+#endif
 
 using namespace fdpricing;
 
 
-TEST (FDTest, BlackScholesConsistency)
+template<EPrecision precision>
+void BlackScholesConsistencyWorker()
 {
 	CInputData input;
 	input.smoothing = true;
@@ -31,7 +84,7 @@ TEST (FDTest, BlackScholesConsistency)
 	CPricerSettings settings;
 	settings.exerciseType = EExerciseType::European;
 
-	CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> pricer(input, settings);
+	CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All, 0, precision> pricer(input, settings);
 
 	double bsC = bs.Value<EOptionType::Call>();
 	double bsP = bs.Value<EOptionType::Put>();
@@ -47,30 +100,39 @@ TEST (FDTest, BlackScholesConsistency)
 	COutputData callOutput, putOutput;
 	pricer.Price(callOutput, putOutput);
 
-	ASSERT_LE(fabs(bsC - callOutput.price), 0.00281162);
-	ASSERT_LE(fabs(bsP - putOutput.price) , 0.00207582);
+	// single precision round-off adds to the discretization error: it has its own tolerances
+	const bool single = precision == EPrecision::Single;
 
-	ASSERT_LE(fabs(bsV - callOutput.vega), 0.438633);
-	ASSERT_LE(fabs(bsV - putOutput.vega), 0.440376);
+	ASSERT_LE(fabs(bsC - callOutput.price), single ? 0.0029 : 0.00281162);
+	ASSERT_LE(fabs(bsP - putOutput.price) , single ? 0.0022 : 0.00207582);
 
-	ASSERT_LE(fabs(bsRC - callOutput.rho), 0.00562323);
-	ASSERT_LE(fabs(bsRP - putOutput.rho), 0.00415164);
+	ASSERT_LE(fabs(bsV - callOutput.vega), single ? 0.034 : 0.438633);
+	ASSERT_LE(fabs(bsV - putOutput.vega), single ? 0.005 : 0.440376);
 
-	ASSERT_LE(fabs(bsRBC - callOutput.rhoBorrow), 0.034);
-	ASSERT_LE(fabs(bsRBP - putOutput.rhoBorrow), 0.0172);
+	ASSERT_LE(fabs(bsRC - callOutput.rho), single ? 0.0058 : 0.00562323);
+	ASSERT_LE(fabs(bsRP - putOutput.rho), single ? 0.0044 : 0.00415164);
 
-	ASSERT_LE(fabs(bsRBC - callOutput.rhoBorrow), 0.034);
-	ASSERT_LE(fabs(bsRBP - putOutput.rhoBorrow), 0.0172);
+	ASSERT_LE(fabs(bsRBC - callOutput.rhoBorrow), single ? 0.035 : 0.034);
+	ASSERT_LE(fabs(bsRBP - putOutput.rhoBorrow), single ? 0.018 : 0.0172);
 
-	ASSERT_LE(fabs(bsDC - callOutput.delta), 0.000174);
-	ASSERT_LE(fabs(bsDP - putOutput.delta), 9.8392e-05);
+	ASSERT_LE(fabs(bsRBC - callOutput.rhoBorrow), single ? 0.035 : 0.034);
+	ASSERT_LE(fabs(bsRBP - putOutput.rhoBorrow), single ? 0.018 : 0.0172);
 
-	ASSERT_LE(fabs(bsG - callOutput.gamma), 5.40176e-06);
-	ASSERT_LE(fabs(bsG - putOutput.gamma), 5.63647e-07);
+	ASSERT_LE(fabs(bsDC - callOutput.delta), single ? 0.000175 : 0.000174);
+	ASSERT_LE(fabs(bsDP - putOutput.delta), single ? 0.0001 : 9.8392e-05);
+
+	ASSERT_LE(fabs(bsG - callOutput.gamma), single ? 6.4e-06 : 5.40176e-06);
+	ASSERT_LE(fabs(bsG - putOutput.gamma), single ? 5e-07 : 5.63647e-07);
 
 	// TODO: implement bs theta and compare it
 }
 
+TEST (FDTest, BlackScholesConsistency)
+{
+	BlackScholesConsistencyWorker<EPrecision::Double>();
+	BlackScholesConsistencyWorker<EPrecision::Single>();
+}
+
 
 TEST  (FDTest, AccelerationConsistency)
 {
@@ -188,7 +250,8 @@ TEST (FDTest, AmericanOptionNoExercise)
 }
 
 
-TEST (FDTest, BinomialTreeConsistency)
+template<EPrecision precision>
+void BinomialTreeConsistencyWorker()
 {
 	CInputData input;
 	input.smoothing = true;
@@ -204,13 +267,21 @@ TEST (FDTest, BinomialTreeConsistency)
 	CPricerSettings settings;
 	settings.exerciseType = EExerciseType::American;
 
-	CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::None> pricer(input, settings);
+	CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::None, 0, precision> pricer(input, settings);
 
 	COutputData callOutput, putOutput;
 	pricer.Price(callOutput, putOutput);
 
-	ASSERT_LE(fabs(21.198671628986794 - callOutput.price), .0155);
-	ASSERT_LE(fabs(12.845527283509988 - putOutput.price) , .0203);
+	// single precision has its own tolerances
+	const bool single = precision == EPrecision::Single;
+	ASSERT_LE(fabs(21.198671628986794 - callOutput.price), single ? .0062 : .0155);
+	ASSERT_LE(fabs(12.845527283509988 - putOutput.price) , single ? .0213 : .0203);
+}
+
+TEST (FDTest, BinomialTreeConsistency)
+{
+	BinomialTreeConsistencyWorker<EPrecision::Double>();
+	BinomialTreeConsistencyWorker<EPrecision::Single>();
 }
 
 
@@ -456,7 +527,8 @@ TEST (FDTest, Convergence)
 /**
  * http://doc.utwente.nl/58556/1/Vellekoop06efficient.pdf
  */
-TEST (FDTest, VellekoopPage280Table1)
+template<EPrecision precision>
+void VellekoopPage280Table1Worker(const bool brennanSchwartz = false)
 {
 	CInputData input;
 	input.S = 100;
@@ -476,9 +548,10 @@ TEST (FDTest, VellekoopPage280Table1)
 
 		CPricerSettings settings;
 		settings.exerciseType = EExerciseType::American;
+		settings.fdSettings.brennanSchwartz = brennanSchwartz;
 
 		settings.calculationType = ECalculationType::All;
-		CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::None> pricer(input, settings);
+		CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::None, 0, precision> pricer(input, settings);
 		pricer.Price(callOutput, putOutput);
 
 		double pn = callOutput.price;
@@ -511,10 +584,20 @@ TEST (FDTest, VellekoopPage280Table1)
 	EXPECT_LE(fabs(RE() - 4.17), 0.01);
 }
 
+TEST (FDTest, VellekoopPage280Table1)
+{
+	VellekoopPage280Table1Worker<EPrecision::Double>();
+	VellekoopPage280Table1Worker<EPrecision::Single>();
+
+	VellekoopPage280Table1Worker<EPrecision::Double>(true);
+	VellekoopPage280Table1Worker<EPrecision::Single>(true);
+}
+
 /**
  * http://doc.utwente.nl/58556/1/Vellekoop06efficient.pdf
  */
-TEST (FDTest, VellekoopPage282Table3)
+template<EPrecision precision>
+void VellekoopPage282Table3Worker(const bool brennanSchwartz = false)
 {
 	CInputData input;
 	input.S = 100;
@@ -535,9 +618,10 @@ TEST (FDTest, VellekoopPage282Table3)
 
 		CPricerSettings settings;
 		settings.exerciseType = EExerciseType::American;
+		settings.fdSettings.brennanSchwartz = brennanSchwartz;
 
 		settings.calculationType = ECalculationType::All;
-		CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::None> pricer(input, settings);
+		CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::None, 0, precision> pricer(input, settings);
 		pricer.Price(callOutput, putOutput);
 
 		double pn = callOutput.price;
@@ -576,6 +660,71 @@ TEST (FDTest, VellekoopPage282Table3)
 	EXPECT_LE(fabs(RE() - 15.21), 0.01);
 }
 
+TEST (FDTest, VellekoopPage282Table3)
+{
+	VellekoopPage282Table3Worker<EPrecision::Double>();
+	VellekoopPage282Table3Worker<EPrecision::Single>();
+
+	VellekoopPage282Table3Worker<EPrecision::Double>(true);
+	VellekoopPage282Table3Worker<EPrecision::Single>(true);
+}
+
+/**
+ * The projection after the step is only first order in time at the free boundary, whereas Brennan-Schwartz solves the
+ * linear complementarity problem of the step: with the same M, its error against a fine reference is lower
+ */
+template<ESolverType solverType>
+void BrennanSchwartzWorker(const ECalculationType calculationType)
+{
+	CInputData input;
+	input.S = 100;
+	input.K = 100;
+	input.r = .05;
+	input.b = calculationType == ECalculationType::CallOnly ? -.03 : .05;
+	input.sigma = .3;
+	input.T = 1.0;
+	input.N = 201;
+	input.smoothing = true;
+	input.acceleration = false;
+
+	auto RE = [&](const size_t M, const bool brennanSchwartz)
+	{
+		COutputData callOutput;
+		COutputData putOutput;
+
+		CPricerSettings settings;
+		settings.exerciseType = EExerciseType::American;
+		settings.calculationType = calculationType;
+		settings.fdSettings.brennanSchwartz = brennanSchwartz;
+
+		input.M = M;
+		CFDPricer<solverType, EGridType::Adaptive, EAdjointDifferentiation::None> pricer(input, settings);
+		pricer.Price(callOutput, putOutput);
+
+		return calculationType == ECalculationType::CallOnly ? callOutput.price : putOutput.price;
+	};
+
+	const double reference = RE(4000, true);
+	ASSERT_LE(fabs(reference - RE(4000, false)), 1e-3);
+
+	double previousError = std::numeric_limits<double>::max();
+	for (size_t M = 10; M <= 160; M *= 2)
+	{
+		const double error = fabs(RE(M, true) - reference);
+		EXPECT_LT(error, fabs(RE(M, false) - reference));
+		EXPECT_LT(error, previousError);
+		previousError = error;
+	}
+}
+
+TEST (FDTest, BrennanSchwartz)
+{
+	BrennanSchwartzWorker<ESolverType::ImplicitEuler>(ECalculationType::PutOnly);
+	BrennanSchwartzWorker<ESolverType::ImplicitEuler>(ECalculationType::CallOnly);
+	BrennanSchwartzWorker<ESolverType::CrankNicolson>(ECalculationType::PutOnly);
+	BrennanSchwartzWorker<ESolverType::CrankNicolson>(ECalculationType::CallOnly);
+}
+
 /**
  * http://doc.utwente.nl/58556/1/Vellekoop06efficient.pdf
  */
@@ -753,3 +902,993 @@ TEST (FDTest, AccelerationDividendConsistency)
 	EXPECT_LE(fabs(putOutput.rho - putOutput2.rho), 1e-12);
 	EXPECT_LE(fabs(putOutput.rhoBorrow - putOutput2.rhoBorrow), 1e-12);
 }
+
+TEST (FDTest, AccelerationSingleDividend)
+{
+	// with a single dividend there's none left to meet once the non-accelerated option reaches it
+	CInputData input;
+	input.S = 100;
+	input.K = 100;
+	input.r = .06;
+	input.b = .06;
+	input.sigma = .25;
+	input.T = 2;
+	input.N = 257;
+	input.M = 80;
+	input.smoothing = true;
+	input.acceleration = true;
+	input.dividends.resize(1);
+	input.dividends[0] = CDividend(1.11, 6.0);
+
+	COutputData callOutput;
+	COutputData putOutput;
+
+	CPricerSettings settings;
+	settings.exerciseType = EExerciseType::American;
+
+	settings.calculationType = ECalculationType::All;
+	CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> pricer(input, settings);
+	pricer.Price(callOutput, putOutput);
+
+	CInputData input2(input);
+	input2.acceleration = false;
+
+	COutputData callOutput2;
+	COutputData putOutput2;
+
+	CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> pricer2(input2, settings);
+	pricer2.Price(callOutput2, putOutput2);
+
+	// The accelerated option should be close enough
+	EXPECT_LE(fabs(callOutput.price - callOutput2.price), 1e-3);
+
+	// The non-accelerated option must be identical
+	EXPECT_LE(fabs(putOutput.price - putOutput2.price), 1e-12);
+	EXPECT_LE(fabs(putOutput.delta - putOutput2.delta), 1e-12);
+	EXPECT_LE(fabs(putOutput.gamma - putOutput2.gamma), 1e-12);
+	EXPECT_LE(fabs(putOutput.vega - putOutput2.vega), 1e-12);
+	EXPECT_LE(fabs(putOutput.rho - putOutput2.rho), 1e-12);
+	EXPECT_LE(fabs(putOutput.rhoBorrow - putOutput2.rhoBorrow), 1e-12);
+}
+
+
+template<ESolverType solverType>
+void BatchConsistencyWorker(const EExerciseType exerciseType)
+{
+	// 7 options: the last batch is padded, and one option has dividends hence it is priced on its own
+	std::vector<CInputData> inputs(7);
+	for (size_t i = 0; i < inputs.size(); ++i)
+	{
+		CInputData& input = inputs[i];
+		input.smoothing = i % 3 == 0;
+		input.S = 100;
+		input.K = 80 + 5 * i;
+		input.r = .05;
+		input.b = .02 - .01 * i;
+		input.sigma = .2 + .02 * i;
+		input.T = 1 + .25 * i;
+		input.N = 129;
+		input.M = 80;
+		if (i == 4)
+			input.dividends.push_back(CDividend(.5, 1.0));
+	}
+
+	CPricerSettings settings;
+	settings.exerciseType = exerciseType;
+
+	std::vector<COutputData> callOutputs, putOutputs;
+	CBatchPricer<solverType, EGridType::Adaptive, EAdjointDifferentiation::All> batchPricer(inputs, settings);
+	batchPricer.Price(callOutputs, putOutputs);
+	ASSERT_EQ(inputs.size(), callOutputs.size());
+	ASSERT_EQ(inputs.size(), putOutputs.size());
+
+	for (size_t i = 0; i < inputs.size(); ++i)
+	{
+		CFDPricer<solverType, EGridType::Adaptive, EAdjointDifferentiation::All> pricer(inputs[i], settings);
+		COutputData callOutput, putOutput;
+		pricer.Price(callOutput, putOutput);
+
+		ASSERT_NEAR(callOutput.price, callOutputs[i].price, 1e-12);
+		ASSERT_NEAR(putOutput.price, putOutputs[i].price, 1e-12);
+		ASSERT_NEAR(callOutput.delta, callOutputs[i].delta, 1e-12);
+		ASSERT_NEAR(putOutput.delta, putOutputs[i].delta, 1e-12);
+		ASSERT_NEAR(callOutput.gamma, callOutputs[i].gamma, 1e-12);
+		ASSERT_NEAR(putOutput.gamma, putOutputs[i].gamma, 1e-12);
+		ASSERT_NEAR(callOutput.vega, callOutputs[i].vega, 1e-10);
+		ASSERT_NEAR(putOutput.vega, putOutputs[i].vega, 1e-10);
+		ASSERT_NEAR(callOutput.rho, callOutputs[i].rho, 1e-10);
+		ASSERT_NEAR(putOutput.rho, putOutputs[i].rho, 1e-10);
+		ASSERT_NEAR(callOutput.rhoBorrow, callOutputs[i].rhoBorrow, 1e-10);
+		ASSERT_NEAR(putOutput.rhoBorrow, putOutputs[i].rhoBorrow, 1e-10);
+		ASSERT_NEAR(callOutput.theta, callOutputs[i].theta, 1e-10);
+		ASSERT_NEAR(putOutput.theta, putOutputs[i].theta, 1e-10);
+	}
+}
+
+TEST (FDTest, BatchConsistency)
+{
+	BatchConsistencyWorker<ESolverType::ExplicitEuler>(EExerciseType::European);
+	BatchConsistencyWorker<ESolverType::ImplicitEuler>(EExerciseType::American);
+	BatchConsistencyWorker<ESolverType::CrankNicolson>(EExerciseType::European);
+	BatchConsistencyWorker<ESolverType::CrankNicolson>(EExerciseType::American);
+}
+
+TEST (FDTest, FixedSizeConsistency)
+{
+	CInputData input;
+	input.smoothing = true;
+	input.acceleration = true;
+	input.S = 100;
+	input.K = 90;
+	input.r = .05;
+	input.b = .02;
+	input.sigma = .3;
+	input.T = 2;
+	input.M = 80;
+	input.dividends.push_back(CDividend(.5, 2.0));
+	input.dividends.push_back(CDividend(1.5, 2.0));
+
+	CPricerSettings settings;
+	settings.exerciseType = EExerciseType::American;
+
+	// 101 is not specialized, hence it goes through the dynamic pricer
+	for (const size_t N : { 101, 129, 257, 513 })
+	{
+		input.N = N;
+		ASSERT_EQ(N != 101, CFixedSizePricer<>::IsFixedSize(N));
+
+		CFDPricer<> pricer(input, settings);
+		COutputData callOutput, putOutput;
+		pricer.Price(callOutput, putOutput);
+
+		CFixedSizePricer<> fixedSizePricer(input, settings);
+		COutputData fixedCallOutput, fixedPutOutput;
+		fixedSizePricer.Price(fixedCallOutput, fixedPutOutput);
+
+		ASSERT_NEAR(callOutput.price, fixedCallOutput.price, 1e-12);
+		ASSERT_NEAR(putOutput.price, fixedPutOutput.price, 1e-12);
+		ASSERT_NEAR(callOutput.delta, fixedCallOutput.delta, 1e-12);
+		ASSERT_NEAR(putOutput.delta, fixedPutOutput.delta, 1e-12);
+		ASSERT_NEAR(callOutput.gamma, fixedCallOutput.gamma, 1e-12);
+		ASSERT_NEAR(putOutput.gamma, fixedPutOutput.gamma, 1e-12);
+		ASSERT_NEAR(callOutput.vega, fixedCallOutput.vega, 1e-10);
+		ASSERT_NEAR(putOutput.vega, fixedPutOutput.vega, 1e-10);
+		ASSERT_NEAR(callOutput.rho, fixedCallOutput.rho, 1e-10);
+		ASSERT_NEAR(putOutput.rho, fixedPutOutput.rho, 1e-10);
+		ASSERT_NEAR(callOutput.theta, fixedCallOutput.theta, 1e-10);
+		ASSERT_NEAR(putOutput.theta, fixedPutOutput.theta, 1e-10);
+	}
+}
+
+template<ESolverType solverType>
+void SinglePrecisionWorker()
+{
+	CInputData input;
+	input.smoothing = true;
+	input.S = 100;
+	input.K = 90;
+	input.r = .05;
+	input.b = .02;
+	input.sigma = .3;
+	input.T = 2;
+	input.N = 257;
+	input.M = 200;
+	input.dividends.push_back(CDividend(.5, 3.0));
+	input.dividends.push_back(CDividend(1.5, 3.0));
+
+	CPricerSettings settings;
+	settings.exerciseType = EExerciseType::American;
+
+	COutputData callOutput, putOutput;
+	CFDPricer<solverType, EGridType::Adaptive, EAdjointDifferentiation::All> pricer(input, settings);
+	pricer.Price(callOutput, putOutput);
+
+	// the single precision prices and greeks are as accurate as their round-off allows
+	COutputData singleCallOutput, singlePutOutput;
+	CFDPricer<solverType, EGridType::Adaptive, EAdjointDifferentiation::All, 0, EPrecision::Single> singlePricer(input, settings);
+	singlePricer.Price(singleCallOutput, singlePutOutput);
+
+	ASSERT_NEAR(callOutput.price, singleCallOutput.price, 1e-3);
+	ASSERT_NEAR(putOutput.price, singlePutOutput.price, 1e-3);
+	ASSERT_NEAR(callOutput.delta, singleCallOutput.delta, 1e-4);
+	ASSERT_NEAR(putOutput.delta, singlePutOutput.delta, 1e-4);
+	ASSERT_NEAR(callOutput.vega, singleCallOutput.vega, 1e-2);
+	ASSERT_NEAR(putOutput.vega, singlePutOutput.vega, 1e-2);
+}
+
+TEST (FDTest, SinglePrecision)
+{
+	SinglePrecisionWorker<ESolverType::ImplicitEuler>();
+	SinglePrecisionWorker<ESolverType::CrankNicolson>();
+}
+
+template<ESolverType solverType, EAdjointDifferentiation adjointDifferentiation>
+void MatrixFreeConsistencyWorker(const EExerciseType exerciseType)
+{
+	CInputData input;
+	input.smoothing = true;
+	input.S = 100;
+	input.K = 90;
+	input.r = .05;
+	input.b = .02;
+	input.sigma = .3;
+	input.T = 2;
+	input.N = 129;
+	input.M = solverType == ESolverType::ExplicitEuler ? 5000 : 80; // explicit Euler stability
+	input.dividends.push_back(CDividend(.5, 2.0));
+	input.dividends.push_back(CDividend(1.5, 2.0));
+
+	CPricerSettings settings;
+	settings.exerciseType = exerciseType;
+
+	COutputData callOutput, putOutput;
+	CFDPricer<solverType, EGridType::Adaptive, adjointDifferentiation> pricer(input, settings);
+	pricer.Price(callOutput, putOutput);
+
+	// the coefficients are the same up to round-off, as they are computed in a different order
+	COutputData matrixFreeCallOutput, matrixFreePutOutput;
+	CFDPricer<solverType, EGridType::Adaptive, adjointDifferentiation, 0, EPrecision::Double, EOperatorStorage::MatrixFree> matrixFreePricer(input, settings);
+	matrixFreePricer.Price(matrixFreeCallOutput, matrixFreePutOutput);
+
+	ASSERT_NEAR(callOutput.price, matrixFreeCallOutput.price, 1e-10);
+	ASSERT_NEAR(putOutput.price, matrixFreePutOutput.price, 1e-10);
+	ASSERT_NEAR(callOutput.delta, matrixFreeCallOutput.delta, 1e-10);
+	ASSERT_NEAR(putOutput.delta, matrixFreePutOutput.delta, 1e-10);
+	ASSERT_NEAR(callOutput.gamma, matrixFreeCallOutput.gamma, 1e-10);
+	ASSERT_NEAR(putOutput.gamma, matrixFreePutOutput.gamma, 1e-10);
+	ASSERT_NEAR(callOutput.theta, matrixFreeCallOutput.theta, 1e-9);
+	ASSERT_NEAR(putOutput.theta, matrixFreePutOutput.theta, 1e-9);
+	ASSERT_NEAR(callOutput.vega, matrixFreeCallOutput.vega, 1e-9);
+	ASSERT_NEAR(putOutput.vega, matrixFreePutOutput.vega, 1e-9);
+	ASSERT_NEAR(callOutput.rho, matrixFreeCallOutput.rho, 1e-9);
+	ASSERT_NEAR(putOutput.rho, matrixFreePutOutput.rho, 1e-9);
+	ASSERT_NEAR(callOutput.rhoBorrow, matrixFreeCallOutput.rhoBorrow, 1e-9);
+	ASSERT_NEAR(putOutput.rhoBorrow, matrixFreePutOutput.rhoBorrow, 1e-9);
+}
+
+TEST (FDTest, MatrixFreeConsistency)
+{
+	MatrixFreeConsistencyWorker<ESolverType::ExplicitEuler, EAdjointDifferentiation::All>(EExerciseType::European);
+	MatrixFreeConsistencyWorker<ESolverType::ImplicitEuler, EAdjointDifferentiation::All>(EExerciseType::American);
+	MatrixFreeConsistencyWorker<ESolverType::CrankNicolson, EAdjointDifferentiation::All>(EExerciseType::European);
+	MatrixFreeConsistencyWorker<ESolverType::CrankNicolson, EAdjointDifferentiation::All>(EExerciseType::American);
+	MatrixFreeConsistencyWorker<ESolverType::CrankNicolson, EAdjointDifferentiation::Vega>(EExerciseType::American);
+	MatrixFreeConsistencyWorker<ESolverType::CrankNicolson, EAdjointDifferentiation::None>(EExerciseType::American);
+}
+
+TEST (FDTest, OperatorCacheConsistency)
+{
+	// monthly dividends, at the same offset from the time grid: the sub-step operators are reused
+	CInputData input;
+	input.smoothing = true;
+	input.S = 100;
+	input.K = 100;
+	input.r = .05;
+	input.b = .02;
+	input.sigma = .3;
+	input.T = 2;
+	input.N = 129;
+	input.M = 240;
+	input.dividends.resize(23);
+	for (size_t i = 0; i < input.dividends.size(); ++i)
+		input.dividends[i] = CDividend(.004 + (i + 1) / 12.0, .2);
+
+	CPricerSettings settings;
+	settings.exerciseType = EExerciseType::American;
+
+	COutputData callOutput, putOutput;
+	CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> pricer(input, settings);
+	pricer.Price(callOutput, putOutput);
+
+	// a single slot: every sub-step evicts the previous operator
+	CPricerSettings settings2(settings);
+	settings2.fdSettings.maxCachedOperators = 1;
+
+	COutputData callOutput2, putOutput2;
+	CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> pricer2(input, settings2);
+	pricer2.Price(callOutput2, putOutput2);
+
+	ASSERT_NEAR(callOutput.price, callOutput2.price, 1e-12);
+	ASSERT_NEAR(putOutput.price, putOutput2.price, 1e-12);
+	ASSERT_NEAR(callOutput.delta, callOutput2.delta, 1e-12);
+	ASSERT_NEAR(putOutput.delta, putOutput2.delta, 1e-12);
+	ASSERT_NEAR(callOutput.gamma, callOutput2.gamma, 1e-12);
+	ASSERT_NEAR(putOutput.gamma, putOutput2.gamma, 1e-12);
+	ASSERT_NEAR(callOutput.vega, callOutput2.vega, 1e-12);
+	ASSERT_NEAR(putOutput.vega, putOutput2.vega, 1e-12);
+	ASSERT_NEAR(callOutput.rho, callOutput2.rho, 1e-12);
+	ASSERT_NEAR(putOutput.rho, putOutput2.rho, 1e-12);
+	ASSERT_NEAR(callOutput.rhoBorrow, callOutput2.rhoBorrow, 1e-12);
+	ASSERT_NEAR(putOutput.rhoBorrow, putOutput2.rhoBorrow, 1e-12);
+}
+
+TEST (FDTest, OperatorRegistry)
+{
+	CInputData input;
+	input.smoothing = true;
+	input.S = 100;
+	input.K = 100;
+	input.r = .05;
+	input.b = .02;
+	input.sigma = .3;
+	input.T = 2;
+	input.N = 129;
+	input.M = 80;
+	input.dividends.push_back(CDividend(.5, .5));
+
+	CPricerSettings settings;
+	settings.exerciseType = EExerciseType::American;
+
+	typedef COperatorRegistry<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> Registry;
+	Registry registry(3);
+
+	// a pricer with a registered operator prices as one with its own
+	COutputData callOutput, putOutput;
+	CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> pricer(input, settings);
+	pricer.Price(callOutput, putOutput);
+
+	const auto u = registry.Get(input, settings.fdSettings);
+	COutputData callOutput2, putOutput2;
+	CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> pricer2(input, settings, u);
+	pricer2.Price(callOutput2, putOutput2);
+
+	ASSERT_DOUBLE_EQ(callOutput.price, callOutput2.price);
+	ASSERT_DOUBLE_EQ(putOutput.price, putOutput2.price);
+	ASSERT_DOUBLE_EQ(callOutput.vega, callOutput2.vega);
+	ASSERT_DOUBLE_EQ(putOutput.rhoBorrow, putOutput2.rhoBorrow);
+
+	// the strike and the dividends do not change the operator
+	CInputData input2(input);
+	input2.K = 110;
+	input2.dividends.clear();
+	ASSERT_EQ(u.get(), registry.Get(input2, settings.fdSettings).get());
+	ASSERT_EQ(1u, registry.size());
+
+	// r only changes the evolution operator, sigma also the space discretization
+	CInputData input3(input);
+	input3.r = .04;
+	const auto u3 = registry.Get(input3, settings.fdSettings);
+	ASSERT_NE(u.get(), u3.get());
+	ASSERT_EQ(u->GetSharedGrid().get(), u3->GetSharedGrid().get());
+	ASSERT_EQ(u->GetSpaceDiscretization().get(), u3->GetSpaceDiscretization().get());
+
+	CInputData input4(input);
+	input4.sigma = .2;
+	const auto u4 = registry.Get(input4, settings.fdSettings);
+	ASSERT_EQ(u->GetSharedGrid().get(), u4->GetSharedGrid().get());
+	ASSERT_NE(u->GetSpaceDiscretization().get(), u4->GetSpaceDiscretization().get());
+	ASSERT_EQ(3u, registry.size());
+
+	// u is the least recently used once u3 and u4 are read again, hence it's evicted: the pricers holding it are not affected
+	registry.Get(input3, settings.fdSettings);
+	registry.Get(input4, settings.fdSettings);
+	CInputData input5(input);
+	input5.S = 90;
+	const auto u5 = registry.Get(input5, settings.fdSettings);
+	ASSERT_EQ(3u, registry.size());
+	ASSERT_NE(u->GetSharedGrid().get(), u5->GetSharedGrid().get());
+	ASSERT_EQ(u3.get(), registry.Get(input3, settings.fdSettings).get());
+	ASSERT_NE(u.get(), registry.Get(input, settings.fdSettings).get());
+
+	COutputData callOutput3, putOutput3;
+	pricer2.Price(callOutput3, putOutput3);
+	ASSERT_DOUBLE_EQ(callOutput.price, callOutput3.price);
+
+	// concurrent readers and writers get the same operators
+	registry.Clear();
+	ASSERT_EQ(0u, registry.size());
+
+	std::vector<CInputData> portfolio(3, input);
+	portfolio[1].sigma = .25;
+	portfolio[2].r = .03;
+	registry.Prewarm(portfolio, settings.fdSettings);
+	ASSERT_EQ(3u, registry.size());
+
+	std::vector<std::shared_ptr<const Registry::Operator>> operators(8 * portfolio.size());
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < 8; ++t)
+	{
+		threads.emplace_back([&, t]()
+		{
+			for (size_t i = 0; i < portfolio.size(); ++i)
+				operators[t * portfolio.size() + i] = registry.Get(portfolio[i], settings.fdSettings);
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	for (size_t i = 0; i < operators.size(); ++i)
+		ASSERT_EQ(operators[i % portfolio.size()].get(), operators[i].get());
+	ASSERT_EQ(3u, registry.size());
+
+	// the pricers follow the partitions of the operator, so different settings can't share it
+	CFiniteDifferenceSettings parallelSettings(settings.fdSettings);
+	parallelSettings.parallelSolveMinN = 1;
+	parallelSettings.parallelSolveThreads = 2;
+	parallelSettings.minPartitionSize = 64;
+	ASSERT_EQ(2u, registry.Get(portfolio[0], parallelSettings)->GetPartitions());
+	ASSERT_EQ(1u, registry.Get(portfolio[0], settings.fdSettings)->GetPartitions());
+
+	CFiniteDifferenceSettings reductionSettings(settings.fdSettings);
+	reductionSettings.cyclicReductionMaxN = portfolio[0].N;
+	ASSERT_TRUE(registry.Get(portfolio[0], reductionSettings)->HasCyclicReduction());
+	ASSERT_FALSE(registry.Get(portfolio[0], settings.fdSettings)->HasCyclicReduction());
+
+	// the UL factors are there only if Brennan-Schwartz is requested
+	CFiniteDifferenceSettings exerciseSettings(settings.fdSettings);
+	exerciseSettings.brennanSchwartz = true;
+	ASSERT_TRUE(registry.Get(portfolio[0], exerciseSettings)->HasBrennanSchwartz());
+	ASSERT_FALSE(registry.Get(portfolio[0], settings.fdSettings)->HasBrennanSchwartz());
+}
+
+// the allocation counter is fed only in debug builds
+#ifdef COUNT_ALLOCATIONS
+TEST (FDTest, ZeroAllocationSteadyState)
+{
+	CInputData input;
+	input.smoothing = true;
+	input.acceleration = true;
+	input.S = 100;
+	input.K = 100;
+	input.r = .05;
+	input.b = .02;
+	input.sigma = .3;
+	input.T = 2;
+	input.N = 129;
+	input.M = 80;
+	input.dividends.resize(8);
+	for (size_t i = 0; i < input.dividends.size(); ++i)
+		input.dividends[i] = CDividend(.001 + .25 * i, 1.0);
+
+	CPricerSettings settings;
+	settings.exerciseType = EExerciseType::American;
+
+	// without an arena every container is on the heap
+	const size_t heapAllocations = details::CAllocationCounter::Count();
+	COutputData callOutput, putOutput;
+	CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> pricer(input, settings);
+	pricer.Price(callOutput, putOutput);
+	ASSERT_LT(heapAllocations + 20, details::CAllocationCounter::Count());
+
+	details::CArena arena;
+	for (size_t iter = 0; iter < 4; ++iter)
+	{
+		const size_t allocations = details::CAllocationCounter::Count();
+		COutputData callOutput2, putOutput2;
+		{
+			details::CArenaScope scope(&arena);
+			CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> pricer2(input, settings);
+			pricer2.Price(callOutput2, putOutput2);
+		}
+
+		// the first option warms the arena up, the following ones do not touch the heap
+		if (iter > 0)
+		{
+			ASSERT_EQ(allocations, details::CAllocationCounter::Count());
+		}
+		ASSERT_EQ(0u, arena.size());
+
+		ASSERT_DOUBLE_EQ(callOutput.price, callOutput2.price);
+		ASSERT_DOUBLE_EQ(putOutput.price, putOutput2.price);
+		ASSERT_DOUBLE_EQ(callOutput.vega, callOutput2.vega);
+		ASSERT_DOUBLE_EQ(putOutput.rho, putOutput2.rho);
+	}
+}
+#endif
+
+TEST (FDTest, Reprice)
+{
+	CInputData input;
+	input.smoothing = true;
+	input.acceleration = true;
+	input.S = 100;
+	input.K = 100;
+	input.r = .05;
+	input.b = .02;
+	input.sigma = .3;
+	input.T = 2;
+	input.N = 129;
+	input.M = 80;
+	input.dividends.push_back(CDividend(.5, 1.0));
+	input.dividends.push_back(CDividend(1.5, 1.0));
+
+	CPricerSettings settings;
+	settings.exerciseType = EExerciseType::American;
+
+	typedef CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> Pricer;
+
+	// one long lived pricer, moved around
+	std::vector<Pricer> pricers;
+	pricers.push_back(Pricer(input, settings));
+	Pricer& unaliased pricer = pricers.front();
+
+	std::vector<CInputData> inputs(8, input);
+	inputs[1].K = 110;				// same operator
+	inputs[2].sigma = .25;			// same grid
+	inputs[3].r = .03;				// same grid and space discretization
+	inputs[4].S = 90;				// new grid
+	inputs[5].N = 257;				// new buffers
+	inputs[6].dividends.clear();	// no dividends
+	inputs[7].acceleration = false;
+
+	for (const auto& repriceInput : inputs)
+	{
+		COutputData callOutput, putOutput;
+		Pricer freshPricer(repriceInput, settings);
+		freshPricer.Price(callOutput, putOutput);
+
+		COutputData callOutput2, putOutput2;
+		pricer.Reprice(repriceInput, callOutput2, putOutput2);
+
+		ASSERT_DOUBLE_EQ(callOutput.price, callOutput2.price);
+		ASSERT_DOUBLE_EQ(putOutput.price, putOutput2.price);
+		ASSERT_DOUBLE_EQ(callOutput.delta, callOutput2.delta);
+		ASSERT_DOUBLE_EQ(putOutput.gamma, putOutput2.gamma);
+		ASSERT_DOUBLE_EQ(callOutput.vega, callOutput2.vega);
+		ASSERT_DOUBLE_EQ(putOutput.vega, putOutput2.vega);
+		ASSERT_DOUBLE_EQ(callOutput.rho, callOutput2.rho);
+		ASSERT_DOUBLE_EQ(putOutput.rhoBorrow, putOutput2.rhoBorrow);
+		ASSERT_DOUBLE_EQ(callOutput.theta, callOutput2.theta);
+	}
+
+#ifdef COUNT_ALLOCATIONS
+	// a new strike reuses operators and buffers: no allocation at all
+	COutputData callOutput, putOutput;
+	pricer.Reprice(inputs[0], callOutput, putOutput);
+	const size_t allocations = details::CAllocationCounter::Count();
+	pricer.Reprice(inputs[1], callOutput, putOutput);
+	ASSERT_EQ(allocations, details::CAllocationCounter::Count());
+#endif
+}
+
+/**
+ * At the money option, shared by the consistency tests below
+ */
+CInputData AtTheMoneyInput(const double T, const size_t N, const size_t M)
+{
+	CInputData input;
+	input.smoothing = true;
+	input.S = 100;
+	input.K = 100;
+	input.r = .05;
+	input.b = .02;
+	input.sigma = .3;
+	input.T = T;
+	input.N = N;
+	input.M = M;
+
+	return input;
+}
+
+/**
+ * Price, delta and gamma within tolerance of the reference ones, the other outputs (tangents and time derivatives) within sensitivityTolerance,
+ * except theta2 which divides by the square of the last step and is within theta2Tolerance.
+ * A tolerance of 0 checks that they are the same
+ */
+void ExpectSameOutputs(const COutputData& unaliased reference, const COutputData& unaliased out, const double tolerance, const double sensitivityTolerance, const double theta2Tolerance)
+{
+	EXPECT_NEAR(reference.price, out.price, tolerance);
+	EXPECT_NEAR(reference.delta, out.delta, tolerance);
+	EXPECT_NEAR(reference.gamma, out.gamma, tolerance);
+	EXPECT_NEAR(reference.vega, out.vega, sensitivityTolerance);
+	EXPECT_NEAR(reference.rho, out.rho, sensitivityTolerance);
+	EXPECT_NEAR(reference.rhoBorrow, out.rhoBorrow, sensitivityTolerance);
+	EXPECT_NEAR(reference.theta, out.theta, sensitivityTolerance);
+	EXPECT_NEAR(reference.theta2, out.theta2, theta2Tolerance);
+	EXPECT_NEAR(reference.charm, out.charm, sensitivityTolerance);
+}
+
+void ExpectSameOutputs(const COutputData& unaliased reference, const COutputData& unaliased out, const double tolerance)
+{
+	ExpectSameOutputs(reference, out, tolerance, tolerance, tolerance);
+}
+
+/**
+ * Run worker for American and European calls, puts and both
+ */
+template<typename Worker>
+void ForEachExerciseAndCalculation(CPricerSettings& unaliased settings, Worker&& worker)
+{
+	for (const auto exerciseType : { EExerciseType::American, EExerciseType::European })
+	{
+		settings.exerciseType = exerciseType;
+		for (const auto calculationType : { ECalculationType::All, ECalculationType::CallOnly, ECalculationType::PutOnly })
+		{
+			settings.calculationType = calculationType;
+			worker();
+		}
+	}
+}
+
+template<ESolverType solverType>
+void InstructionSetConsistencyWorker(const CInputData& unaliased input, const CPricerSettings& unaliased settings)
+{
+	const EInstructionSet best = details::CInstructionSet::Detect();
+
+	ASSERT_TRUE(details::CInstructionSet::Set(EInstructionSet::Sse2));
+	COutputData callOutput, putOutput;
+	CFDPricer<solverType, EGridType::Adaptive, EAdjointDifferentiation::All> pricer(input, settings);
+	pricer.Price(callOutput, putOutput);
+
+	for (const auto instructionSet : { EInstructionSet::Avx2, EInstructionSet::Avx512 })
+	{
+		if (!details::CInstructionSet::Set(instructionSet))
+			continue;
+
+		COutputData callOutput2, putOutput2;
+		CFDPricer<solverType, EGridType::Adaptive, EAdjointDifferentiation::All> pricer2(input, settings);
+		pricer2.Price(callOutput2, putOutput2);
+
+		// the variants do not contract into FMA's: same results as the baseline
+		ExpectSameOutputs(callOutput, callOutput2, 0.0);
+		ExpectSameOutputs(putOutput, putOutput2, 0.0);
+	}
+
+	ASSERT_TRUE(details::CInstructionSet::Set(best));
+}
+
+TEST (FDTest, InstructionSetConsistency)
+{
+	CInputData input = AtTheMoneyInput(2, 129, 80);
+	input.dividends.push_back(CDividend(.5, 1.0));
+
+	CPricerSettings settings;
+	settings.exerciseType = EExerciseType::American;
+
+	InstructionSetConsistencyWorker<ESolverType::CrankNicolson>(input, settings);
+	InstructionSetConsistencyWorker<ESolverType::ImplicitEuler>(input, settings);
+
+	input.M = 2000;
+	InstructionSetConsistencyWorker<ESolverType::ExplicitEuler>(input, settings);
+
+	// the cyclic reduction kernels are vectorized
+	input.M = 80;
+	settings.fdSettings.cyclicReductionMaxN = input.N;
+	InstructionSetConsistencyWorker<ESolverType::CrankNicolson>(input, settings);
+
+	ASSERT_EQ(details::CInstructionSet::Detect(), details::CInstructionSet::Get());
+	ASSERT_FALSE(details::CInstructionSet::ToString(details::CInstructionSet::Get())[0] == '\0');
+}
+
+template<EAdjointDifferentiation adjointDifferentiation>
+void TemporalBlockingConsistencyWorker(const CInputData& unaliased input, CPricerSettings settings)
+{
+	settings.fdSettings.temporalBlockingSteps = 1;
+	COutputData callOutput, putOutput;
+	CFDPricer<ESolverType::ExplicitEuler, EGridType::Adaptive, adjointDifferentiation> pricer(input, settings);
+	pricer.Price(callOutput, putOutput);
+
+	// several tiles, down to the narrowest ones, and blocks that do not divide the number of steps
+	settings.fdSettings.temporalBlockingMinN = 0;
+	for (const size_t tileSize : { 0, 16, 50, 1000 })
+	{
+		for (const size_t nSteps : { 2, 7, 64 })
+		{
+			settings.fdSettings.temporalBlockingTileSize = tileSize;
+			settings.fdSettings.temporalBlockingSteps = nSteps;
+
+			COutputData callOutput2, putOutput2;
+			CFDPricer<ESolverType::ExplicitEuler, EGridType::Adaptive, adjointDifferentiation> pricer2(input, settings);
+			pricer2.Price(callOutput2, putOutput2);
+
+			// same operations in the same order as step by step
+			ExpectSameOutputs(callOutput, callOutput2, 0.0);
+			ExpectSameOutputs(putOutput, putOutput2, 0.0);
+		}
+	}
+}
+
+TEST (FDTest, TemporalBlockingConsistency)
+{
+	CInputData input = AtTheMoneyInput(2, 129, 2000);
+	input.dividends.push_back(CDividend(.5, 1.0));
+	input.dividends.push_back(CDividend(1.2, 1.5));
+
+	CPricerSettings settings;
+	ForEachExerciseAndCalculation(settings, [&]()
+	{
+		TemporalBlockingConsistencyWorker<EAdjointDifferentiation::All>(input, settings);
+	});
+
+	settings.exerciseType = EExerciseType::American;
+	settings.calculationType = ECalculationType::All;
+	TemporalBlockingConsistencyWorker<EAdjointDifferentiation::Rho>(input, settings);
+	TemporalBlockingConsistencyWorker<EAdjointDifferentiation::Vega>(input, settings);
+
+	input.dividends.clear();
+	TemporalBlockingConsistencyWorker<EAdjointDifferentiation::All>(input, settings);
+}
+
+template<ESolverType solverType>
+void ActiveWindowWorker(const CInputData& unaliased input, CPricerSettings settings)
+{
+	COutputData callOutput, putOutput;
+	CFDPricer<solverType, EGridType::Adaptive, EAdjointDifferentiation::All> pricer(input, settings);
+	pricer.Price(callOutput, putOutput);
+
+	// the tolerance only thresholds the change of a point in a step: the one of the outputs is empirical
+	settings.fdSettings.activeWindowTolerance = 1e-8;
+	const double tolerance = input.M * settings.fdSettings.activeWindowTolerance;
+
+	COutputData callOutput2, putOutput2;
+	CFDPricer<solverType, EGridType::Adaptive, EAdjointDifferentiation::All> pricer2(input, settings);
+	pricer2.Price(callOutput2, putOutput2);
+
+	// the far field where an option is worthless is frozen, whatever the spot: each option has its own window, so it's frozen when both are priced too
+	ASSERT_EQ(0u, pricer.GetFrozenPoints());
+	ASSERT_GT(pricer2.GetFrozenPoints(), 0u);
+
+	ExpectSameOutputs(callOutput, callOutput2, tolerance);
+	ExpectSameOutputs(putOutput, putOutput2, tolerance);
+}
+
+TEST (FDTest, ActiveWindow)
+{
+	CInputData input = AtTheMoneyInput(1, 801, 200);
+
+	CPricerSettings settings;
+	for (const double S : { 60.0, 100.0, 150.0 })
+	{
+		input.S = S;
+		ForEachExerciseAndCalculation(settings, [&]()
+		{
+			input.N = 801;
+			input.M = 200;
+			ActiveWindowWorker<ESolverType::CrankNicolson>(input, settings);
+			ActiveWindowWorker<ESolverType::ImplicitEuler>(input, settings);
+
+			input.N = 301;
+			input.M = 5000;
+			ActiveWindowWorker<ESolverType::ExplicitEuler>(input, settings);
+		});
+	}
+
+	// the window is reset at each dividend
+	input.S = 100;
+	input.N = 801;
+	input.M = 200;
+	input.dividends.push_back(CDividend(.5, 2.0));
+	settings.exerciseType = EExerciseType::American;
+	settings.calculationType = ECalculationType::PutOnly;
+	ActiveWindowWorker<ESolverType::CrankNicolson>(input, settings);
+
+	// Brennan-Schwartz replaces it
+	input.dividends.clear();
+	settings.calculationType = ECalculationType::All;
+	settings.fdSettings.brennanSchwartz = true;
+	COutputData callOutput, putOutput;
+	CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> pricer(input, settings);
+	pricer.Price(callOutput, putOutput);
+
+	settings.fdSettings.activeWindowTolerance = 1e-8;
+	COutputData callOutput2, putOutput2;
+	CFDPricer<ESolverType::CrankNicolson, EGridType::Adaptive, EAdjointDifferentiation::All> pricer2(input, settings);
+	pricer2.Price(callOutput2, putOutput2);
+	ASSERT_EQ(0u, pricer2.GetFrozenPoints());
+	ExpectSameOutputs(callOutput, callOutput2, 0.0);
+	ExpectSameOutputs(putOutput, putOutput2, 0.0);
+}
+
+template<ESolverType solverType, EAdjointDifferentiation adjointDifferentiation>
+void PartitionedSolveWorker(const CInputData& unaliased input, CPricerSettings settings)
+{
+	settings.fdSettings.parallelSolveMinN = 0;
+	COutputData callOutput, putOutput;
+	CFDPricer<solverType, EGridType::Adaptive, adjointDifferentiation> pricer(input, settings);
+	pricer.Price(callOutput, putOutput);
+
+	settings.fdSettings.parallelSolveMinN = 1;
+	settings.fdSettings.minPartitionSize = 64;
+	for (const size_t nThreads : { 2, 5 })
+	{
+		settings.fdSettings.parallelSolveThreads = nThreads;
+		COutputData callOutput2, putOutput2;
+		CFDPricer<solverType, EGridType::Adaptive, adjointDifferentiation> pricer2(input, settings);
+		pricer2.Price(callOutput2, putOutput2);
+
+		// the same up to rounding
+		const double tolerance = 1e-9;
+		ExpectSameOutputs(callOutput, callOutput2, tolerance, tolerance, 100.0 * tolerance);
+		ExpectSameOutputs(putOutput, putOutput2, tolerance, tolerance, 100.0 * tolerance);
+
+		// it's the same pricer at each price: the team is kept
+		pricer2.Price(callOutput2, putOutput2);
+		ExpectSameOutputs(callOutput, callOutput2, tolerance, tolerance, 100.0 * tolerance);
+		ExpectSameOutputs(putOutput, putOutput2, tolerance, tolerance, 100.0 * tolerance);
+	}
+}
+
+TEST (FDTest, PartitionedSolve)
+{
+	CInputData input = AtTheMoneyInput(1, 1025, 100);
+
+	CPricerSettings settings;
+	ForEachExerciseAndCalculation(settings, [&]()
+	{
+		PartitionedSolveWorker<ESolverType::CrankNicolson, EAdjointDifferentiation::All>(input, settings);
+		PartitionedSolveWorker<ESolverType::ImplicitEuler, EAdjointDifferentiation::All>(input, settings);
+	});
+
+	settings.exerciseType = EExerciseType::American;
+	settings.calculationType = ECalculationType::All;
+	PartitionedSolveWorker<ESolverType::CrankNicolson, EAdjointDifferentiation::Rho>(input, settings);
+	PartitionedSolveWorker<ESolverType::CrankNicolson, EAdjointDifferentiation::Vega>(input, settings);
+
+	// the dividend sub-steps are not partitioned
+	input.dividends.push_back(CDividend(.5, 2.0));
+	PartitionedSolveWorker<ESolverType::CrankNicolson, EAdjointDifferentiation::All>(input, settings);
+
+	input.dividends.clear();
+	input.N = 321;
+	input.M = 5000;
+	PartitionedSolveWorker<ESolverType::ExplicitEuler, EAdjointDifferentiation::All>(input, settings);
+}
+
+template<ESolverType solverType, EAdjointDifferentiation adjointDifferentiation, EPrecision precision>
+void CyclicReductionWorker(const CInputData& unaliased input, CPricerSettings settings, const double tolerance)
+{
+	settings.fdSettings.cyclicReductionMaxN = 0;
+	COutputData callOutput, putOutput;
+	CFDPricer<solverType, EGridType::Adaptive, adjointDifferentiation, 0, precision> pricer(input, settings);
+	pricer.Price(callOutput, putOutput);
+
+	settings.fdSettings.cyclicReductionMaxN = input.N;
+	COutputData callOutput2, putOutput2;
+	CFDPricer<solverType, EGridType::Adaptive, adjointDifferentiation, 0, precision> pricer2(input, settings);
+	pricer2.Price(callOutput2, putOutput2);
+
+	// the same up to rounding
+	ExpectSameOutputs(callOutput, callOutput2, tolerance, 100.0 * tolerance, 100.0 * tolerance);
+	ExpectSameOutputs(putOutput, putOutput2, tolerance, 100.0 * tolerance, 100.0 * tolerance);
+}
+
+TEST (FDTest, CyclicReduction)
+{
+	CInputData input = AtTheMoneyInput(1, 101, 100);
+
+	CPricerSettings settings;
+	for (const size_t N : { 101, 257 })
+	{
+		input.N = N;
+		ForEachExerciseAndCalculation(settings, [&]()
+		{
+			CyclicReductionWorker<ESolverType::CrankNicolson, EAdjointDifferentiation::All, EPrecision::Double>(input, settings, 1e-10);
+			CyclicReductionWorker<ESolverType::ImplicitEuler, EAdjointDifferentiation::All, EPrecision::Double>(input, settings, 1e-10);
+		});
+	}
+
+	settings.exerciseType = EExerciseType::American;
+	settings.calculationType = ECalculationType::All;
+	CyclicReductionWorker<ESolverType::CrankNicolson, EAdjointDifferentiation::None, EPrecision::Double>(input, settings, 1e-10);
+	CyclicReductionWorker<ESolverType::CrankNicolson, EAdjointDifferentiation::Rho, EPrecision::Double>(input, settings, 1e-10);
+	CyclicReductionWorker<ESolverType::CrankNicolson, EAdjointDifferentiation::All, EPrecision::Single>(input, settings, 1e-3);
+
+	// the dividend sub-steps use it too
+	input.dividends.push_back(CDividend(.5, 2.0));
+	CyclicReductionWorker<ESolverType::CrankNicolson, EAdjointDifferentiation::All, EPrecision::Double>(input, settings, 1e-10);
+}
+
+template<ESolverType solverType, EAdjointDifferentiation adjointDifferentiation>
+void ExerciseRegionTrackingWorker(const CInputData& unaliased input, CPricerSettings settings)
+{
+	COutputData callOutput, putOutput;
+	CExerciseBoundary callBoundary, putBoundary;
+	CFDPricer<solverType, EGridType::Adaptive, adjointDifferentiation> pricer(input, settings);
+	pricer.Price(callOutput, putOutput, callBoundary, putBoundary);
+
+	settings.fdSettings.trackExerciseRegion = false;
+	COutputData callOutput2, putOutput2;
+	CExerciseBoundary callBoundary2, putBoundary2;
+	CFDPricer<solverType, EGridType::Adaptive, adjointDifferentiation> pricer2(input, settings);
+	pricer2.Price(callOutput2, putOutput2, callBoundary2, putBoundary2);
+
+	// the tracked projection is exact
+	ExpectSameOutputs(callOutput, callOutput2, 0.0);
+	ExpectSameOutputs(putOutput, putOutput2, 0.0);
+
+	ASSERT_EQ(input.M + 1, putBoundary.spot.size());
+	ASSERT_EQ(input.M + 1, callBoundary.time.size());
+	ASSERT_DOUBLE_EQ(input.T, putBoundary.time[input.M]);
+	for (size_t m = 0; m <= input.M; ++m)
+	{
+		// NaN where nothing is exercised
+		ASSERT_TRUE(putBoundary.spot[m] == putBoundary2.spot[m] || (std::isnan(putBoundary.spot[m]) && std::isnan(putBoundary2.spot[m])));
+		ASSERT_TRUE(callBoundary.spot[m] == callBoundary2.spot[m] || (std::isnan(callBoundary.spot[m]) && std::isnan(callBoundary2.spot[m])));
+	}
+}
+
+TEST (FDTest, ExerciseBoundary)
+{
+	CInputData input = AtTheMoneyInput(1, 801, 200);
+	input.acceleration = false;
+	input.b = .0;
+
+	CPricerSettings settings;
+	for (const double S : { 60.0, 100.0, 150.0 })
+	{
+		input.S = S;
+		for (const auto calculationType : { ECalculationType::All, ECalculationType::CallOnly, ECalculationType::PutOnly })
+		{
+			settings.calculationType = calculationType;
+			ExerciseRegionTrackingWorker<ESolverType::CrankNicolson, EAdjointDifferentiation::All>(input, settings);
+			ExerciseRegionTrackingWorker<ESolverType::ImplicitEuler, EAdjointDifferentiation::Vega>(input, settings);
+		}
+	}
+
+	input.S = 100;
+	input.N = 129;
+	input.M = 2000;
+	settings.calculationType = ECalculationType::All;
+	ExerciseRegionTrackingWorker<ESolverType::ExplicitEuler, EAdjointDifferentiation::Rho>(input, settings);
+
+	// with b < r the put boundary is below the strike, and it rises to it at expiry; the call one, above it, falls
+	input.N = 801;
+	input.M = 200;
+	COutputData callOutput, putOutput;
+	CExerciseBoundary callBoundary, putBoundary;
+	CFDPricer<> pricer(input, settings);
+	pricer.Price(callOutput, putOutput, callBoundary, putBoundary);
+	ASSERT_TRUE(std::isnan(putBoundary.spot[input.M - 1])); // the smoothed step is not projected
+	for (size_t m = 0; m + 2 < input.M; ++m)
+	{
+		ASSERT_LT(putBoundary.spot[m], input.K);
+		ASSERT_LE(putBoundary.spot[m], putBoundary.spot[m + 1]);
+		ASSERT_GT(callBoundary.spot[m], input.K);
+		ASSERT_GE(callBoundary.spot[m], callBoundary.spot[m + 1]);
+	}
+
+	// never exercised
+	settings.exerciseType = EExerciseType::European;
+	pricer.Price(callOutput, putOutput, callBoundary, putBoundary);
+	for (size_t m = 0; m <= input.M; ++m)
+	{
+		ASSERT_TRUE(std::isnan(putBoundary.spot[m]));
+		ASSERT_TRUE(std::isnan(callBoundary.spot[m]));
+	}
+}
+
+TEST (FDTest, JumpTable)
+{
+	const size_t N = 801;
+	CGrid<EGridType::Adaptive> grid(100.0, .1, 1000.0, N);
+
+	for (const double shift : { .05, 1.0, 7.5, 150.0 })
+	{
+		CPayoffData data, expected;
+		data.Init<EAdjointDifferentiation::All>(N);
+		for (size_t i = 0; i < N; ++i)
+		{
+			data.payoff_i[i] = std::max(100.0 - grid.Get(i), 0.0);
+			data.vega_i[i] = std::sin(.01 * i);
+			data.rho_i[i] = -.5 * data.payoff_i[i];
+			data.rhoBorrow_i[i] = std::cos(.02 * i);
+		}
+		expected = data;
+
+		// the top-down search that the table replaces
+		size_t j = N - 1;
+		for (size_t i = N; i --> 0 ;)
+		{
+			const double shiftedValue = grid.Get(i) - shift;
+			if (shiftedValue <= 0.0)
+				break;
+			while (j > 1 && grid.Get(j - 1) >= shiftedValue)
+				--j;
+
+			const double w0 = (grid.Get(j) - shiftedValue) / (grid.Get(j) - grid.Get(j - 1));
+			expected.Lerp<EAdjointDifferentiation::All>(i, j, w0, 1.0 - w0);
+		}
+
+		const auto table = grid.GetJumpTable(shift);
+		ASSERT_EQ(table.get(), grid.GetJumpTable(shift).get());
+		table->Apply(std::array<double*, 4> { { data.payoff_i.data(), data.vega_i.data(), data.rho_i.data(), data.rhoBorrow_i.data() } });
+
+		for (size_t i = 0; i < N; ++i)
+		{
+			ASSERT_EQ(expected.payoff_i[i], data.payoff_i[i]);
+			ASSERT_EQ(expected.vega_i[i], data.vega_i[i]);
+			ASSERT_EQ(expected.rho_i[i], data.rho_i[i]);
+			ASSERT_EQ(expected.rhoBorrow_i[i], data.rhoBorrow_i[i]);
+		}
+	}
+}
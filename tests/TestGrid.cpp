@@ -6,6 +6,7 @@
  */
 
 
+#include <utility>
 #include <gtest/gtest.h>
 #include <FiniteDifference/CGrid.h>
 
@@ -35,3 +36,54 @@ TEST (GridTest, AdaptiveGrid)
 	ASSERT_NEAR(grid.Get(grid.N / 2), grid.x0, 1e-12);
 	ASSERT_NEAR(grid.Get(grid.N - 1), grid.ub, 1e-12);
 }
+
+TEST (GridTest, StencilWeights)
+{
+	CGrid<EGridType::Adaptive> grid(50.0, 20.0, 100.0, 101);
+	const auto& weights = grid.GetStencilWeights();
+
+	const double sigma2 = .09;
+	const double b = .02;
+	for (size_t i = 1; i < grid.N - 1; ++i)
+	{
+		const double dxPlus  = grid.Get(i + 1) - grid.Get(i);
+		const double dxMinus = grid.Get(i)     - grid.Get(i - 1);
+		const double dx = dxPlus + dxMinus;
+
+		const double drift = b * grid.Get(i);
+		const double volatility = sigma2 * grid.Get(i) * grid.Get(i);
+
+		ASSERT_NEAR((-dxPlus * drift + volatility) / (dxMinus * dx), sigma2 * weights.volatilitySub[i] - b * weights.driftSub[i], 1e-12);
+		ASSERT_NEAR((dxMinus * drift + volatility) / (dxPlus * dx), sigma2 * weights.volatilitySuper[i] + b * weights.driftSuper[i], 1e-12);
+	}
+
+	// zero drift at the boundaries
+	ASSERT_EQ(0.0, weights.volatilitySub[0]);
+	ASSERT_EQ(0.0, weights.driftSub[0]);
+	ASSERT_EQ(0.0, weights.driftSuper[0]);
+	ASSERT_EQ(0.0, weights.volatilitySuper[grid.N - 1]);
+	ASSERT_EQ(0.0, weights.driftSub[grid.N - 1]);
+	ASSERT_EQ(0.0, weights.driftSuper[grid.N - 1]);
+
+	CGrid<EGridType::Adaptive> gridCopy(grid);
+	for (size_t i = 0; i < grid.N; ++i)
+	{
+		ASSERT_EQ(weights.volatilitySub[i], gridCopy.GetStencilWeights().volatilitySub[i]);
+		ASSERT_EQ(weights.driftSuper[i], gridCopy.GetStencilWeights().driftSuper[i]);
+	}
+}
+
+TEST (GridTest, Move)
+{
+	CGrid<EGridType::Adaptive> grid(50.0, 20.0, 100.0, 101);
+	CGrid<EGridType::Adaptive> gridCopy(grid);
+
+	// the points are moved, not copied
+	const double* points = &grid.Get(0);
+	CGrid<EGridType::Adaptive> movedGrid(std::move(grid));
+	ASSERT_EQ(points, &movedGrid.Get(0));
+
+	for (size_t i = 0; i < gridCopy.N; ++i)
+		ASSERT_DOUBLE_EQ(gridCopy.Get(i), movedGrid.Get(i));
+	ASSERT_DOUBLE_EQ(gridCopy.GetStencilWeights().volatilitySub[50], movedGrid.GetStencilWeights().volatilitySub[50]);
+}